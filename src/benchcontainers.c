@@ -0,0 +1,254 @@
+/**
+ * @file
+ * @brief Microbenchmark de los contenedores frente a la lista enlazada.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Uso: benchcontainers [procesos] [repeticiones]
+ *
+ * Compara la lista doble enlazada (list.c) con la cola doble circular y el
+ * vector de container.h en las operaciones de la simulacion: rotar una cola
+ * Round Robin (pop_front + push_back), recorrer los procesos, agregarlos al
+ * leer la entrada e insertarlos ordenados por llegada en prepare().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "list.h"
+#include "sched.h"
+
+/** @brief Procesos insertados ordenados (la insercion en la lista es O(n)) */
+#define BENCH_ORDERED_MAX 20000
+
+/**
+ * @brief Obtiene el tiempo actual en segundos.
+ * @return Tiempo monotono en segundos.
+ */
+static double now_seconds(void);
+
+/**
+ * @brief Imprime una fila de resultados.
+ * @param name Operacion
+ * @param list_time Tiempo por repeticion con la lista (segundos)
+ * @param container_time Tiempo por repeticion con el contenedor (segundos)
+ */
+static void print_row(const char *name, double list_time, double container_time);
+
+/**
+ * @brief Compara dos procesos por llegada (para insert_ordered de list.c).
+ * @param a Proceso A
+ * @param b Proceso B
+ * @return Positivo si A llega antes que B, negativo si despues, 0 si a la vez.
+ */
+static int compare_list_arrival(void *const a, void *const b);
+
+/**
+ * @brief Compara dos procesos por llegada (para process_deque_insert_ordered()).
+ * @param a Proceso A (elemento de la cola)
+ * @param b Proceso B (elemento de la cola)
+ * @return Positivo si A llega antes que B, negativo si despues, 0 si a la vez.
+ */
+static int compare_deque_arrival(process *const *a, process *const *b);
+
+int main(int argc, char *argv[])
+{
+    int count = (argc > 1) ? atoi(argv[1]) : (1 << 20);
+    int reps = (argc > 2) ? atoi(argv[2]) : 20;
+    int ordered;
+    process *processes;
+    list *plist;
+    node_iterator node;
+    process_deque *pdeque;
+    process_deque_iterator dit;
+    process_vector *pvector;
+    process_vector_iterator vit;
+    sim_time list_sum, container_sum;
+    double start, list_time, container_time;
+    int i, r;
+
+    if (count < 1 || reps < 1)
+    {
+        printf("Uso: %s [procesos] [repeticiones]\n", argv[0]);
+        return 1;
+    }
+    ordered = (count < BENCH_ORDERED_MAX) ? count : BENCH_ORDERED_MAX;
+
+    // Procesos con llegadas pseudoaleatorias (reproducibles)
+    srand(1);
+    processes = (process *)calloc(count, sizeof(process));
+    for (i = 0; i < count; i++)
+    {
+        processes[i].pid = i + 1;
+        processes[i].arrival_time = rand() % 1000000;
+        processes[i].waiting_time = rand() % 1000;
+    }
+
+    printf("Procesos: %d, repeticiones: %d\n\n", count, reps);
+    printf("%-28s%14s%14s%10s\n", "Operacion", "lista ms", "contenedor ms", "Mejora");
+
+    // Agregar todos los procesos al final (lectura de la entrada)
+    plist = create_list();
+    pvector = create_process_vector();
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        clear_list(plist, 0);
+        for (i = 0; i < count; i++)
+        {
+            push_back(plist, &processes[i]);
+        }
+    }
+    list_time = (now_seconds() - start) / reps;
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        process_vector_clear(pvector);
+        for (i = 0; i < count; i++)
+        {
+            process_vector_push_back(pvector, &processes[i]);
+        }
+    }
+    container_time = (now_seconds() - start) / reps;
+    print_row("push_back (vector)", list_time, container_time);
+
+    // Recorrer los procesos (reportes y exportacion)
+    list_sum = 0;
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        for (node = head(plist); node != 0; node = next(node))
+        {
+            list_sum += ((process *)node->data)->waiting_time;
+        }
+    }
+    list_time = (now_seconds() - start) / reps;
+    container_sum = 0;
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        for (vit = process_vector_head(pvector); vit != 0;
+             vit = process_vector_next(pvector, vit))
+        {
+            container_sum += (*vit)->waiting_time;
+        }
+    }
+    container_time = (now_seconds() - start) / reps;
+    print_row("recorrido (vector)", list_time, container_time);
+    if (list_sum != container_sum)
+    {
+        printf("Error: el recorrido del vector no coincide con el de la lista\n");
+        return 1;
+    }
+
+    // Rotar la cola de listos: un quantum por proceso en cada ronda
+    pdeque = create_process_deque();
+    for (i = 0; i < count; i++)
+    {
+        process_deque_push_back(pdeque, &processes[i]);
+    }
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        for (i = 0; i < count; i++)
+        {
+            push_back(plist, front(plist));
+            pop_front(plist);
+        }
+    }
+    list_time = (now_seconds() - start) / reps;
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        for (i = 0; i < count; i++)
+        {
+            process_deque_push_back(pdeque, process_deque_pop_front(pdeque));
+        }
+    }
+    container_time = (now_seconds() - start) / reps;
+    print_row("rotacion RR (deque)", list_time, container_time);
+    for (node = head(plist), dit = process_deque_head(pdeque); node != 0 && dit != 0;
+         node = next(node), dit = process_deque_next(pdeque, dit))
+    {
+        if (node->data != *dit)
+        {
+            break;
+        }
+    }
+    if (node != 0 || dit != 0)
+    {
+        printf("Error: la rotacion de la cola no coincide con la de la lista\n");
+        return 1;
+    }
+
+    // Insertar ordenado por llegada (prepare)
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        clear_list(plist, 0);
+        for (i = 0; i < ordered; i++)
+        {
+            insert_ordered(plist, &processes[i], compare_list_arrival);
+        }
+    }
+    list_time = (now_seconds() - start) / reps;
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        process_deque_clear(pdeque);
+        for (i = 0; i < ordered; i++)
+        {
+            process_deque_insert_ordered(pdeque, &processes[i], compare_deque_arrival);
+        }
+    }
+    container_time = (now_seconds() - start) / reps;
+    print_row("insert_ordered (deque)", list_time, container_time);
+    for (node = head(plist), dit = process_deque_head(pdeque); node != 0 && dit != 0;
+         node = next(node), dit = process_deque_next(pdeque, dit))
+    {
+        if (node->data != *dit)
+        {
+            break;
+        }
+    }
+    if (node != 0 || dit != 0)
+    {
+        printf("Error: el orden de la cola no coincide con el de la lista\n");
+        return 1;
+    }
+
+    destroy_list(plist, 0);
+    destroy_process_deque(pdeque);
+    destroy_process_vector(pvector);
+    free(processes);
+
+    return 0;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_row(const char *name, double list_time, double container_time)
+{
+    printf("%-28s%14.3f%14.3f%9.1fx\n", name, list_time * 1e3, container_time * 1e3,
+           list_time / container_time);
+}
+
+static int compare_list_arrival(void *const a, void *const b)
+{
+    process *p1 = (process *)a;
+    process *p2 = (process *)b;
+
+    return (p1->arrival_time < p2->arrival_time) - (p1->arrival_time > p2->arrival_time);
+}
+
+static int compare_deque_arrival(process *const *a, process *const *b)
+{
+    return compare_list_arrival(*a, *b);
+}
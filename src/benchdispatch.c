@@ -0,0 +1,202 @@
+/**
+ * @file
+ * @brief Microbenchmark de los ciclos de asignacion especializados.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Uso: benchdispatch [procesos] [repeticiones]
+ *
+ * Simula la misma carga con colas todas FIFO y todas Round Robin y mide
+ * solo el ciclo de asignacion:
+ * - "mismas opciones": ciclo generico (opts.specialize = 0) frente al
+ *   especializado, ambos sin mensajes ni slices de espera; mide solo las
+ *   ramas por estrategia.
+ * - "sondas": ciclo generico con mensajes (a /dev/null) y slices de espera,
+ *   como simulaban antes las sondas de capacidad, los barridos y la sesion,
+ *   frente al especializado sin ellos.
+ * Comprueba que ambas versiones producen la misma espera total y las mismas
+ * asignaciones.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "intern.h"
+#include "sched.h"
+
+/** @brief Colas de prioridad de la carga */
+#define BENCH_QUEUES 3
+
+/** @brief Resultado de una simulacion, para comparar las dos versiones */
+typedef struct
+{
+    double seconds;    /*!< Tiempo por repeticion */
+    sim_time waiting;  /*!< Espera total de los procesos */
+    long dispatches;   /*!< Asignaciones de CPU */
+} bench_result;
+
+/**
+ * @brief Obtiene el tiempo actual en segundos.
+ * @return Tiempo monotono en segundos.
+ */
+static double now_seconds(void);
+
+/**
+ * @brief Simula la carga varias veces.
+ * @param processes Procesos
+ * @param queues Colas de prioridad
+ * @param opts Opciones de la simulacion
+ * @param reps Repeticiones
+ * @return Tiempo por repeticion y totales de la ultima simulacion.
+ */
+static bench_result run(process_vector *processes, priority_queue *queues, sched_options *opts,
+                        int reps);
+
+/**
+ * @brief Mide el ciclo generico y el especializado e imprime una fila de resultados.
+ * @param name Configuracion
+ * @param processes Procesos
+ * @param queues Colas de prioridad
+ * @param opts Opciones de la simulacion (se modifican specialize, quiet y wait_slices)
+ * @param generic_quiet opts->quiet y opts->wait_slices = !generic_quiet del ciclo generico
+ * @param reps Repeticiones
+ * @return 1 si ambas versiones coinciden, 0 en caso contrario.
+ */
+static int compare(const char *name, process_vector *processes, priority_queue *queues,
+                   sched_options *opts, int generic_quiet, int reps);
+
+int main(int argc, char *argv[])
+{
+    int count = (argc > 1) ? atoi(argv[1]) : 200000;
+    int reps = (argc > 2) ? atoi(argv[2]) : 5;
+    process_vector *processes;
+    priority_queue *queues;
+    sched_options opts;
+    process *p;
+    sim_time arrival;
+    int ok = 1;
+    int i, q;
+
+    if (count < 1 || reps < 1)
+    {
+        printf("Uso: %s [procesos] [repeticiones]\n", argv[0]);
+        return 1;
+    }
+
+    // Llegadas en orden (prepare() inserta ordenado) y rafagas pseudoaleatorias
+    // reproducibles, con una carga cercana al 90%
+    srand(1);
+    processes = create_process_vector();
+    for (i = 0, arrival = 0; i < count; i++, arrival += rand() % 23)
+    {
+        p = create_process("p", arrival, 1 + rand() % 19);
+        p->pid = i + 1;
+        p->priority = rand() % BENCH_QUEUES;
+        process_vector_push_back(processes, p);
+    }
+    queues = create_queues(BENCH_QUEUES);
+
+    init_sched_options(&opts);
+    opts.out = fopen("/dev/null", "w");
+    if (opts.out == NULL)
+    {
+        printf("Error: no se pudo abrir /dev/null\n");
+        return 1;
+    }
+
+    printf("Procesos: %d, colas: %d, repeticiones: %d\n\n", count, BENCH_QUEUES, reps);
+    printf("%-24s%14s%18s%10s\n", "Configuracion", "generico ms", "especializado ms", "Mejora");
+
+    for (q = 0; q < BENCH_QUEUES; q++)
+    {
+        queues[q].strategy = FIFO;
+    }
+    ok &= compare("FIFO, mismas opciones", processes, queues, &opts, 1, reps);
+    ok &= compare("FIFO, sondas", processes, queues, &opts, 0, reps);
+
+    for (q = 0; q < BENCH_QUEUES; q++)
+    {
+        queues[q].strategy = RR;
+        queues[q].quantum = 2 << q;
+    }
+    ok &= compare("RR, mismas opciones", processes, queues, &opts, 1, reps);
+    ok &= compare("RR, sondas", processes, queues, &opts, 0, reps);
+
+    fclose(opts.out);
+    for (i = 0; i < processes->count; i++)
+    {
+        destroy_process(processes->items[i]);
+    }
+    destroy_process_vector(processes);
+    destroy_queues(queues, BENCH_QUEUES);
+    destroy_names();
+
+    return ok ? 0 : 1;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bench_result run(process_vector *processes, priority_queue *queues, sched_options *opts,
+                        int reps)
+{
+    bench_result result = {0, 0, 0};
+    simulation sim;
+    double start;
+    int r, i;
+
+    for (r = 0; r < reps; r++)
+    {
+        if (!init_simulation(&sim, processes, queues, BENCH_QUEUES, opts))
+        {
+            return result;
+        }
+        // Solo el ciclo de asignacion: prepare() es igual en ambas versiones
+        start = now_seconds();
+        while (simulation_step(&sim))
+        {
+        }
+        result.seconds += now_seconds() - start;
+        result.dispatches = sim.dispatches;
+        destroy_simulation(&sim);
+    }
+    result.seconds /= reps;
+
+    for (i = 0; i < processes->count; i++)
+    {
+        result.waiting += processes->items[i]->waiting_time;
+    }
+    return result;
+}
+
+static int compare(const char *name, process_vector *processes, priority_queue *queues,
+                   sched_options *opts, int generic_quiet, int reps)
+{
+    bench_result generic, specialized;
+
+    opts->specialize = 0;
+    opts->quiet = generic_quiet;
+    opts->wait_slices = !generic_quiet;
+    generic = run(processes, queues, opts, reps);
+    opts->specialize = 1;
+    opts->quiet = 1;
+    opts->wait_slices = 0;
+    specialized = run(processes, queues, opts, reps);
+
+    printf("%-24s%14.1f%18.1f%9.2fx\n", name, generic.seconds * 1e3, specialized.seconds * 1e3,
+           generic.seconds / specialized.seconds);
+    if (generic.waiting != specialized.waiting || generic.dispatches != specialized.dispatches)
+    {
+        printf("Error: el ciclo especializado no coincide con el generico (espera %" PRIsim
+               " / %" PRIsim ", asignaciones %ld / %ld)\n",
+               generic.waiting, specialized.waiting, generic.dispatches, specialized.dispatches);
+        return 0;
+    }
+    return 1;
+}
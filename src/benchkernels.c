@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @brief Microbenchmark de los kernels sobre columnas.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Uso: benchkernels [valores] [repeticiones]
+ *
+ * Mide la reduccion de una columna de tiempos (64 bits) y de una de enteros
+ * (32 bits) con cada implementacion soportada por la CPU, y la compara con la
+ * suma sobre una lista enlazada de procesos (list.c).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "kernels.h"
+#include "list.h"
+#include "sched.h"
+
+/**
+ * @brief Obtiene el tiempo actual en segundos.
+ * @return Tiempo monotono en segundos.
+ */
+static double now_seconds(void);
+
+/**
+ * @brief Mide la reduccion de una columna de enteros con cada implementacion.
+ * @param names Nombres de las implementaciones (la primera es la escalar)
+ * @param n Cantidad de implementaciones
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param reps Repeticiones
+ * @return 1 si todas coinciden con la escalar, 0 en caso contrario.
+ */
+static int bench_int(const char **names, int n, const int *column, int count, int reps);
+
+int main(int argc, char *argv[])
+{
+    static const char *names[] = {"scalar", "sse4.2", "avx2"};
+    int count = (argc > 1) ? atoi(argv[1]) : (1 << 22);
+    int reps = (argc > 2) ? atoi(argv[2]) : 50;
+    time_summary summary, expected;
+    process *processes;
+    process_vector *pvector;
+    list *plist;
+    node_iterator it;
+    sim_time sum;
+    double start, elapsed, scalar_time = 0;
+    sim_time *column;
+    int *cpus;
+    int i, r;
+    size_t k;
+
+    if (count < 1 || reps < 1)
+    {
+        printf("Uso: %s [valores] [repeticiones]\n", argv[0]);
+        return 1;
+    }
+
+    // Procesos con esperas pseudoaleatorias (reproducibles)
+    srand(1);
+    processes = (process *)calloc(count, sizeof(process));
+    pvector = create_process_vector();
+    plist = create_list();
+    for (i = 0; i < count; i++)
+    {
+        processes[i].waiting_time = (sim_time)(rand() % 1000000 - 1000) * 10000;
+        processes[i].cpu = rand() % 1000000 - 1000;
+        process_vector_push_back(pvector, &processes[i]);
+        push_back(plist, &processes[i]);
+    }
+    column = (sim_time *)malloc(sizeof(sim_time) * count);
+    time_column(pvector, offsetof(process, waiting_time), column);
+    cpus = (int *)malloc(sizeof(int) * count);
+    process_column(pvector, offsetof(process, cpu), cpus);
+
+    printf("Valores: %d, repeticiones: %d, por defecto: %s\n\n", count, reps, kernels_name());
+    printf("%-24s%14s%14s%10s\n", "Kernel", "ms/iter", "Mvalores/s", "Mejora");
+
+    // Suma recorriendo la lista enlazada (como antes de las columnas)
+    start = now_seconds();
+    sum = 0;
+    for (r = 0; r < reps; r++)
+    {
+        for (it = head(plist); it != 0; it = next(it))
+        {
+            sum += ((process *)it->data)->waiting_time;
+        }
+    }
+    elapsed = (now_seconds() - start) / reps;
+    printf("%-24s%14.3f%14.1f%10s\n", "lista enlazada", elapsed * 1e3, count / elapsed / 1e6, "-");
+
+    // Construccion de la columna desde el vector de procesos
+    start = now_seconds();
+    for (r = 0; r < reps; r++)
+    {
+        time_column(pvector, offsetof(process, waiting_time), column);
+    }
+    elapsed = (now_seconds() - start) / reps;
+    printf("%-24s%14.3f%14.1f%10s\n", "columna desde vector", elapsed * 1e3,
+           count / elapsed / 1e6, "-");
+
+    // Reduccion de la columna de tiempos con cada implementacion
+    for (k = 0; k < sizeof(names) / sizeof(names[0]); k++)
+    {
+        if (!use_kernels(names[k]))
+        {
+            printf("%-24s%14s\n", names[k], "no soportado");
+            continue;
+        }
+        start = now_seconds();
+        for (r = 0; r < reps; r++)
+        {
+            time_column_reduce(column, count, &summary);
+        }
+        elapsed = (now_seconds() - start) / reps;
+        if (k == 0)
+        {
+            scalar_time = elapsed;
+            expected = summary;
+        }
+        else if (summary.min != expected.min || summary.max != expected.max ||
+                 summary.sum != expected.sum)
+        {
+            printf("Error: %s no coincide con la implementacion escalar\n", names[k]);
+            return 1;
+        }
+        printf("%-24s%14.3f%14.1f%9.1fx\n", names[k], elapsed * 1e3, count / elapsed / 1e6,
+               scalar_time / elapsed);
+    }
+
+    if (sum / reps != expected.sum)
+    {
+        printf("Error: la suma de la lista no coincide con la columna\n");
+        return 1;
+    }
+
+    // Columna de enteros de 32 bits
+    printf("\n");
+    if (!bench_int(names, sizeof(names) / sizeof(names[0]), cpus, count, reps))
+    {
+        return 1;
+    }
+
+    destroy_list(plist, 0);
+    destroy_process_vector(pvector);
+    free(processes);
+    free(column);
+    free(cpus);
+
+    return 0;
+}
+
+static int bench_int(const char **names, int n, const int *column, int count, int reps)
+{
+    column_summary summary, expected;
+    double start, elapsed, scalar_time = 0;
+    char label[32];
+    int k, r;
+
+    for (k = 0; k < n; k++)
+    {
+        snprintf(label, sizeof(label), "%s (32 bits)", names[k]);
+        if (!use_kernels(names[k]))
+        {
+            printf("%-24s%14s\n", label, "no soportado");
+            continue;
+        }
+        start = now_seconds();
+        for (r = 0; r < reps; r++)
+        {
+            column_reduce(column, count, &summary);
+        }
+        elapsed = (now_seconds() - start) / reps;
+        if (k == 0)
+        {
+            scalar_time = elapsed;
+            expected = summary;
+        }
+        else if (summary.min != expected.min || summary.max != expected.max ||
+                 summary.sum != expected.sum)
+        {
+            printf("Error: %s no coincide con la implementacion escalar\n", names[k]);
+            return 0;
+        }
+        printf("%-24s%14.3f%14.1f%9.1fx\n", label, elapsed * 1e3, count / elapsed / 1e6,
+               scalar_time / elapsed);
+    }
+    return 1;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
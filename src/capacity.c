@@ -0,0 +1,387 @@
+/**
+ * @file
+ * @brief Planificacion de capacidad: cuanta carga admite una cola.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "capacity.h"
+#include "stats.h"
+
+/** @brief Estado de la busqueda: procesos objetivo y sus llegadas originales */
+typedef struct
+{
+    process_vector *processes; /*!< Vector de procesos */
+    priority_queue *queues;    /*!< Colas de prioridad */
+    int nqueues;               /*!< Cantidad de colas de prioridad */
+    sched_options opts;        /*!< Opciones de las sondas (sin mensajes) */
+    process **targets;         /*!< Procesos objetivo */
+    sim_time *arrival;         /*!< Llegadas originales de los procesos objetivo */
+    int count;                 /*!< Cantidad de procesos objetivo */
+    sim_time origin;           /*!< Primera llegada original (fija al escalar) */
+    sim_time span;             /*!< Distancia entre la primera y la ultima llegada */
+    sim_time max_wait;         /*!< Espera maxima del percentil */
+    int queue;                 /*!< Cola objetivo (0-based), o -1 = todas */
+    int allowed;               /*!< Procesos que pueden superar la espera maxima */
+    int *seen;                 /*!< Procesos finalizados ya revisados por cola */
+    int probes;                /*!< Sondas ejecutadas */
+    FILE *report;              /*!< Salida de los resultados */
+} capacity_planner;
+
+/** @brief Resultado de una sonda */
+typedef struct
+{
+    int met;        /*!< 1 = se cumplio el SLO */
+    int finished;   /*!< Procesos objetivo finalizados */
+    int exceeded;   /*!< Procesos objetivo que esperaron mas que el maximo */
+    sim_time now;   /*!< Tiempo de la simulacion al terminar la sonda */
+    long long wait; /*!< Percentil de la espera (solo si se cumplio) */
+} probe_result;
+
+/**
+ * @brief Simula con las llegadas objetivo escaladas.
+ * @param cp Planificador
+ * @param scale Escala de la tasa de llegadas (2 = el doble de llegadas por unidad de tiempo)
+ * @param result Salida: resultado de la sonda
+ * @return 1 si se pudo simular, 0 si las llegadas no caben en sim_time o hubo error.
+ */
+static int run_probe(capacity_planner *cp, double scale, probe_result *result);
+
+/**
+ * @brief Revisa las esperas de los procesos objetivo finalizados desde la ultima revision.
+ * @param cp Planificador
+ * @param result Resultado de la sonda en curso
+ */
+static void check_finished(capacity_planner *cp, probe_result *result);
+
+/**
+ * @brief Ejecuta una sonda e imprime su resultado.
+ * @param cp Planificador
+ * @param scale Escala de la tasa de llegadas
+ * @return 1 si se cumplio el SLO, 0 si no, -1 si no se pudo simular.
+ */
+static int probe(capacity_planner *cp, double scale);
+
+/**
+ * @brief Obtiene el tiempo actual en segundos.
+ * @return Tiempo monotono en segundos.
+ */
+static double now_seconds(void);
+
+int plan_capacity(process_vector *processes, priority_queue *queues, int nqueues,
+                  const sched_options *opts, sim_time max_wait, int queue)
+{
+    capacity_planner cp;
+    FILE *report = report_output(opts);
+    process_vector_iterator it;
+    process *p;
+    double lo = 0, hi = 0, scale, start;
+    int met, i;
+
+    if (opts->ncpus > 1 || opts->checkpoint_path != NULL || opts->resume_path != NULL)
+    {
+        fprintf(report, "Error: la planificacion de capacidad requiere una sola CPU y no usa "
+                        "puntos de control\n");
+        return 0;
+    }
+
+    memset(&cp, 0, sizeof(cp));
+    cp.processes = processes;
+    cp.queues = queues;
+    cp.nqueues = nqueues;
+    cp.max_wait = max_wait;
+    cp.queue = queue;
+
+    // Procesos objetivo: los de la cola (o todos), sin las tareas periodicas
+    cp.targets = (process **)malloc(sizeof(process *) * (processes->count + 1));
+    cp.arrival = (sim_time *)malloc(sizeof(sim_time) * (processes->count + 1));
+    cp.origin = SIM_TIME_MAX;
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (p->task != NULL || (queue >= 0 && p->priority != queue))
+        {
+            continue;
+        }
+        cp.targets[cp.count] = p;
+        cp.arrival[cp.count++] = p->arrival_time;
+        cp.origin = (p->arrival_time < cp.origin) ? p->arrival_time : cp.origin;
+    }
+    if (cp.count == 0)
+    {
+        fprintf(report, "Error: no hay procesos en la cola objetivo\n");
+        free(cp.targets);
+        free(cp.arrival);
+        return 0;
+    }
+    for (i = 0; i < cp.count; i++)
+    {
+        cp.span = (cp.arrival[i] - cp.origin > cp.span) ? cp.arrival[i] - cp.origin : cp.span;
+    }
+    cp.allowed = cp.count - (int)ceil(CAPACITY_PERCENTILE / 100.0 * cp.count);
+
+    // Las sondas no imprimen sus mensajes ni guardan archivos
+    cp.opts = *opts;
+    cp.opts.seq_log_path = NULL;
+    cp.opts.stats_path = NULL;
+    cp.opts.stats = create_stats(nqueues);
+    cp.opts.quiet = 1;
+    cp.opts.wait_slices = 0;
+    cp.seen = (int *)malloc(sizeof(int) * nqueues);
+    cp.report = report;
+
+    fprintf(report, "=== PLANIFICACION DE CAPACIDAD ===\n");
+    if (queue >= 0)
+    {
+        fprintf(report, "SLO: p%d de la espera <= %" PRIsim " en la cola %d\n", CAPACITY_PERCENTILE,
+                max_wait, queue + 1);
+    }
+    else
+    {
+        fprintf(report, "SLO: p%d de la espera <= %" PRIsim " en todas las colas\n", CAPACITY_PERCENTILE,
+                max_wait);
+    }
+    fprintf(report, "Procesos objetivo: %d (a lo sumo %d pueden esperar mas)\n", cp.count, cp.allowed);
+    fprintf(report, "Llegadas entre T=%" PRIsim " y T=%" PRIsim "\n\n", cp.origin, cp.origin + cp.span);
+
+    start = now_seconds();
+    met = probe(&cp, 1.0);
+    if (met < 0)
+    {
+        lo = hi = -1;
+    }
+    else if (cp.span == 0)
+    {
+        // Todas las llegadas son simultaneas: no hay tasa que escalar
+        lo = met ? 1.0 : 0;
+    }
+    else if (met)
+    {
+        // Duplicar la tasa hasta romper el SLO (o hasta que todas las llegadas coincidan)
+        lo = 1.0;
+        for (scale = 2.0; scale <= CAPACITY_MAX_SCALE && lo < cp.span; scale *= 2)
+        {
+            met = probe(&cp, scale);
+            if (met <= 0)
+            {
+                hi = (met == 0) ? scale : -1;
+                break;
+            }
+            lo = scale;
+        }
+    }
+    else
+    {
+        // Reducir la tasa a la mitad hasta cumplir el SLO
+        hi = 1.0;
+        for (scale = 0.5; scale >= 1.0 / CAPACITY_MAX_SCALE; scale /= 2)
+        {
+            met = probe(&cp, scale);
+            if (met != 0)
+            {
+                lo = (met > 0) ? scale : -1;
+                break;
+            }
+            hi = scale;
+        }
+    }
+
+    // Biseccion (geometrica) entre la ultima escala que cumple y la primera que no
+    while (lo > 0 && hi > 0 && hi / lo > 1.0 + CAPACITY_TOLERANCE)
+    {
+        scale = sqrt(lo * hi);
+        met = probe(&cp, scale);
+        if (met < 0)
+        {
+            hi = -1;
+            break;
+        }
+        if (met)
+        {
+            lo = scale;
+        }
+        else
+        {
+            hi = scale;
+        }
+    }
+
+    fprintf(report, "\n=== RESULTADOS DE CAPACIDAD ===\n");
+    fprintf(report, "Sondas: %d (%.3f s)\n", cp.probes, now_seconds() - start);
+    if (lo < 0 || hi < 0)
+    {
+        fprintf(report, "Error: las llegadas escaladas no caben en el tiempo de simulacion\n");
+    }
+    else if (lo == 0)
+    {
+        fprintf(report, "El SLO no se cumple ni reduciendo la tasa de llegadas\n");
+    }
+    else if (cp.span == 0)
+    {
+        fprintf(report, "Las llegadas objetivo son simultaneas: el SLO se cumple, pero no hay "
+                        "tasa que escalar\n");
+    }
+    else if (hi == 0 && lo >= cp.span)
+    {
+        fprintf(report, "El SLO se cumple incluso con todas las llegadas objetivo simultaneas\n");
+    }
+    else if (hi == 0)
+    {
+        fprintf(report, "El SLO se cumple incluso con la tasa de llegadas x%.0f\n", lo);
+    }
+    else
+    {
+        fprintf(report, "Escala maxima de la tasa de llegadas: x%.3f\n", lo);
+        fprintf(report, "Tasa de llegadas: %.6f procesos por unidad de tiempo (actual: %.6f)\n",
+                (cp.count - 1) * lo / cp.span, (double)(cp.count - 1) / cp.span);
+        if (lo >= 1.0)
+        {
+            fprintf(report, "Procesos adicionales que admite la misma ventana: %ld\n",
+                    (long)floor((lo - 1.0) * cp.count));
+        }
+        else
+        {
+            fprintf(report, "Procesos que sobran en la misma ventana: %ld\n",
+                    (long)ceil((1.0 - lo) * cp.count));
+        }
+    }
+
+    // Restaurar las llegadas originales
+    for (i = 0; i < cp.count; i++)
+    {
+        cp.targets[i]->arrival_time = cp.arrival[i];
+    }
+    destroy_stats(cp.opts.stats);
+    free(cp.targets);
+    free(cp.arrival);
+    free(cp.seen);
+
+    return lo >= 0 && hi >= 0;
+}
+
+static int run_probe(capacity_planner *cp, double scale, probe_result *result)
+{
+    simulation sim;
+    histogram *wait;
+    double offset;
+    int q, i;
+
+    for (i = 0; i < cp->count; i++)
+    {
+        offset = (double)(cp->arrival[i] - cp->origin) / scale;
+        if (offset >= (double)(SIM_TIME_MAX - cp->origin))
+        {
+            return 0;
+        }
+        cp->targets[i]->arrival_time = cp->origin + (sim_time)offset;
+    }
+
+    memset(result, 0, sizeof(probe_result));
+    memset(cp->seen, 0, sizeof(int) * cp->nqueues);
+    stats_reset(cp->opts.stats);
+    if (!init_simulation(&sim, cp->processes, cp->queues, cp->nqueues, &cp->opts))
+    {
+        return 0;
+    }
+
+    // Detener la sonda en cuanto demasiados procesos superan la espera
+    result->met = 1;
+    while (simulation_step(&sim))
+    {
+        check_finished(cp, result);
+        if (!result->met)
+        {
+            break;
+        }
+    }
+    check_finished(cp, result);
+    result->now = sim.now;
+
+    if (result->met)
+    {
+        wait = (histogram *)malloc(sizeof(histogram));
+        hist_reset(wait);
+        for (q = 0; q < cp->nqueues; q++)
+        {
+            if (cp->queue < 0 || q == cp->queue)
+            {
+                hist_merge(wait, stats_hist(sim.stats, q, METRIC_WAITING));
+            }
+        }
+        result->wait = hist_percentile(wait, CAPACITY_PERCENTILE);
+        free(wait);
+    }
+    destroy_simulation(&sim);
+
+    return 1;
+}
+
+static void check_finished(capacity_planner *cp, probe_result *result)
+{
+    process_deque *finished;
+    process *p;
+    int q;
+
+    for (q = 0; q < cp->nqueues; q++)
+    {
+        if (cp->queue >= 0 && q != cp->queue)
+        {
+            continue;
+        }
+        finished = cp->queues[q].finished;
+        for (; cp->seen[q] < finished->count; cp->seen[q]++)
+        {
+            p = *process_deque_at(finished, cp->seen[q]);
+            if (p->task != NULL)
+            {
+                continue;
+            }
+            result->finished++;
+            if (p->waiting_time > cp->max_wait)
+            {
+                result->exceeded++;
+            }
+        }
+    }
+    result->met = result->exceeded <= cp->allowed;
+}
+
+static int probe(capacity_planner *cp, double scale)
+{
+    probe_result result;
+
+    cp->probes++;
+    if (!run_probe(cp, scale, &result))
+    {
+        fprintf(cp->report, "Sonda %2d: tasa x%.4f -> no se pudo simular\n", cp->probes, scale);
+        return -1;
+    }
+
+    if (result.met)
+    {
+        fprintf(cp->report, "Sonda %2d: tasa x%.4f -> cumple (p%d de la espera: %lld, T=%" PRIsim ")\n",
+                cp->probes, scale, CAPACITY_PERCENTILE, result.wait, result.now);
+    }
+    else
+    {
+        fprintf(cp->report, "Sonda %2d: tasa x%.4f -> no cumple (%d esperaron mas; detenida en T=%" PRIsim
+                " con %d de %d finalizados)\n",
+                cp->probes, scale, result.exceeded, result.now, result.finished, cp->count);
+    }
+
+    return result.met;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file
+ * @brief Planificacion de capacidad: cuanta carga admite una cola.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Responde "cuantos procesos mas admite esta cola antes de que el p99 de la
+ * espera supere X". La entrada se lee una sola vez: cada sonda reescala las
+ * llegadas de los procesos ya creados (comprimiendo o estirando el tiempo
+ * entre la primera llegada y cada proceso) y vuelve a simular. La sonda se
+ * detiene en cuanto el SLO queda roto: la espera de un proceso es definitiva
+ * al finalizar, asi que basta con que terminen mas procesos por encima de X
+ * de los que el percentil permite.
+ *
+ * La escala se busca duplicandola (o reduciendola a la mitad) hasta
+ * encerrar el punto de ruptura, y luego por biseccion hasta una precision
+ * relativa de CAPACITY_TOLERANCE.
+ */
+#ifndef CAPACITY_H
+#define CAPACITY_H
+
+#include "sched.h"
+
+/** @brief Percentil de la espera que fija el SLO */
+#define CAPACITY_PERCENTILE 99
+
+/** @brief Precision relativa de la escala encontrada */
+#define CAPACITY_TOLERANCE 0.01
+
+/** @brief Escala maxima (y la inversa, minima) que se prueba */
+#define CAPACITY_MAX_SCALE 1048576.0
+
+/**
+ * @brief Busca la mayor escala de la tasa de llegadas que cumple el SLO.
+ *
+ * Solo se reescalan los procesos de la cola objetivo (o todos si no hay
+ * cola); las tareas periodicas conservan sus liberaciones y no cuentan
+ * para el SLO. Al terminar, los procesos recuperan sus llegadas originales.
+ * @param processes Vector de procesos
+ * @param queues Colas de prioridad
+ * @param nqueues Cantidad de colas de prioridad
+ * @param opts Opciones de la simulacion (una sola CPU, sin puntos de control)
+ * @param max_wait Espera maxima del percentil CAPACITY_PERCENTILE
+ * @param queue Cola objetivo (0-based), o -1 = todas
+ * @return 1 si se completo la busqueda, 0 en caso de error.
+ */
+int plan_capacity(process_vector *processes, priority_queue *queues, int nqueues,
+                  const sched_options *opts, sim_time max_wait, int queue);
+
+#endif
@@ -0,0 +1,781 @@
+/**
+ * @file
+ * @brief Puntos de control de una simulacion en curso.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "checkpoint.h"
+#include "seqlog.h"
+#include "stats.h"
+#include "util.h"
+
+/** @brief Encabezado del archivo de punto de control */
+static const char checkpoint_magic[8] = {'S', 'C', 'H', 'E', 'D', 'C', 'K', 'P'};
+
+/** @brief Etiqueta de fin de archivo */
+static const char tag_end[4] = {'E', 'N', 'D', '\0'};
+
+/** @brief Version del formato */
+#define CHECKPOINT_VERSION 5
+
+/** @brief Escritor de puntos de control en segundo plano */
+struct checkpoint_writer
+{
+    char *path;       /*!< Ruta del archivo */
+    char *data;       /*!< Punto de control que se esta escribiendo */
+    size_t size;      /*!< Tamano de data */
+    int busy;         /*!< 1 = hay una escritura pendiente */
+    int result;       /*!< Resultado de la ultima escritura */
+    int failures;     /*!< Escrituras fallidas */
+    pthread_t thread; /*!< Hilo de la escritura pendiente */
+};
+
+/**
+ * @brief Restaura el estado de una simulacion desde un punto de control.
+ * @param sim Simulacion inicializada sin secuencia (sim->sequence == NULL)
+ * @param data Punto de control
+ * @param size Tamano del punto de control
+ * @param check_queues 1 = exigir la misma configuracion de colas
+ * @return 1 si se restauro, 0 si el punto de control no corresponde o esta danado.
+ */
+static int restore_state(simulation *sim, const char *data, size_t size, int check_queues);
+
+/**
+ * @brief Descarta una instantanea.
+ * @param point Instantanea
+ */
+static void drop_snapshot(snapshot *point);
+
+/**
+ * @brief Escribe un entero de 32 bits.
+ * @param file Archivo
+ * @param value Valor
+ */
+static void put_int(FILE *file, int32_t value);
+
+/**
+ * @brief Escribe un entero de 64 bits.
+ * @param file Archivo
+ * @param value Valor
+ */
+static void put_long(FILE *file, int64_t value);
+
+/**
+ * @brief Lee un entero de 32 bits.
+ * @param file Archivo
+ * @param value Salida: valor
+ * @return 1 si se leyo, 0 en caso de error.
+ */
+static int get_int(FILE *file, int *value);
+
+/**
+ * @brief Lee un entero de 64 bits.
+ * @param file Archivo
+ * @param value Salida: valor
+ * @return 1 si se leyo, 0 en caso de error.
+ */
+static int get_long(FILE *file, long *value);
+
+/**
+ * @brief Lee un tiempo de simulacion (entero de 64 bits).
+ * @param file Archivo
+ * @param value Salida: valor
+ * @return 1 si se leyo, 0 en caso de error.
+ */
+static int get_time(FILE *file, sim_time *value);
+
+/**
+ * @brief Escribe una cola de procesos como cantidad y PIDs.
+ * @param file Archivo
+ * @param q Cola de procesos
+ */
+static void put_process_queue(FILE *file, process_deque *q);
+
+/**
+ * @brief Lee una cola de procesos escrita con put_process_queue().
+ * @param file Archivo
+ * @param sim Simulacion (para buscar los procesos por PID)
+ * @param q Cola destino (se vacia antes de leer)
+ * @return 1 si se leyo, 0 en caso de error.
+ */
+static int get_process_queue(FILE *file, simulation *sim, process_deque *q);
+
+/**
+ * @brief Escribe un buffer en path.tmp y lo renombra a path.
+ * @param path Ruta del archivo
+ * @param data Datos
+ * @param size Tamano de los datos
+ * @return 1 si se escribio, 0 en caso de error.
+ */
+static int write_file(char *path, char *data, size_t size);
+
+/**
+ * @brief Hilo que escribe el punto de control pendiente.
+ * @param arg Escritor (checkpoint_writer *)
+ * @return NULL
+ */
+static void *run_checkpoint_writer(void *arg);
+
+/**
+ * @brief Espera la escritura pendiente, si la hay.
+ * @param writer Escritor
+ */
+static void wait_checkpoint_writer(checkpoint_writer *writer);
+
+int checkpoint_serialize(simulation *sim, char **data, size_t *size)
+{
+    FILE *file;
+    process *p;
+    slice_vector_iterator s;
+    seqlog *log = sim->sequence;
+    uint32_t len;
+    int i, k;
+
+    *data = NULL;
+    *size = 0;
+
+    // Los bloques volcados a un archivo temporal no se pueden recuperar
+    if (log->path == NULL && log->spilled > 0)
+    {
+        return 0;
+    }
+
+    file = open_memstream(data, size);
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    fwrite(checkpoint_magic, sizeof(checkpoint_magic), 1, file);
+    put_int(file, CHECKPOINT_VERSION);
+
+    // Datos de entrada para validar la reanudacion
+    put_int(file, sim->nqueues);
+    put_int(file, sim->nprocesses);
+    for (i = 0; i < sim->nqueues; i++)
+    {
+        put_int(file, sim->queues[i].strategy);
+        put_int(file, sim->queues[i].quantum);
+    }
+    for (i = 0; i < sim->nprocesses; i++)
+    {
+        p = sim->table[i];
+        put_int(file, p->pid);
+        put_long(file, p->arrival_time);
+        put_int(file, p->execution_time);
+        put_int(file, p->priority);
+    }
+
+    // Estado global
+    put_long(file, sim->now);
+    put_int(file, sim->remaining);
+    put_long(file, sim->dispatches);
+
+    // Estado de cada proceso
+    for (i = 0; i < sim->nprocesses; i++)
+    {
+        p = sim->table[i];
+        put_int(file, p->state);
+        put_int(file, p->remaining_time);
+        put_long(file, p->waiting_time);
+        put_long(file, p->cpu_time);
+        put_long(file, p->finished_time);
+        put_long(file, p->first_run_time);
+        put_long(file, p->context_switches);
+        put_long(file, p->ready_since);
+        put_int(file, p->slices.count);
+        for (s = slice_vector_head(&p->slices); s != 0; s = slice_vector_next(&p->slices, s))
+        {
+            put_int(file, s->type);
+            put_long(file, s->from);
+            put_int(file, s->length);
+            put_int(file, s->period);
+            put_int(file, s->repeat);
+        }
+    }
+
+    // Contenido de las colas
+    for (i = 0; i < sim->nqueues; i++)
+    {
+        put_process_queue(file, sim->queues[i].ready);
+        put_process_queue(file, sim->queues[i].arrival);
+        put_process_queue(file, sim->queues[i].finished);
+    }
+
+    // Posicion de la secuencia: los bloques volcados quedan en su archivo
+    len = (log->path != NULL) ? strlen(log->path) : 0;
+    fwrite(&len, sizeof(len), 1, file);
+    if (len > 0)
+    {
+        fwrite(log->path, 1, len, file);
+    }
+    put_long(file, seqlog_sync(log));
+    put_long(file, log->spilled);
+    put_long(file, log->dispatches);
+    put_int(file, log->count);
+    for (k = 0; k < log->count; k++)
+    {
+        put_int(file, log->pid[k]);
+        put_long(file, log->start[k]);
+        put_int(file, log->length[k]);
+        put_int(file, log->repeat[k]);
+        put_int(file, log->period[k]);
+    }
+
+    write_stats(sim->stats, file);
+    fwrite(tag_end, sizeof(tag_end), 1, file);
+
+    if (ferror(file))
+    {
+        fclose(file);
+        free(*data);
+        *data = NULL;
+        *size = 0;
+        return 0;
+    }
+
+    return fclose(file) == 0;
+}
+
+int checkpoint_restore(simulation *sim, const char *data, size_t size)
+{
+    return restore_state(sim, data, size, 1);
+}
+
+snapshot_set *create_snapshot_set(int nqueues)
+{
+    snapshot_set *set = (snapshot_set *)malloc(sizeof(snapshot_set));
+
+    set->nqueues = nqueues;
+    set->strategies = (strategy *)malloc(sizeof(strategy) * nqueues);
+    set->quanta = (sim_delta *)malloc(sizeof(sim_delta) * nqueues);
+    set->configured = 0;
+    set->points = (snapshot *)calloc(nqueues + 1, sizeof(snapshot));
+    set->next_order = 0;
+    set->resumed = -1;
+    set->resumed_at = 0;
+
+    return set;
+}
+
+void destroy_snapshot_set(snapshot_set *set)
+{
+    if (set != NULL)
+    {
+        clear_snapshots(set);
+        free(set->strategies);
+        free(set->quanta);
+        free(set->points);
+        free(set);
+    }
+}
+
+void clear_snapshots(snapshot_set *set)
+{
+    int i;
+
+    for (i = 0; i <= set->nqueues; i++)
+    {
+        drop_snapshot(&set->points[i]);
+    }
+    set->configured = 0;
+    set->resumed = -1;
+}
+
+void take_snapshot(snapshot_set *set, simulation *sim, int point)
+{
+    snapshot *s = &set->points[point];
+
+    if (s->taken)
+    {
+        return;
+    }
+
+    // Si la secuencia ya se volco a un archivo temporal no hay datos: no se reanuda desde aqui
+    checkpoint_serialize(sim, &s->data, &s->size);
+    s->taken = 1;
+    s->order = set->next_order++;
+    s->now = sim->now;
+    s->dispatches = sim->dispatches;
+}
+
+int resume_snapshot(snapshot_set *set, simulation *sim)
+{
+    priority_queue *queues = sim->queues;
+    snapshot *best = NULL;
+    snapshot *s;
+    int i;
+
+    set->resumed = -1;
+    // Solo se reanuda si la simulacion anterior termino (se sabe que colas se asignaron)
+    if (set->configured && sim->nqueues == set->nqueues && set->points[set->nqueues].taken)
+    {
+        // Sin cambios, la simulacion anterior completa sigue valiendo
+        best = &set->points[set->nqueues];
+        for (i = 0; i < set->nqueues; i++)
+        {
+            if (queues[i].strategy == set->strategies[i] && queues[i].quantum == set->quanta[i])
+            {
+                continue;
+            }
+            // En EDF y RM la cola de listos es un monticulo: su contenido no es intercambiable
+            if (queues[i].strategy == EDF || queues[i].strategy == RM ||
+                set->strategies[i] == EDF || set->strategies[i] == RM)
+            {
+                best = NULL;
+                break;
+            }
+            // Una cola que nunca se asigno no influyo en ninguna decision
+            s = set->points[i].taken ? &set->points[i] : &set->points[set->nqueues];
+            if (s->order < best->order)
+            {
+                best = s;
+            }
+        }
+        if (best != NULL && best->data == NULL)
+        {
+            best = NULL;
+        }
+    }
+
+    // La configuracion actual es la de las instantaneas que se conserven o se tomen
+    for (i = 0; i < set->nqueues && i < sim->nqueues; i++)
+    {
+        set->strategies[i] = queues[i].strategy;
+        set->quanta[i] = queues[i].quantum;
+    }
+
+    if (best == NULL)
+    {
+        clear_snapshots(set);
+        set->configured = (sim->nqueues == set->nqueues);
+        return 0;
+    }
+    if (!restore_state(sim, best->data, best->size, 0))
+    {
+        clear_snapshots(set);
+        return -1;
+    }
+
+    // Las instantaneas posteriores al punto de reanudacion ya no corresponden
+    for (i = 0; i <= set->nqueues; i++)
+    {
+        if (set->points[i].taken && set->points[i].order > best->order)
+        {
+            drop_snapshot(&set->points[i]);
+        }
+    }
+    set->resumed = best->dispatches;
+    set->resumed_at = best->now;
+    return 1;
+}
+
+static int restore_state(simulation *sim, const char *data, size_t size, int check_queues)
+{
+    FILE *file;
+    char magic[sizeof(checkpoint_magic)];
+    char tag[sizeof(tag_end)];
+    sched_stats *stats;
+    process *p;
+    seq_record r;
+    char *path = NULL;
+    uint32_t len;
+    long offset, spilled, dispatches;
+    sim_time from, time;
+    int version, value, count, type, length, period, repeat;
+    int i, k;
+    int ok = 0;
+
+    file = fmemopen((void *)data, size, "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    if (fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, checkpoint_magic, sizeof(magic)) != 0 ||
+        !get_int(file, &version) || version != CHECKPOINT_VERSION)
+    {
+        goto done;
+    }
+
+    // Validar que la entrada sea la misma
+    if (!get_int(file, &value) || value != sim->nqueues ||
+        !get_int(file, &count) || count != sim->nprocesses)
+    {
+        goto done;
+    }
+    for (i = 0; i < sim->nqueues; i++)
+    {
+        if (!get_int(file, &type) || !get_int(file, &value) ||
+            (check_queues &&
+             (type != (int)sim->queues[i].strategy || value != sim->queues[i].quantum)))
+        {
+            goto done;
+        }
+    }
+    for (i = 0; i < sim->nprocesses; i++)
+    {
+        p = sim->table[i];
+        if (!get_int(file, &value) || value != p->pid ||
+            p->pid < 0 || sim->by_pid[p->pid] != p ||
+            !get_time(file, &time) || time != p->arrival_time ||
+            !get_int(file, &value) || value != p->execution_time ||
+            !get_int(file, &value) || value != p->priority)
+        {
+            goto done;
+        }
+    }
+
+    // Estado global
+    if (!get_time(file, &sim->now) || !get_int(file, &sim->remaining) ||
+        !get_long(file, &sim->dispatches))
+    {
+        goto done;
+    }
+
+    // Estado de cada proceso
+    for (i = 0; i < sim->nprocesses; i++)
+    {
+        p = sim->table[i];
+        if (!get_int(file, &value) || !get_int(file, &p->remaining_time) ||
+            !get_time(file, &p->waiting_time) || !get_time(file, &p->cpu_time) ||
+            !get_time(file, &p->finished_time) || !get_time(file, &p->first_run_time) ||
+            !get_long(file, &p->context_switches) || !get_time(file, &p->ready_since) ||
+            !get_int(file, &count))
+        {
+            goto done;
+        }
+        p->state = (enum state)value;
+        slice_vector_clear(&p->slices);
+        for (k = 0; k < count; k++)
+        {
+            if (!get_int(file, &type) || !get_time(file, &from) || !get_int(file, &length) ||
+                !get_int(file, &period) || !get_int(file, &repeat) || length < 0)
+            {
+                goto done;
+            }
+            slice_vector_push_back(&p->slices,
+                                   create_periodic_slice((slice_type)type, from, from + length,
+                                                         period, repeat));
+        }
+    }
+
+    // Contenido de las colas
+    for (i = 0; i < sim->nqueues; i++)
+    {
+        if (!get_process_queue(file, sim, sim->queues[i].ready) ||
+            !get_process_queue(file, sim, sim->queues[i].arrival) ||
+            !get_process_queue(file, sim, sim->queues[i].finished))
+        {
+            goto done;
+        }
+    }
+
+    // Secuencia: reabrir el archivo y restaurar los registros en memoria
+    if (fread(&len, sizeof(len), 1, file) != 1 || len > size)
+    {
+        goto done;
+    }
+    path = (char *)malloc(len + 1);
+    if (fread(path, 1, len, file) != len)
+    {
+        goto done;
+    }
+    path[len] = '\0';
+    if (!get_long(file, &offset) || !get_long(file, &spilled) ||
+        !get_long(file, &dispatches) || !get_int(file, &count))
+    {
+        goto done;
+    }
+    if (len > 0)
+    {
+        sim->sequence = reopen_seqlog(path, sim->opts->seq_mem_cap, offset, spilled, dispatches);
+    }
+    else if (spilled == 0)
+    {
+        sim->sequence = create_seqlog(NULL, sim->opts->seq_mem_cap);
+        sim->sequence->dispatches = dispatches;
+    }
+    if (sim->sequence == NULL)
+    {
+        fprintf(sim->report, "Error: no se pudo reabrir el registro de secuencia %s\n", path);
+        goto done;
+    }
+    for (k = 0; k < count; k++)
+    {
+        if (!get_int(file, &r.pid) || !get_time(file, &r.start) ||
+            !get_int(file, &r.length) || !get_int(file, &r.repeat) ||
+            !get_int(file, &r.period))
+        {
+            goto done;
+        }
+        seqlog_push_record(sim->sequence, &r);
+    }
+
+    // Estadisticas
+    stats = read_stats(file);
+    if (stats == NULL)
+    {
+        goto done;
+    }
+    stats_reset(sim->stats);
+    ok = stats_merge(sim->stats, stats);
+    destroy_stats(stats);
+
+    if (ok && (fread(tag, sizeof(tag), 1, file) != 1 || memcmp(tag, tag_end, sizeof(tag)) != 0))
+    {
+        ok = 0;
+    }
+
+done:
+    free(path);
+    fclose(file);
+    return ok;
+}
+
+int save_checkpoint(simulation *sim, char *path)
+{
+    char *data;
+    size_t size;
+    int ret;
+
+    if (!checkpoint_serialize(sim, &data, &size))
+    {
+        return 0;
+    }
+    ret = write_file(path, data, size);
+    free(data);
+    return ret;
+}
+
+int load_checkpoint(simulation *sim, char *path)
+{
+    FILE *file;
+    char *data;
+    long size;
+    int ret;
+
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) <= 0)
+    {
+        fclose(file);
+        return 0;
+    }
+    rewind(file);
+
+    data = (char *)malloc(size);
+    if (fread(data, 1, size, file) != (size_t)size)
+    {
+        free(data);
+        fclose(file);
+        return 0;
+    }
+    fclose(file);
+
+    ret = checkpoint_restore(sim, data, size);
+    free(data);
+    return ret;
+}
+
+checkpoint_writer *create_checkpoint_writer(char *path)
+{
+    checkpoint_writer *writer;
+
+    writer = (checkpoint_writer *)malloc(sizeof(checkpoint_writer));
+    memset(writer, 0, sizeof(checkpoint_writer));
+    writer->path = concat(path, "");
+
+    return writer;
+}
+
+int checkpoint_async(checkpoint_writer *writer, simulation *sim)
+{
+    char *data;
+    size_t size;
+
+    if (!checkpoint_serialize(sim, &data, &size))
+    {
+        writer->failures++;
+        return 0;
+    }
+
+    // A lo sumo una escritura pendiente
+    wait_checkpoint_writer(writer);
+
+    writer->data = data;
+    writer->size = size;
+    if (pthread_create(&writer->thread, NULL, run_checkpoint_writer, writer) != 0)
+    {
+        // Sin hilo: escribir en este hilo
+        run_checkpoint_writer(writer);
+        if (!writer->result)
+        {
+            writer->failures++;
+        }
+        return writer->result;
+    }
+    writer->busy = 1;
+
+    return 1;
+}
+
+int destroy_checkpoint_writer(checkpoint_writer *writer)
+{
+    int failures;
+
+    wait_checkpoint_writer(writer);
+    failures = writer->failures;
+    free(writer->path);
+    free(writer);
+
+    return failures;
+}
+
+static void drop_snapshot(snapshot *point)
+{
+    free(point->data);
+    memset(point, 0, sizeof(snapshot));
+}
+
+static void put_int(FILE *file, int32_t value)
+{
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+static void put_long(FILE *file, int64_t value)
+{
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+static int get_int(FILE *file, int *value)
+{
+    int32_t v;
+
+    if (fread(&v, sizeof(v), 1, file) != 1)
+    {
+        return 0;
+    }
+    *value = v;
+    return 1;
+}
+
+static int get_long(FILE *file, long *value)
+{
+    int64_t v;
+
+    if (fread(&v, sizeof(v), 1, file) != 1)
+    {
+        return 0;
+    }
+    *value = (long)v;
+    return 1;
+}
+
+static int get_time(FILE *file, sim_time *value)
+{
+    int64_t v;
+
+    if (fread(&v, sizeof(v), 1, file) != 1)
+    {
+        return 0;
+    }
+    *value = v;
+    return 1;
+}
+
+static void put_process_queue(FILE *file, process_deque *q)
+{
+    process_deque_iterator it;
+
+    put_int(file, q->count);
+    for (it = process_deque_head(q); it != 0; it = process_deque_next(q, it))
+    {
+        put_int(file, (*it)->pid);
+    }
+}
+
+static int get_process_queue(FILE *file, simulation *sim, process_deque *q)
+{
+    int count, pid;
+    int i;
+
+    process_deque_clear(q);
+    if (!get_int(file, &count) || count < 0 || count > sim->nprocesses)
+    {
+        return 0;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (!get_int(file, &pid) || pid < 0 || pid > sim->max_pid || sim->by_pid[pid] == NULL)
+        {
+            return 0;
+        }
+        process_deque_push_back(q, sim->by_pid[pid]);
+    }
+    return 1;
+}
+
+static int write_file(char *path, char *data, size_t size)
+{
+    FILE *file;
+    char *tmp_path;
+    int ok;
+
+    tmp_path = concat(path, ".tmp");
+    file = fopen(tmp_path, "wb");
+    if (file == NULL)
+    {
+        free(tmp_path);
+        return 0;
+    }
+
+    ok = fwrite(data, 1, size, file) == size;
+    ok = (fclose(file) == 0) && ok;
+
+    // El punto de control anterior solo se reemplaza si el nuevo quedo completo
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok)
+    {
+        remove(tmp_path);
+    }
+
+    free(tmp_path);
+    return ok;
+}
+
+static void *run_checkpoint_writer(void *arg)
+{
+    checkpoint_writer *writer = (checkpoint_writer *)arg;
+
+    writer->result = write_file(writer->path, writer->data, writer->size);
+    free(writer->data);
+    writer->data = NULL;
+
+    return NULL;
+}
+
+static void wait_checkpoint_writer(checkpoint_writer *writer)
+{
+    if (!writer->busy)
+    {
+        return;
+    }
+    pthread_join(writer->thread, NULL);
+    writer->busy = 0;
+    if (!writer->result)
+    {
+        writer->failures++;
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief Puntos de control de una simulacion en curso.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Un punto de control guarda el estado dinamico de la simulacion: tiempo
+ * actual, estado y slices de cada proceso, el contenido de las colas, la
+ * posicion de la secuencia de ejecucion y las estadisticas. Los datos de
+ * entrada (colas y procesos) no se guardan: para reanudar se carga la misma
+ * entrada y el punto de control se valida contra ella.
+ *
+ * Formato (enteros de 32 bits salvo que se indique; los tiempos de
+ * simulacion son int64):
+ * - Encabezado: "SCHEDCKP" (8 bytes) y version.
+ * - nqueues, nprocesses; por cola: estrategia y quantum; por proceso:
+ *   pid, llegada, tamano y prioridad (para validar la entrada).
+ * - Tiempo actual, procesos restantes, asignaciones (int64).
+ * - Por proceso: estado, restante, espera, CPU, finalizacion, primera
+ *   asignacion, cambios de contexto (int64), inicio de la espera en la cola
+ *   de listos, cantidad de slices y cada slice
+ *   (tipo, desde, duracion, periodo, repeticiones).
+ * - Por cola: colas ready, arrival y finished como cantidad y PIDs.
+ * - Secuencia: ruta (longitud y caracteres), tamano valido del archivo,
+ *   registros volcados y asignaciones (int64), y los registros en memoria.
+ * - Estadisticas en el formato de write_stats().
+ * - Fin: "END" (4 bytes, incluido el nulo).
+ *
+ * Los bloques de la secuencia volcados a disco no se copian: el punto de
+ * control guarda el tamano del archivo y al reanudar se trunca en ese punto.
+ *
+ * Instantaneas: con sched_options.snapshots, la simulacion guarda en memoria
+ * un punto de control justo antes de la primera asignacion de cada cola, y
+ * otro al terminar. Hasta la primera asignacion de una cola, su quantum y su
+ * estrategia (FIFO o RR) no influyen en ninguna decision, de modo que si la
+ * siguiente simulacion solo cambia la configuracion de algunas colas, puede
+ * reanudarse desde la instantanea mas temprana de las colas cambiadas en vez
+ * de comenzar desde el principio (o desde la final si nada cambio).
+ */
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+
+#include "sched.h"
+
+/** @brief Escritor de puntos de control en segundo plano */
+typedef struct checkpoint_writer checkpoint_writer;
+
+/** @brief Instantanea en memoria de una simulacion */
+typedef struct
+{
+    char *data;      /*!< Punto de control, o NULL si no se pudo tomar */
+    size_t size;     /*!< Tamano de data */
+    int taken;       /*!< 1 si la simulacion ya paso por este punto */
+    long order;      /*!< Orden en que se tomo (menor = antes) */
+    sim_time now;    /*!< Tiempo de la simulacion */
+    long dispatches; /*!< Asignaciones de CPU realizadas */
+} snapshot;
+
+/** @brief Instantaneas de una simulacion para volver a simular tras un cambio de configuracion */
+struct snapshot_set
+{
+    int nqueues;          /*!< Cantidad de colas */
+    strategy *strategies; /*!< Estrategia de cada cola al tomar las instantaneas */
+    sim_delta *quanta;    /*!< Quantum de cada cola al tomar las instantaneas */
+    int configured;       /*!< 1 si strategies y quanta corresponden a las instantaneas */
+    snapshot *points;     /*!< Antes de la primera asignacion de cada cola, y al final */
+    long next_order;      /*!< Orden de la siguiente instantanea */
+    long resumed;         /*!< Asignaciones al reanudar la ultima simulacion, o -1 */
+    sim_time resumed_at;  /*!< Tiempo al reanudar la ultima simulacion */
+};
+
+/**
+ * @brief Serializa el estado de la simulacion en memoria.
+ * @param sim Simulacion
+ * @param data Salida: buffer con el punto de control (liberar con free)
+ * @param size Salida: tamano del buffer
+ * @return 1 si se serializo, 0 en caso de error.
+ */
+int checkpoint_serialize(simulation *sim, char **data, size_t *size);
+
+/**
+ * @brief Restaura el estado de una simulacion preparada con la misma entrada.
+ * @param sim Simulacion inicializada sin secuencia (sim->sequence == NULL)
+ * @param data Punto de control
+ * @param size Tamano del punto de control
+ * @return 1 si se restauro, 0 si el punto de control no corresponde o esta danado.
+ */
+int checkpoint_restore(simulation *sim, const char *data, size_t size);
+
+/**
+ * @brief Crea un conjunto vacio de instantaneas.
+ * @param nqueues Cantidad de colas
+ * @return Nuevo conjunto.
+ */
+snapshot_set *create_snapshot_set(int nqueues);
+
+/**
+ * @brief Libera un conjunto de instantaneas.
+ * @param set Conjunto
+ */
+void destroy_snapshot_set(snapshot_set *set);
+
+/**
+ * @brief Descarta las instantaneas (por ejemplo, si cambiaron los procesos).
+ * @param set Conjunto
+ */
+void clear_snapshots(snapshot_set *set);
+
+/**
+ * @brief Toma una instantanea si la simulacion no habia pasado por ese punto.
+ * @param set Conjunto
+ * @param sim Simulacion
+ * @param point Cola cuya primera asignacion sigue (0-based), o nqueues = final
+ */
+void take_snapshot(snapshot_set *set, simulation *sim, int point);
+
+/**
+ * @brief Reanuda una simulacion preparada desde la ultima instantanea valida.
+ *
+ * Compara la configuracion de las colas con la de las instantaneas y elige
+ * la instantanea mas temprana de las colas que cambiaron (las que nunca se
+ * asignaron no cuentan). Si una cola cambio de o hacia EDF o RM no se
+ * reanuda. Las instantaneas posteriores a la elegida se descartan y las
+ * demas siguen valiendo para la nueva configuracion.
+ * @param set Conjunto
+ * @param sim Simulacion inicializada sin secuencia (sim->sequence == NULL)
+ * @return 1 si se reanudo, 0 si no hay instantanea valida (sim no cambia),
+ *         -1 si la restauracion fallo (hay que volver a preparar la simulacion).
+ */
+int resume_snapshot(snapshot_set *set, simulation *sim);
+
+/**
+ * @brief Guarda un punto de control (escribe path.tmp y lo renombra).
+ * @param sim Simulacion
+ * @param path Ruta del archivo
+ * @return 1 si se guardo, 0 en caso de error.
+ */
+int save_checkpoint(simulation *sim, char *path);
+
+/**
+ * @brief Carga un punto de control guardado con save_checkpoint().
+ * @param sim Simulacion inicializada sin secuencia (sim->sequence == NULL)
+ * @param path Ruta del archivo
+ * @return 1 si se restauro, 0 en caso de error.
+ */
+int load_checkpoint(simulation *sim, char *path);
+
+/**
+ * @brief Crea un escritor de puntos de control en segundo plano.
+ * @param path Ruta del archivo de puntos de control
+ * @return Nuevo escritor.
+ */
+checkpoint_writer *create_checkpoint_writer(char *path);
+
+/**
+ * @brief Toma un punto de control y lo escribe en segundo plano.
+ *
+ * El estado se serializa en el hilo que llama; la escritura a disco se hace
+ * en otro hilo. Si la escritura anterior no ha terminado, se espera antes de
+ * lanzar la nueva, de modo que hay a lo sumo una escritura pendiente.
+ * @param writer Escritor
+ * @param sim Simulacion
+ * @return 1 si se lanzo la escritura, 0 en caso de error.
+ */
+int checkpoint_async(checkpoint_writer *writer, simulation *sim);
+
+/**
+ * @brief Espera la escritura pendiente y libera el escritor.
+ * @param writer Escritor
+ * @return Cantidad de puntos de control que no se pudieron guardar.
+ */
+int destroy_checkpoint_writer(checkpoint_writer *writer);
+
+#endif
@@ -0,0 +1,447 @@
+/**
+ * @file
+ * @brief Contenedores genericos: vector contiguo, cola doble circular y monticulo.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Las macros DEFINE_VECTOR(name, type) y DEFINE_DEQUE(name, type) generan un
+ * tipo contenedor de elementos de tipo type y sus funciones (static inline),
+ * con el tipo de los elementos verificado por el compilador:
+ *
+ * - create_name() / destroy_name(c): crean y liberan un contenedor en el heap.
+ * - init_name(c) / free_name(c): inicializan y liberan un contenedor embebido
+ *   en otra estructura (free_name() no libera la estructura).
+ * - name_push_back, name_pop_back, name_back, name_at, name_remove_at,
+ *   name_clear, name_empty y name_reserve.
+ * - Solo la cola doble: name_push_front, name_pop_front, name_front y
+ *   name_insert_ordered.
+ * - Iteradores: name_iterator es un apuntador al elemento; name_head(c) y
+ *   name_tail(c) retornan el primero y el ultimo (o NULL si esta vacio), y
+ *   name_next(c, it) y name_previous(c, it) el siguiente y el anterior (o NULL
+ *   al terminar), como head()/next() de las listas:
+ *
+ *       for (it = process_deque_head(q); it != 0; it = process_deque_next(q, it))
+ *           print_process(*it, stdout);
+ *
+ * DEFINE_HEAP(name, container, type) agrega a un vector o cola doble las
+ * operaciones de un monticulo binario (name_push y name_pop).
+ *
+ * El vector guarda los elementos en un arreglo que duplica su capacidad al
+ * llenarse. La cola doble es un buffer circular de capacidad potencia de 2
+ * que tambien la duplica: agregar o quitar en cualquier extremo es O(1)
+ * amortizado, sin reservar memoria por elemento. Agregar elementos puede mover
+ * el arreglo, lo que invalida los iteradores y los apuntadores a elementos.
+ */
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Capacidad inicial de un contenedor (potencia de 2) */
+#define CONTAINER_INITIAL_CAPACITY 8
+
+/**
+ * @brief Define un vector contiguo de elementos de tipo type.
+ * @param name Nombre del tipo contenedor (prefijo de sus funciones)
+ * @param type Tipo de los elementos
+ */
+#define DEFINE_VECTOR(name, type)                                                                  \
+    typedef struct                                                                                 \
+    {                                                                                              \
+        type *items;  /*!< Elementos */                                                            \
+        int count;    /*!< Cantidad de elementos */                                                \
+        int capacity; /*!< Capacidad de items */                                                   \
+    } name;                                                                                        \
+                                                                                                   \
+    typedef type *name##_iterator;                                                                 \
+                                                                                                   \
+    static inline void init_##name(name *v)                                                        \
+    {                                                                                              \
+        v->items = NULL;                                                                           \
+        v->count = 0;                                                                              \
+        v->capacity = 0;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline void free_##name(name *v)                                                        \
+    {                                                                                              \
+        free(v->items);                                                                            \
+        init_##name(v);                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    static inline name *create_##name(void)                                                        \
+    {                                                                                              \
+        name *v = (name *)malloc(sizeof(name));                                                    \
+        init_##name(v);                                                                            \
+        return v;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static inline void destroy_##name(name *v)                                                     \
+    {                                                                                              \
+        if (v != NULL)                                                                             \
+        {                                                                                          \
+            free(v->items);                                                                        \
+            free(v);                                                                               \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_reserve(name *v, int capacity)                                       \
+    {                                                                                              \
+        if (capacity > v->capacity)                                                                \
+        {                                                                                          \
+            v->items = (type *)realloc(v->items, sizeof(type) * (size_t)capacity);                 \
+            v->capacity = capacity;                                                                \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_push_back(name *v, type value)                                       \
+    {                                                                                              \
+        if (v->count == v->capacity)                                                               \
+        {                                                                                          \
+            name##_reserve(v, v->capacity ? v->capacity * 2 : CONTAINER_INITIAL_CAPACITY);         \
+        }                                                                                          \
+        v->items[v->count++] = value;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_pop_back(name *v)                                                    \
+    {                                                                                              \
+        return v->items[--v->count];                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_back(const name *v)                                                  \
+    {                                                                                              \
+        return v->items[v->count - 1];                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static inline type *name##_at(const name *v, int i)                                            \
+    {                                                                                              \
+        return &v->items[i];                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_remove_at(name *v, int i)                                            \
+    {                                                                                              \
+        memmove(&v->items[i], &v->items[i + 1], sizeof(type) * (size_t)(v->count - i - 1));        \
+        v->count--;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_clear(name *v)                                                       \
+    {                                                                                              \
+        v->count = 0;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline int name##_empty(const name *v)                                                  \
+    {                                                                                              \
+        return v == NULL || v->count == 0;                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_head(const name *v)                                       \
+    {                                                                                              \
+        return (v->count > 0) ? v->items : NULL;                                                   \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_tail(const name *v)                                       \
+    {                                                                                              \
+        return (v->count > 0) ? &v->items[v->count - 1] : NULL;                                    \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_next(const name *v, name##_iterator it)                   \
+    {                                                                                              \
+        return (it + 1 < v->items + v->count) ? it + 1 : NULL;                                     \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_previous(const name *v, name##_iterator it)               \
+    {                                                                                              \
+        return (it > v->items) ? it - 1 : NULL;                                                    \
+    }
+
+/**
+ * @brief Define una cola doble circular de elementos de tipo type.
+ * @param name Nombre del tipo contenedor (prefijo de sus funciones)
+ * @param type Tipo de los elementos
+ */
+#define DEFINE_DEQUE(name, type)                                                                   \
+    typedef struct                                                                                 \
+    {                                                                                              \
+        type *items;  /*!< Buffer circular */                                                      \
+        int head;     /*!< Posicion del primer elemento */                                         \
+        int count;    /*!< Cantidad de elementos */                                                \
+        int capacity; /*!< Capacidad de items (0 o potencia de 2) */                               \
+    } name;                                                                                        \
+                                                                                                   \
+    typedef type *name##_iterator;                                                                 \
+                                                                                                   \
+    static inline void init_##name(name *d)                                                        \
+    {                                                                                              \
+        d->items = NULL;                                                                           \
+        d->head = 0;                                                                               \
+        d->count = 0;                                                                              \
+        d->capacity = 0;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline void free_##name(name *d)                                                        \
+    {                                                                                              \
+        free(d->items);                                                                            \
+        init_##name(d);                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    static inline name *create_##name(void)                                                        \
+    {                                                                                              \
+        name *d = (name *)malloc(sizeof(name));                                                    \
+        init_##name(d);                                                                            \
+        return d;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static inline void destroy_##name(name *d)                                                     \
+    {                                                                                              \
+        if (d != NULL)                                                                             \
+        {                                                                                          \
+            free(d->items);                                                                        \
+            free(d);                                                                               \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline type *name##_at(const name *d, int i)                                            \
+    {                                                                                              \
+        return &d->items[(d->head + i) & (d->capacity - 1)];                                       \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_reserve(name *d, int capacity)                                       \
+    {                                                                                              \
+        type *items;                                                                               \
+        int size = d->capacity ? d->capacity : CONTAINER_INITIAL_CAPACITY;                         \
+        int first;                                                                                 \
+                                                                                                   \
+        if (capacity <= d->capacity)                                                               \
+        {                                                                                          \
+            return;                                                                                \
+        }                                                                                          \
+        while (size < capacity)                                                                    \
+        {                                                                                          \
+            size *= 2;                                                                             \
+        }                                                                                          \
+        /* Copiar los elementos en orden al inicio del nuevo buffer */                             \
+        items = (type *)malloc(sizeof(type) * (size_t)size);                                       \
+        first = d->capacity - d->head;                                                             \
+        if (first > d->count)                                                                      \
+        {                                                                                          \
+            first = d->count;                                                                      \
+        }                                                                                          \
+        if (d->count > 0)                                                                          \
+        {                                                                                          \
+            memcpy(items, &d->items[d->head], sizeof(type) * (size_t)first);                       \
+            memcpy(items + first, d->items, sizeof(type) * (size_t)(d->count - first));            \
+        }                                                                                          \
+        free(d->items);                                                                            \
+        d->items = items;                                                                          \
+        d->head = 0;                                                                               \
+        d->capacity = size;                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_push_back(name *d, type value)                                       \
+    {                                                                                              \
+        if (d->count == d->capacity)                                                               \
+        {                                                                                          \
+            name##_reserve(d, d->count + 1);                                                       \
+        }                                                                                          \
+        *name##_at(d, d->count++) = value;                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_push_front(name *d, type value)                                      \
+    {                                                                                              \
+        if (d->count == d->capacity)                                                               \
+        {                                                                                          \
+            name##_reserve(d, d->count + 1);                                                       \
+        }                                                                                          \
+        d->head = (d->head - 1) & (d->capacity - 1);                                               \
+        d->items[d->head] = value;                                                                 \
+        d->count++;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_pop_front(name *d)                                                   \
+    {                                                                                              \
+        type value = d->items[d->head];                                                            \
+                                                                                                   \
+        d->head = (d->head + 1) & (d->capacity - 1);                                               \
+        d->count--;                                                                                \
+        return value;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_pop_back(name *d)                                                    \
+    {                                                                                              \
+        return *name##_at(d, --d->count);                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_front(const name *d)                                                 \
+    {                                                                                              \
+        return d->items[d->head];                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_back(const name *d)                                                  \
+    {                                                                                              \
+        return *name##_at(d, d->count - 1);                                                        \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_remove_at(name *d, int i)                                            \
+    {                                                                                              \
+        int j;                                                                                     \
+                                                                                                   \
+        /* Desplazar el lado mas corto */                                                          \
+        if (i < d->count / 2)                                                                      \
+        {                                                                                          \
+            for (j = i; j > 0; j--)                                                                \
+            {                                                                                      \
+                *name##_at(d, j) = *name##_at(d, j - 1);                                           \
+            }                                                                                      \
+            d->head = (d->head + 1) & (d->capacity - 1);                                           \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            for (j = i; j < d->count - 1; j++)                                                     \
+            {                                                                                      \
+                *name##_at(d, j) = *name##_at(d, j + 1);                                           \
+            }                                                                                      \
+        }                                                                                          \
+        d->count--;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    /* Inserta despues de los elementos que no van despues de value (compare > 0 = antes) */       \
+    static inline void name##_insert_ordered(name *d, type value,                                  \
+                                             int (*compare)(type const *, type const *))           \
+    {                                                                                              \
+        int lo = 0, hi = d->count, mid, j;                                                         \
+                                                                                                   \
+        while (lo < hi)                                                                            \
+        {                                                                                          \
+            mid = lo + (hi - lo) / 2;                                                              \
+            if (compare(&value, name##_at(d, mid)) <= 0)                                           \
+            {                                                                                      \
+                lo = mid + 1;                                                                      \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                hi = mid;                                                                          \
+            }                                                                                      \
+        }                                                                                          \
+        if (d->count == d->capacity)                                                               \
+        {                                                                                          \
+            name##_reserve(d, d->count + 1);                                                       \
+        }                                                                                          \
+        /* Abrir el hueco por el lado mas corto */                                                 \
+        if (lo < d->count / 2)                                                                     \
+        {                                                                                          \
+            d->head = (d->head - 1) & (d->capacity - 1);                                           \
+            for (j = 0; j < lo; j++)                                                               \
+            {                                                                                      \
+                *name##_at(d, j) = *name##_at(d, j + 1);                                           \
+            }                                                                                      \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            for (j = d->count; j > lo; j--)                                                        \
+            {                                                                                      \
+                *name##_at(d, j) = *name##_at(d, j - 1);                                           \
+            }                                                                                      \
+        }                                                                                          \
+        *name##_at(d, lo) = value;                                                                 \
+        d->count++;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_clear(name *d)                                                       \
+    {                                                                                              \
+        d->head = 0;                                                                               \
+        d->count = 0;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline int name##_empty(const name *d)                                                  \
+    {                                                                                              \
+        return d == NULL || d->count == 0;                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_head(const name *d)                                       \
+    {                                                                                              \
+        return (d->count > 0) ? &d->items[d->head] : NULL;                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_tail(const name *d)                                       \
+    {                                                                                              \
+        return (d->count > 0) ? name##_at(d, d->count - 1) : NULL;                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_next(const name *d, name##_iterator it)                   \
+    {                                                                                              \
+        int i = ((int)(it - d->items) - d->head) & (d->capacity - 1);                              \
+                                                                                                   \
+        return (i + 1 < d->count) ? name##_at(d, i + 1) : NULL;                                    \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_iterator name##_previous(const name *d, name##_iterator it)               \
+    {                                                                                              \
+        int i = ((int)(it - d->items) - d->head) & (d->capacity - 1);                              \
+                                                                                                   \
+        return (i > 0) ? name##_at(d, i - 1) : NULL;                                               \
+    }
+
+/**
+ * @brief Define un monticulo binario sobre un vector o una cola doble.
+ *
+ * Genera name_push(c, value, compare) y name_pop(c, compare), que mantienen
+ * en c un monticulo en el que el primer elemento (container_at(c, 0)) es el
+ * que va antes segun compare (positivo si a va antes que b). Solo usa at,
+ * push_back y pop_back: quitar el ultimo elemento conserva el monticulo.
+ * @param name Prefijo de las funciones
+ * @param container Tipo contenedor (definido con DEFINE_VECTOR o DEFINE_DEQUE)
+ * @param type Tipo de los elementos
+ */
+#define DEFINE_HEAP(name, container, type)                                                         \
+    static inline void name##_push(container *c, type value,                                       \
+                                   int (*compare)(type const *, type const *))                     \
+    {                                                                                              \
+        int i, parent;                                                                             \
+                                                                                                   \
+        container##_push_back(c, value);                                                           \
+        for (i = c->count - 1; i > 0; i = parent)                                                  \
+        {                                                                                          \
+            parent = (i - 1) / 2;                                                                  \
+            if (compare(container##_at(c, i), container##_at(c, parent)) <= 0)                     \
+            {                                                                                      \
+                break;                                                                             \
+            }                                                                                      \
+            *container##_at(c, i) = *container##_at(c, parent);                                    \
+            *container##_at(c, parent) = value;                                                    \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_pop(container *c, int (*compare)(type const *, type const *))        \
+    {                                                                                              \
+        type top = *container##_at(c, 0);                                                          \
+        type last = container##_pop_back(c);                                                       \
+        int i = 0, child;                                                                          \
+                                                                                                   \
+        if (c->count == 0)                                                                         \
+        {                                                                                          \
+            return top;                                                                            \
+        }                                                                                          \
+        for (;;)                                                                                   \
+        {                                                                                          \
+            child = 2 * i + 1;                                                                     \
+            if (child >= c->count)                                                                 \
+            {                                                                                      \
+                break;                                                                             \
+            }                                                                                      \
+            if (child + 1 < c->count &&                                                            \
+                compare(container##_at(c, child + 1), container##_at(c, child)) > 0)               \
+            {                                                                                      \
+                child++;                                                                           \
+            }                                                                                      \
+            if (compare(&last, container##_at(c, child)) >= 0)                                     \
+            {                                                                                      \
+                break;                                                                             \
+            }                                                                                      \
+            *container##_at(c, i) = *container##_at(c, child);                                     \
+            i = child;                                                                             \
+        }                                                                                          \
+        *container##_at(c, i) = last;                                                              \
+        return top;                                                                                \
+    }
+
+#endif
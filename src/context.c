@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Contexto de una simulacion: procesos, colas, opciones y salidas.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "context.h"
+#include "input.h"
+#include "realtime.h"
+#include "stats.h"
+
+void init_sched_context(sched_context *ctx, FILE *out, FILE *report)
+{
+    ctx->processes = create_process_vector();
+    ctx->queues = NULL;
+    ctx->nqueues = 0;
+    init_sched_options(&ctx->opts);
+    ctx->opts.out = out;
+    ctx->opts.report = report;
+}
+
+int load_sched_context(sched_context *ctx, FILE *input)
+{
+    input_state in;
+
+    init_input(&in, ctx->processes, &ctx->opts);
+    in.queues = ctx->queues;
+    in.nqueues = ctx->nqueues;
+    in.queues_defined = (ctx->queues != NULL);
+    in.next_pid = ctx->processes->count + 1;
+    read_input(&in, input);
+
+    // DEFINE queues crea colas nuevas
+    if (in.queues != ctx->queues && ctx->queues != NULL)
+    {
+        destroy_queues(ctx->queues, ctx->nqueues);
+    }
+    ctx->queues = in.queues;
+    ctx->nqueues = in.nqueues;
+
+    return ctx->nqueues;
+}
+
+int run_sched_context(sched_context *ctx)
+{
+    if (ctx->queues == NULL || ctx->nqueues <= 0)
+    {
+        fprintf(report_output(&ctx->opts), "Error: no se han definido las colas de prioridad\n");
+        return 0;
+    }
+    if (plan_periodic_jobs(ctx->processes, ctx->opts.horizon) < 0)
+    {
+        fprintf(report_output(&ctx->opts), "Error: el hiperperiodo de las tareas periodicas es "
+                                           "demasiado grande (use DEFINE horizon)\n");
+        return 0;
+    }
+
+    return schedule(ctx->processes, ctx->queues, ctx->nqueues, &ctx->opts);
+}
+
+void destroy_sched_context(sched_context *ctx)
+{
+    process_vector_iterator it;
+
+    for (it = process_vector_head(ctx->processes); it != 0;
+         it = process_vector_next(ctx->processes, it))
+    {
+        destroy_process(*it);
+    }
+    destroy_process_vector(ctx->processes);
+    ctx->processes = NULL;
+    if (ctx->queues != NULL)
+    {
+        destroy_queues(ctx->queues, ctx->nqueues);
+        ctx->queues = NULL;
+    }
+    if (ctx->opts.stats != NULL)
+    {
+        destroy_stats(ctx->opts.stats);
+        ctx->opts.stats = NULL;
+    }
+}
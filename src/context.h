@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Contexto de una simulacion: procesos, colas, opciones y salidas.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Un sched_context reune todo lo que necesita una simulacion: el vector de
+ * procesos, las colas de prioridad, las opciones y las salidas (mensajes y
+ * resultados). Las funciones del planificador solo usan el estado que
+ * reciben, de modo que varios contextos se pueden simular a la vez en hilos
+ * distintos (por ejemplo, las configuraciones de un barrido o las peticiones
+ * de un servicio que incluya el planificador) sin redirigir la salida
+ * estandar.
+ *
+ * El unico estado compartido entre contextos es el del proceso:
+ * - La tabla de nombres internados (ver intern.h), segura entre hilos.
+ * - La lista de diagramas de Gantt pendientes (ver plot.h), con un candado.
+ * La memoria se pide con malloc; la lista libre de registros del modo de
+ * memoria acotada es de cada process_stream (ver stream.h). La simulacion no
+ * usa numeros aleatorios: las llegadas y las rafagas vienen de la entrada.
+ */
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdio.h>
+
+#include "sched.h"
+
+/** @brief Contexto de una simulacion */
+typedef struct
+{
+    process_vector *processes; /*!< Procesos (del contexto) */
+    priority_queue *queues;    /*!< Colas de prioridad (del contexto), o NULL */
+    int nqueues;               /*!< Cantidad de colas de prioridad */
+    sched_options opts;        /*!< Opciones; out y report son las salidas del contexto */
+} sched_context;
+
+/**
+ * @brief Inicializa un contexto sin procesos ni colas, con las opciones por defecto.
+ * @param ctx Contexto
+ * @param out Salida de los mensajes de la simulacion, o NULL = stdout
+ * @param report Salida de los resultados, confirmaciones y errores, o NULL = stdout
+ */
+void init_sched_context(sched_context *ctx, FILE *out, FILE *report);
+
+/**
+ * @brief Lee los comandos de una entrada (DEFINE, PROCESS, PERIODIC) hasta START.
+ *
+ * Los procesos se agregan a los del contexto; DEFINE queues reemplaza las colas.
+ * @param ctx Contexto
+ * @param input Entrada
+ * @return Cantidad de colas configuradas.
+ */
+int load_sched_context(sched_context *ctx, FILE *input);
+
+/**
+ * @brief Planifica los trabajos de las tareas periodicas y simula el contexto.
+ * @param ctx Contexto con colas definidas
+ * @return 1 si se simulo, 0 en caso de error (el error va a opts.report).
+ */
+int run_sched_context(sched_context *ctx);
+
+/**
+ * @brief Libera los procesos, las colas y las estadisticas (opts.stats) del contexto.
+ *
+ * Las salidas no se cierran: son de quien creo el contexto.
+ * @param ctx Contexto
+ */
+void destroy_sched_context(sched_context *ctx);
+
+#endif
@@ -0,0 +1,736 @@
+/**
+ * @file
+ * @brief Exportacion de los resultados de la simulacion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "export.h"
+#include "util.h"
+
+/** @brief Version del formato columnar */
+#define COLUMNAR_VERSION 3
+
+/** @brief Longitud del nombre de una columna en el formato columnar (con al menos un nulo) */
+#define COLUMN_NAME_SIZE 32
+
+/** @brief Tipos de columna del formato columnar */
+enum column_type
+{
+    COLUMN_INT32 = 0,
+    COLUMN_STRING = 1,
+    COLUMN_DOUBLE = 2,
+    COLUMN_INT64 = 3
+};
+
+/** @brief Buffer de escritura: agrupa la salida en escrituras grandes */
+typedef struct
+{
+    FILE *file;  /*!< Archivo de salida */
+    char *data;  /*!< Datos pendientes de escribir */
+    size_t used; /*!< Bytes usados */
+    int error;   /*!< 1 si fallo alguna escritura */
+} out_buffer;
+
+/** @brief Metricas agregadas de una cola de prioridad */
+typedef struct
+{
+    int processes;         /*!< Procesos de la cola */
+    long long total_waiting;    /*!< Suma de tiempos de espera */
+    long long total_turnaround; /*!< Suma de tiempos de retorno */
+    long long total_response;   /*!< Suma de tiempos de respuesta */
+    long long context_switches; /*!< Suma de cambios de contexto */
+    long long cpu_time;         /*!< Suma de tiempos de CPU */
+    sim_time last_finish;       /*!< Tiempo de finalizacion del ultimo proceso */
+} queue_summary;
+
+/**
+ * @brief Abre un buffer de escritura.
+ * @param ob Buffer
+ * @param path Ruta del archivo
+ * @return 1 si se abrio el archivo, 0 en caso contrario.
+ */
+static int ob_open(out_buffer *ob, char *path);
+
+/**
+ * @brief Escribe el buffer en el archivo y lo cierra.
+ * @param ob Buffer
+ * @return 1 si todas las escrituras fueron exitosas, 0 en caso contrario.
+ */
+static int ob_close(out_buffer *ob);
+
+/**
+ * @brief Agrega bytes al buffer.
+ * @param ob Buffer
+ * @param data Datos
+ * @param n Cantidad de bytes
+ */
+static void ob_write(out_buffer *ob, const void *data, size_t n);
+
+/**
+ * @brief Agrega una cadena al buffer.
+ * @param ob Buffer
+ * @param str Cadena terminada en nulo
+ */
+static void ob_str(out_buffer *ob, const char *str);
+
+/**
+ * @brief Agrega un entero en decimal al buffer.
+ * @param ob Buffer
+ * @param value Valor
+ */
+static void ob_int(out_buffer *ob, long long value);
+
+/**
+ * @brief Agrega un numero real con dos decimales al buffer.
+ * @param ob Buffer
+ * @param value Valor
+ */
+static void ob_double(out_buffer *ob, double value);
+
+/**
+ * @brief Agrega un campo de texto CSV, entre comillas si es necesario.
+ * @param ob Buffer
+ * @param str Cadena
+ */
+static void ob_csv_str(out_buffer *ob, const char *str);
+
+/**
+ * @brief Agrega una cadena escapada para JSON (sin comillas).
+ * @param ob Buffer
+ * @param str Cadena
+ */
+static void ob_json_str(out_buffer *ob, const char *str);
+
+/**
+ * @brief Calcula las metricas agregadas por cola de prioridad.
+ * @param processes Vector de procesos (solo se cuentan los reportados)
+ * @param nqueues Cantidad de colas
+ * @param opts Opciones de la simulacion (ventana de medicion)
+ * @return Arreglo de nqueues resumenes (liberar con free).
+ */
+static queue_summary *summarize_queues(process_vector *processes, int nqueues,
+                                       const sched_options *opts);
+
+/**
+ * @brief Exporta en formato CSV.
+ */
+static int export_csv(char *path, process_vector *processes, priority_queue *queues,
+                      int nqueues, const sched_options *opts);
+
+/**
+ * @brief Exporta en formato JSON lines.
+ */
+static int export_jsonl(char *path, process_vector *processes, priority_queue *queues,
+                        int nqueues, const sched_options *opts);
+
+/**
+ * @brief Exporta en formato binario columnar.
+ */
+static int export_columnar(char *path, process_vector *processes, priority_queue *queues,
+                           int nqueues, const sched_options *opts);
+
+/**
+ * @brief Escribe el encabezado de una columna.
+ * @param ob Buffer
+ * @param name Nombre de la columna
+ * @param type Tipo de la columna
+ */
+static void write_column_header(out_buffer *ob, const char *name, uint32_t type);
+
+/** @brief Tiempo de retorno de un proceso */
+#define turnaround_time(p) ((p)->finished_time - (p)->arrival_time)
+
+/** @brief Tiempo de respuesta de un proceso (-1 si nunca tuvo la CPU) */
+#define response_time(p) (((p)->first_run_time < 0) ? -1 : (p)->first_run_time - (p)->arrival_time)
+
+int parse_export_format(char *name, export_format *format)
+{
+    if (equals(name, "csv"))
+    {
+        *format = EXPORT_CSV;
+    }
+    else if (equals(name, "jsonl") || equals(name, "json"))
+    {
+        *format = EXPORT_JSONL;
+    }
+    else if (equals(name, "col") || equals(name, "bin"))
+    {
+        *format = EXPORT_COLUMNAR;
+    }
+    else
+    {
+        return 0;
+    }
+    return 1;
+}
+
+int export_results(char *path, export_format format, process_vector *processes,
+                   priority_queue *queues, int nqueues, const sched_options *opts)
+{
+    switch (format)
+    {
+    case EXPORT_CSV:
+        return export_csv(path, processes, queues, nqueues, opts);
+    case EXPORT_JSONL:
+        return export_jsonl(path, processes, queues, nqueues, opts);
+    case EXPORT_COLUMNAR:
+        return export_columnar(path, processes, queues, nqueues, opts);
+    }
+    return 0;
+}
+
+static int export_csv(char *path, process_vector *processes, priority_queue *queues,
+                      int nqueues, const sched_options *opts)
+{
+    out_buffer ob;
+    process_vector_iterator it;
+    process *p;
+    queue_summary *summary;
+    char *base;
+    char *queues_path;
+    int i;
+    int ret;
+
+    if (!ob_open(&ob, path))
+    {
+        return 0;
+    }
+
+    ob_str(&ob, "pid,name,queue,arrival,burst,waiting,finished,turnaround,response,context_switches\n");
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (!process_reported(opts, p))
+        {
+            continue;
+        }
+        ob_int(&ob, p->pid);
+        ob_str(&ob, ",");
+        ob_csv_str(&ob, process_name(p));
+        ob_str(&ob, ",");
+        ob_int(&ob, p->priority + 1);
+        ob_str(&ob, ",");
+        ob_int(&ob, p->arrival_time);
+        ob_str(&ob, ",");
+        ob_int(&ob, p->execution_time);
+        ob_str(&ob, ",");
+        ob_int(&ob, p->waiting_time);
+        ob_str(&ob, ",");
+        ob_int(&ob, p->finished_time);
+        ob_str(&ob, ",");
+        ob_int(&ob, turnaround_time(p));
+        ob_str(&ob, ",");
+        ob_int(&ob, response_time(p));
+        ob_str(&ob, ",");
+        ob_int(&ob, p->context_switches);
+        ob_str(&ob, "\n");
+    }
+    ret = ob_close(&ob);
+
+    // Agregados por cola en un archivo aparte
+    base = remove_extension(path);
+    queues_path = concat(base != NULL ? base : path, "_queues.csv");
+    free(base);
+
+    if (ret && ob_open(&ob, queues_path))
+    {
+        summary = summarize_queues(processes, nqueues, opts);
+        ob_str(&ob, "queue,strategy,quantum,processes,avg_waiting,avg_turnaround,avg_response,"
+                    "context_switches,cpu_time,last_finish\n");
+        for (i = 0; i < nqueues; i++)
+        {
+            ob_int(&ob, i + 1);
+            ob_str(&ob, ",");
+            ob_str(&ob, strategy_name(queues[i].strategy));
+            ob_str(&ob, ",");
+            ob_int(&ob, queues[i].quantum);
+            ob_str(&ob, ",");
+            ob_int(&ob, summary[i].processes);
+            ob_str(&ob, ",");
+            ob_double(&ob, summary[i].processes ? (double)summary[i].total_waiting / summary[i].processes : 0);
+            ob_str(&ob, ",");
+            ob_double(&ob, summary[i].processes ? (double)summary[i].total_turnaround / summary[i].processes : 0);
+            ob_str(&ob, ",");
+            ob_double(&ob, summary[i].processes ? (double)summary[i].total_response / summary[i].processes : 0);
+            ob_str(&ob, ",");
+            ob_int(&ob, summary[i].context_switches);
+            ob_str(&ob, ",");
+            ob_int(&ob, summary[i].cpu_time);
+            ob_str(&ob, ",");
+            ob_int(&ob, summary[i].last_finish);
+            ob_str(&ob, "\n");
+        }
+        free(summary);
+        ret = ob_close(&ob);
+    }
+    else
+    {
+        ret = 0;
+    }
+
+    free(queues_path);
+    return ret;
+}
+
+static int export_jsonl(char *path, process_vector *processes, priority_queue *queues,
+                        int nqueues, const sched_options *opts)
+{
+    out_buffer ob;
+    process_vector_iterator it;
+    process *p;
+    queue_summary *summary;
+    int i;
+
+    if (!ob_open(&ob, path))
+    {
+        return 0;
+    }
+
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (!process_reported(opts, p))
+        {
+            continue;
+        }
+        ob_str(&ob, "{\"type\":\"process\",\"pid\":");
+        ob_int(&ob, p->pid);
+        ob_str(&ob, ",\"name\":\"");
+        ob_json_str(&ob, process_name(p));
+        ob_str(&ob, "\",\"queue\":");
+        ob_int(&ob, p->priority + 1);
+        ob_str(&ob, ",\"arrival\":");
+        ob_int(&ob, p->arrival_time);
+        ob_str(&ob, ",\"burst\":");
+        ob_int(&ob, p->execution_time);
+        ob_str(&ob, ",\"waiting\":");
+        ob_int(&ob, p->waiting_time);
+        ob_str(&ob, ",\"finished\":");
+        ob_int(&ob, p->finished_time);
+        ob_str(&ob, ",\"turnaround\":");
+        ob_int(&ob, turnaround_time(p));
+        ob_str(&ob, ",\"response\":");
+        ob_int(&ob, response_time(p));
+        ob_str(&ob, ",\"context_switches\":");
+        ob_int(&ob, p->context_switches);
+        ob_str(&ob, "}\n");
+    }
+
+    summary = summarize_queues(processes, nqueues, opts);
+    for (i = 0; i < nqueues; i++)
+    {
+        ob_str(&ob, "{\"type\":\"queue\",\"queue\":");
+        ob_int(&ob, i + 1);
+        ob_str(&ob, ",\"strategy\":\"");
+        ob_str(&ob, strategy_name(queues[i].strategy));
+        ob_str(&ob, "\",\"quantum\":");
+        ob_int(&ob, queues[i].quantum);
+        ob_str(&ob, ",\"processes\":");
+        ob_int(&ob, summary[i].processes);
+        ob_str(&ob, ",\"avg_waiting\":");
+        ob_double(&ob, summary[i].processes ? (double)summary[i].total_waiting / summary[i].processes : 0);
+        ob_str(&ob, ",\"avg_turnaround\":");
+        ob_double(&ob, summary[i].processes ? (double)summary[i].total_turnaround / summary[i].processes : 0);
+        ob_str(&ob, ",\"avg_response\":");
+        ob_double(&ob, summary[i].processes ? (double)summary[i].total_response / summary[i].processes : 0);
+        ob_str(&ob, ",\"context_switches\":");
+        ob_int(&ob, summary[i].context_switches);
+        ob_str(&ob, ",\"cpu_time\":");
+        ob_int(&ob, summary[i].cpu_time);
+        ob_str(&ob, ",\"last_finish\":");
+        ob_int(&ob, summary[i].last_finish);
+        ob_str(&ob, "}\n");
+    }
+    free(summary);
+
+    return ob_close(&ob);
+}
+
+static int export_columnar(char *path, process_vector *processes, priority_queue *queues,
+                           int nqueues, const sched_options *opts)
+{
+    out_buffer ob;
+    process_vector_iterator it;
+    process *p;
+    queue_summary *summary;
+    uint32_t u32;
+    uint32_t offset;
+    int32_t *column;
+    int64_t *wcolumn;
+    double *dcolumn;
+    int n = 0;
+    int i, c;
+
+    /* Columnas enteras de la tabla de procesos (los tiempos son de 64 bits) */
+    static const char *int_columns[] = {
+        "pid", "queue", "arrival", "burst", "waiting",
+        "finished", "turnaround", "response", "context_switches"};
+    static const uint32_t int_types[] = {
+        COLUMN_INT32, COLUMN_INT32, COLUMN_INT64, COLUMN_INT32, COLUMN_INT64,
+        COLUMN_INT64, COLUMN_INT64, COLUMN_INT64, COLUMN_INT64};
+    const int nint_columns = sizeof(int_columns) / sizeof(int_columns[0]);
+
+    if (!ob_open(&ob, path))
+    {
+        return 0;
+    }
+
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        n += process_reported(opts, *it);
+    }
+
+    ob_write(&ob, "SCHEDCOL", 8);
+    u32 = COLUMNAR_VERSION;
+    ob_write(&ob, &u32, sizeof(u32));
+
+    // Tabla de procesos
+    u32 = n;
+    ob_write(&ob, &u32, sizeof(u32));
+    u32 = nint_columns + 1;
+    ob_write(&ob, &u32, sizeof(u32));
+
+    column = (int32_t *)malloc(sizeof(int32_t) * (n > 0 ? n : 1));
+    wcolumn = (int64_t *)malloc(sizeof(int64_t) * (n > 0 ? n : 1));
+    for (c = 0; c < nint_columns; c++)
+    {
+        i = 0;
+        for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+        {
+            p = *it;
+            if (!process_reported(opts, p))
+            {
+                continue;
+            }
+            switch (c)
+            {
+            case 0: wcolumn[i++] = p->pid; break;
+            case 1: wcolumn[i++] = p->priority + 1; break;
+            case 2: wcolumn[i++] = p->arrival_time; break;
+            case 3: wcolumn[i++] = p->execution_time; break;
+            case 4: wcolumn[i++] = p->waiting_time; break;
+            case 5: wcolumn[i++] = p->finished_time; break;
+            case 6: wcolumn[i++] = turnaround_time(p); break;
+            case 7: wcolumn[i++] = response_time(p); break;
+            case 8: wcolumn[i++] = p->context_switches; break;
+            }
+        }
+        write_column_header(&ob, int_columns[c], int_types[c]);
+        if (int_types[c] == COLUMN_INT64)
+        {
+            ob_write(&ob, wcolumn, sizeof(int64_t) * n);
+            continue;
+        }
+        for (i = 0; i < n; i++)
+        {
+            column[i] = (int32_t)wcolumn[i];
+        }
+        ob_write(&ob, column, sizeof(int32_t) * n);
+    }
+    free(wcolumn);
+
+    // Columna de nombres: desplazamientos y luego los caracteres
+    write_column_header(&ob, "name", COLUMN_STRING);
+    offset = 0;
+    ob_write(&ob, &offset, sizeof(offset));
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (process_reported(opts, p))
+        {
+            offset += name_length(p->name);
+            ob_write(&ob, &offset, sizeof(offset));
+        }
+    }
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (process_reported(opts, p))
+        {
+            ob_str(&ob, process_name(p));
+        }
+    }
+    free(column);
+
+    // Tabla de colas
+    summary = summarize_queues(processes, nqueues, opts);
+    u32 = nqueues;
+    ob_write(&ob, &u32, sizeof(u32));
+    u32 = 10;
+    ob_write(&ob, &u32, sizeof(u32));
+
+    column = (int32_t *)malloc(sizeof(int32_t) * (nqueues > 0 ? nqueues : 1));
+    wcolumn = (int64_t *)malloc(sizeof(int64_t) * (nqueues > 0 ? nqueues : 1));
+    dcolumn = (double *)malloc(sizeof(double) * (nqueues > 0 ? nqueues : 1));
+
+    for (i = 0; i < nqueues; i++)
+    {
+        column[i] = i + 1;
+    }
+    write_column_header(&ob, "queue", COLUMN_INT32);
+    ob_write(&ob, column, sizeof(int32_t) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        column[i] = queues[i].quantum;
+    }
+    write_column_header(&ob, "quantum", COLUMN_INT32);
+    ob_write(&ob, column, sizeof(int32_t) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        column[i] = summary[i].processes;
+    }
+    write_column_header(&ob, "processes", COLUMN_INT32);
+    ob_write(&ob, column, sizeof(int32_t) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        dcolumn[i] = summary[i].processes ? (double)summary[i].total_waiting / summary[i].processes : 0;
+    }
+    write_column_header(&ob, "avg_waiting", COLUMN_DOUBLE);
+    ob_write(&ob, dcolumn, sizeof(double) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        dcolumn[i] = summary[i].processes ? (double)summary[i].total_turnaround / summary[i].processes : 0;
+    }
+    write_column_header(&ob, "avg_turnaround", COLUMN_DOUBLE);
+    ob_write(&ob, dcolumn, sizeof(double) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        dcolumn[i] = summary[i].processes ? (double)summary[i].total_response / summary[i].processes : 0;
+    }
+    write_column_header(&ob, "avg_response", COLUMN_DOUBLE);
+    ob_write(&ob, dcolumn, sizeof(double) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        wcolumn[i] = summary[i].context_switches;
+    }
+    write_column_header(&ob, "context_switches", COLUMN_INT64);
+    ob_write(&ob, wcolumn, sizeof(int64_t) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        wcolumn[i] = summary[i].cpu_time;
+    }
+    write_column_header(&ob, "cpu_time", COLUMN_INT64);
+    ob_write(&ob, wcolumn, sizeof(int64_t) * nqueues);
+
+    for (i = 0; i < nqueues; i++)
+    {
+        wcolumn[i] = summary[i].last_finish;
+    }
+    write_column_header(&ob, "last_finish", COLUMN_INT64);
+    ob_write(&ob, wcolumn, sizeof(int64_t) * nqueues);
+
+    write_column_header(&ob, "strategy", COLUMN_STRING);
+    offset = 0;
+    ob_write(&ob, &offset, sizeof(offset));
+    for (i = 0; i < nqueues; i++)
+    {
+        offset += strlen(strategy_name(queues[i].strategy));
+        ob_write(&ob, &offset, sizeof(offset));
+    }
+    for (i = 0; i < nqueues; i++)
+    {
+        ob_str(&ob, strategy_name(queues[i].strategy));
+    }
+
+    free(column);
+    free(wcolumn);
+    free(dcolumn);
+    free(summary);
+
+    return ob_close(&ob);
+}
+
+static queue_summary *summarize_queues(process_vector *processes, int nqueues,
+                                       const sched_options *opts)
+{
+    queue_summary *summary;
+    queue_summary *q;
+    process_vector_iterator it;
+    process *p;
+
+    summary = (queue_summary *)calloc(nqueues > 0 ? nqueues : 1, sizeof(queue_summary));
+
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (p->priority < 0 || p->priority >= nqueues || !process_reported(opts, p))
+        {
+            continue;
+        }
+        q = &summary[p->priority];
+        q->processes++;
+        q->total_waiting += p->waiting_time;
+        q->total_turnaround += turnaround_time(p);
+        q->total_response += (p->first_run_time < 0) ? 0 : response_time(p);
+        q->context_switches += p->context_switches;
+        q->cpu_time += p->cpu_time;
+        if (p->finished_time > q->last_finish)
+        {
+            q->last_finish = p->finished_time;
+        }
+    }
+
+    return summary;
+}
+
+static void write_column_header(out_buffer *ob, const char *name, uint32_t type)
+{
+    char column_name[COLUMN_NAME_SIZE];
+    size_t len = strlen(name);
+
+    // Los nombres son constantes de este archivo: uno mas largo es un error de programacion
+    if (len >= sizeof(column_name))
+    {
+        fprintf(stderr, "Error: nombre de columna demasiado largo: %s\n", name);
+        abort();
+    }
+    memset(column_name, 0, sizeof(column_name));
+    memcpy(column_name, name, len);
+    ob_write(ob, column_name, sizeof(column_name));
+    ob_write(ob, &type, sizeof(type));
+}
+
+static int ob_open(out_buffer *ob, char *path)
+{
+    ob->file = fopen(path, "wb");
+    if (ob->file == NULL)
+    {
+        return 0;
+    }
+    ob->data = (char *)malloc(EXPORT_BUFFER_SIZE);
+    ob->used = 0;
+    ob->error = 0;
+    return 1;
+}
+
+static int ob_close(out_buffer *ob)
+{
+    if (ob->used > 0 && fwrite(ob->data, 1, ob->used, ob->file) != ob->used)
+    {
+        ob->error = 1;
+    }
+    if (fclose(ob->file) != 0)
+    {
+        ob->error = 1;
+    }
+    free(ob->data);
+    ob->data = NULL;
+    ob->file = NULL;
+    return !ob->error;
+}
+
+static void ob_write(out_buffer *ob, const void *data, size_t n)
+{
+    // Escrituras grandes van directo al archivo
+    if (ob->used + n > EXPORT_BUFFER_SIZE)
+    {
+        if (ob->used > 0 && fwrite(ob->data, 1, ob->used, ob->file) != ob->used)
+        {
+            ob->error = 1;
+        }
+        ob->used = 0;
+        if (n > EXPORT_BUFFER_SIZE)
+        {
+            if (fwrite(data, 1, n, ob->file) != n)
+            {
+                ob->error = 1;
+            }
+            return;
+        }
+    }
+    memcpy(ob->data + ob->used, data, n);
+    ob->used += n;
+}
+
+static void ob_str(out_buffer *ob, const char *str)
+{
+    ob_write(ob, str, strlen(str));
+}
+
+static void ob_int(out_buffer *ob, long long value)
+{
+    char digits[24];
+    int pos = sizeof(digits);
+    unsigned long long v = (value < 0) ? -(unsigned long long)value : (unsigned long long)value;
+
+    // Conversion manual: evita el costo de printf por cada campo
+    do
+    {
+        digits[--pos] = '0' + (v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    if (value < 0)
+    {
+        digits[--pos] = '-';
+    }
+
+    ob_write(ob, digits + pos, sizeof(digits) - pos);
+}
+
+static void ob_double(out_buffer *ob, double value)
+{
+    char str[64];
+    int n;
+
+    n = snprintf(str, sizeof(str), "%.2f", value);
+    ob_write(ob, str, n);
+}
+
+static void ob_csv_str(out_buffer *ob, const char *str)
+{
+    if (strpbrk(str, ",\"\n") == NULL)
+    {
+        ob_str(ob, str);
+        return;
+    }
+
+    // Campo entre comillas, con las comillas internas duplicadas
+    ob_write(ob, "\"", 1);
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"')
+        {
+            ob_write(ob, "\"", 1);
+        }
+        ob_write(ob, str, 1);
+    }
+    ob_write(ob, "\"", 1);
+}
+
+static void ob_json_str(out_buffer *ob, const char *str)
+{
+    char escaped[8];
+
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            escaped[0] = '\\';
+            escaped[1] = *str;
+            ob_write(ob, escaped, 2);
+        }
+        else if ((unsigned char)*str < 0x20)
+        {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*str);
+            ob_write(ob, escaped, 6);
+        }
+        else
+        {
+            ob_write(ob, str, 1);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @brief Exportacion de los resultados de la simulacion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Formatos soportados:
+ * - csv: un archivo con una fila por proceso, y un archivo
+ *   <ruta>_queues.csv con una fila por cola de prioridad.
+ * - jsonl: un objeto JSON por linea, con "type":"process" o "type":"queue".
+ * - col: formato binario columnar (ver export_columnar()).
+ */
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "sched.h"
+
+/** @brief Tamano del buffer de escritura (bytes) */
+#define EXPORT_BUFFER_SIZE (1 << 20)
+
+/** @brief Formato de exportacion */
+typedef enum
+{
+    EXPORT_CSV,     /*!< Valores separados por comas */
+    EXPORT_JSONL,   /*!< Un objeto JSON por linea */
+    EXPORT_COLUMNAR /*!< Formato binario columnar */
+} export_format;
+
+/**
+ * @brief Obtiene el formato de exportacion a partir de su nombre.
+ * @param name Nombre del formato ("csv", "jsonl" o "col")
+ * @param format Salida: formato
+ * @return 1 si el nombre es valido, 0 en caso contrario.
+ */
+int parse_export_format(char *name, export_format *format);
+
+/**
+ * @brief Exporta las metricas por proceso y por cola de prioridad.
+ *
+ * Las metricas se toman directamente de la tabla de procesos: llegada,
+ * tamano, espera, finalizacion, retorno (finalizacion - llegada),
+ * respuesta (primera asignacion - llegada) y cambios de contexto.
+ * Como en el reporte, solo se exportan (y se promedian por cola) los
+ * procesos que finalizaron dentro de la ventana de medicion (ver
+ * process_reported()).
+ *
+ * El formato columnar contiene el encabezado "SCHEDCOL" (8 bytes) y la
+ * version (uint32), seguidos de dos tablas (procesos y colas). Cada tabla
+ * contiene la cantidad de filas y de columnas (uint32) y luego cada
+ * columna: nombre (32 bytes con relleno nulo), tipo (uint32: 0 = int32,
+ * 1 = cadena, 2 = double, 3 = int64) y los datos. Los tiempos (llegada,
+ * espera, finalizacion, retorno, respuesta, tiempo de CPU por cola) y los
+ * cambios de contexto son int64. Las cadenas se almacenan como
+ * desplazamientos (uint32, filas + 1) seguidos de los caracteres.
+ * @param path Ruta del archivo de salida
+ * @param format Formato de exportacion
+ * @param processes Vector de procesos simulados
+ * @param queues Colas de prioridad
+ * @param nqueues Cantidad de colas de prioridad
+ * @param opts Opciones de la simulacion (ventana de medicion)
+ * @return 1 si se exportaron los resultados, 0 en caso de error.
+ */
+int export_results(char *path, export_format format, process_vector *processes,
+                   priority_queue *queues, int nqueues, const sched_options *opts);
+
+#endif
@@ -0,0 +1,641 @@
+/**
+ * @file
+ * @brief Importacion de trazas reales del planificador de Linux.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "import.h"
+#include "intern.h"
+
+/** @brief Cantidad inicial de posiciones de la tabla de tareas (potencia de 2) */
+#define IMPORT_INITIAL_SLOTS 1024
+
+/** @brief Tipo de evento de la traza */
+typedef enum
+{
+    EVENT_NONE,   /*!< Linea sin evento reconocido */
+    EVENT_SWITCH, /*!< sched_switch: prev deja la CPU y next la recibe */
+    EVENT_WAKEUP  /*!< sched_wakeup o sched_wakeup_new: next queda lista */
+} event_type;
+
+/** @brief Evento de la traza */
+typedef struct
+{
+    event_type type;       /*!< Tipo de evento */
+    long long ts;          /*!< Tiempo del evento (microsegundos) */
+    int cpu;               /*!< CPU de la traza, o 0 si no aparece */
+    int prev_pid;          /*!< Tarea que deja la CPU (sched_switch) */
+    int prev_prio;         /*!< Prioridad de prev */
+    int prev_runnable;     /*!< 1 si prev sigue lista (prev_state R) */
+    int next_pid;          /*!< Tarea que recibe la CPU o que despierta */
+    int next_prio;         /*!< Prioridad de next */
+    const char *next_comm; /*!< Nombre de next (sin nulo) */
+    size_t next_len;       /*!< Longitud del nombre de next */
+} sched_event;
+
+/** @brief Tarea con una rafaga abierta */
+typedef struct
+{
+    int pid;             /*!< TID, o 0 si la posicion esta libre */
+    int prio;            /*!< Ultima prioridad de Linux observada */
+    int cpu;             /*!< CPU de la primera asignacion, o -1 */
+    name_id comm;        /*!< Nombre de la tarea */
+    long long arrival;   /*!< Inicio de la rafaga (microsegundos) */
+    long long run_start; /*!< Asignacion de CPU en curso, o -1 si no esta en la CPU */
+    long long ran;       /*!< Tiempo en la CPU durante la rafaga (microsegundos) */
+} task_state;
+
+/** @brief Tabla hash de tareas por PID (direccionamiento abierto, sondeo lineal) */
+typedef struct
+{
+    task_state *slots; /*!< Posiciones */
+    int nslots;        /*!< Cantidad de posiciones (potencia de 2) */
+    int count;         /*!< Tareas con rafaga abierta */
+    int peak;          /*!< Maximo de tareas abiertas a la vez */
+} task_table;
+
+/** @brief Estado de la importacion */
+typedef struct
+{
+    task_table tasks;          /*!< Rafagas abiertas */
+    process_vector *processes; /*!< Procesos importados */
+    long unit;                 /*!< Microsegundos por unidad de tiempo */
+    long long origin;          /*!< Tiempo del primer evento, o -1 */
+    long long last;            /*!< Tiempo del ultimo evento */
+    int pid;                   /*!< PID del siguiente proceso */
+    int nqueues;               /*!< Cantidad de colas */
+    int ncpus;                 /*!< Cantidad de CPUs */
+    long events;               /*!< Eventos reconocidos */
+    long dropped;              /*!< Rafagas en la CPU antes del primer evento */
+    long clamped;              /*!< Rafagas recortadas a SIM_DELTA_MAX */
+} importer;
+
+/**
+ * @brief Reconoce un evento en una linea de la traza.
+ * @param line Linea terminada en nulo
+ * @param ev Evento leido
+ * @return Tipo del evento, o EVENT_NONE si la linea no tiene un evento valido.
+ */
+static event_type parse_event(const char *line, sched_event *ev);
+
+/**
+ * @brief Lee el tiempo "segundos.fraccion:" que precede al nombre del evento.
+ * @param line Inicio de la linea
+ * @param event Nombre del evento dentro de la linea
+ * @param ev Evento (ts y cpu)
+ * @return 1 si se leyo el tiempo, 0 si no.
+ */
+static int parse_timestamp(const char *line, const char *event, sched_event *ev);
+
+/**
+ * @brief Busca el valor de un campo clave=valor.
+ * @param args Campos del evento
+ * @param key Clave con el '=' final
+ * @param until Texto que termina el valor, o NULL = primer espacio
+ * @param len Longitud del valor
+ * @return Inicio del valor, o NULL si la clave no aparece.
+ */
+static const char *find_field(const char *args, const char *key, const char *until, size_t *len);
+
+/**
+ * @brief Lee una tarea en el formato abreviado de perf: comm:pid [prio].
+ * @param start Inicio de la tarea
+ * @param comm Nombre (sin nulo)
+ * @param len Longitud del nombre
+ * @param pid PID
+ * @param prio Prioridad
+ * @return Caracter siguiente al ']', o NULL si el formato no coincide.
+ */
+static const char *parse_task(const char *start, const char **comm, size_t *len, int *pid,
+                              int *prio);
+
+/**
+ * @brief Busca una tarea en la tabla.
+ * @param tasks Tabla
+ * @param pid PID
+ * @return Tarea, o NULL si no tiene una rafaga abierta.
+ */
+static task_state *find_task(task_table *tasks, int pid);
+
+/**
+ * @brief Abre una rafaga para una tarea que no esta en la tabla.
+ * @param tasks Tabla
+ * @param pid PID
+ * @param ev Evento que la abre (tiempo, nombre y prioridad de next)
+ * @return Nueva tarea.
+ */
+static task_state *open_task(task_table *tasks, int pid, const sched_event *ev);
+
+/**
+ * @brief Quita una tarea de la tabla (desplazando hacia atras las siguientes).
+ * @param tasks Tabla
+ * @param t Tarea
+ */
+static void remove_task(task_table *tasks, task_state *t);
+
+/**
+ * @brief Agrega la rafaga de una tarea como proceso.
+ * @param imp Importacion
+ * @param t Tarea (si esta en la CPU, la rafaga llega hasta el ultimo evento)
+ */
+static void emit_burst(importer *imp, const task_state *t);
+
+/**
+ * @brief Aplica un evento a las rafagas abiertas.
+ * @param imp Importacion
+ * @param ev Evento
+ */
+static void apply_event(importer *imp, const sched_event *ev);
+
+/**
+ * @brief Obtiene la cola de una prioridad de Linux.
+ * @param prio Prioridad de Linux (0-99 tiempo real, 100-139 normal)
+ * @param nqueues Cantidad de colas
+ * @return Cola (0-based).
+ */
+static int queue_of(int prio, int nqueues);
+
+int import_sched_trace(const char *path, long unit, process_vector *processes, int nqueues,
+                       int ncpus, FILE *out)
+{
+    FILE *file;
+    char *line = NULL;
+    size_t capacity = 0;
+    sched_event ev;
+    importer imp;
+    int first = processes->count;
+    int i;
+
+    file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    memset(&imp, 0, sizeof(imp));
+    imp.tasks.nslots = IMPORT_INITIAL_SLOTS;
+    imp.tasks.slots = (task_state *)calloc(imp.tasks.nslots, sizeof(task_state));
+    imp.processes = processes;
+    imp.unit = unit;
+    imp.origin = -1;
+    imp.pid = processes->count + 1;
+    imp.nqueues = nqueues;
+    imp.ncpus = ncpus;
+
+    while (getline(&line, &capacity, file) != -1)
+    {
+        if (parse_event(line, &ev) != EVENT_NONE)
+        {
+            apply_event(&imp, &ev);
+        }
+    }
+    free(line);
+    fclose(file);
+
+    // Las rafagas que siguen abiertas se cierran en el ultimo evento (si llegaron a la CPU)
+    for (i = 0; i < imp.tasks.nslots; i++)
+    {
+        if (imp.tasks.slots[i].pid != 0 &&
+            (imp.tasks.slots[i].ran > 0 || imp.tasks.slots[i].run_start >= 0))
+        {
+            emit_burst(&imp, &imp.tasks.slots[i]);
+        }
+    }
+
+    fprintf(out, "Traza importada: %s (%ld eventos, %d rafagas, hasta %d tareas listas a la vez)\n",
+            path, imp.events, processes->count - first, imp.tasks.peak);
+    if (imp.dropped > 0)
+    {
+        fprintf(out, "Rafagas descartadas (ya en la CPU al comenzar la traza): %ld\n", imp.dropped);
+    }
+    if (imp.clamped > 0)
+    {
+        fprintf(out, "Rafagas recortadas a %d unidades: %ld\n", SIM_DELTA_MAX, imp.clamped);
+    }
+
+    free(imp.tasks.slots);
+    return processes->count - first;
+}
+
+static event_type parse_event(const char *line, sched_event *ev)
+{
+    const char *event;
+    const char *args;
+    const char *arrow;
+    const char *value;
+    const char *prev_comm;
+    size_t len;
+
+    ev->type = EVENT_NONE;
+    if ((event = strstr(line, "sched_switch: ")) != NULL)
+    {
+        ev->type = EVENT_SWITCH;
+        args = event + strlen("sched_switch: ");
+    }
+    else if ((event = strstr(line, "sched_wakeup: ")) != NULL)
+    {
+        ev->type = EVENT_WAKEUP;
+        args = event + strlen("sched_wakeup: ");
+    }
+    else if ((event = strstr(line, "sched_wakeup_new: ")) != NULL)
+    {
+        ev->type = EVENT_WAKEUP;
+        args = event + strlen("sched_wakeup_new: ");
+    }
+    else
+    {
+        return EVENT_NONE;
+    }
+    if (!parse_timestamp(line, event, ev))
+    {
+        return ev->type = EVENT_NONE;
+    }
+
+    if (ev->type == EVENT_WAKEUP)
+    {
+        // comm=foo pid=12 prio=120 [success=1] target_cpu=001, o foo:12 [120] ...
+        if ((value = find_field(args, "pid=", NULL, &len)) != NULL)
+        {
+            ev->next_pid = atoi(value);
+            ev->next_comm = find_field(args, "comm=", " pid=", &ev->next_len);
+            value = find_field(args, "prio=", NULL, &len);
+            ev->next_prio = (value != NULL) ? atoi(value) : IMPORT_NORMAL_PRIO + 20;
+        }
+        else if (parse_task(args, &ev->next_comm, &ev->next_len, &ev->next_pid, &ev->next_prio) ==
+                 NULL)
+        {
+            return ev->type = EVENT_NONE;
+        }
+        if (ev->next_comm == NULL)
+        {
+            ev->next_comm = "";
+            ev->next_len = 0;
+        }
+        return ev->type;
+    }
+
+    // prev_comm=a prev_pid=1 prev_prio=120 prev_state=S ==> next_comm=b next_pid=2 next_prio=120
+    if ((value = find_field(args, "prev_pid=", NULL, &len)) != NULL)
+    {
+        ev->prev_pid = atoi(value);
+        value = find_field(args, "prev_prio=", NULL, &len);
+        ev->prev_prio = (value != NULL) ? atoi(value) : IMPORT_NORMAL_PRIO + 20;
+        value = find_field(args, "prev_state=", NULL, &len);
+        ev->prev_runnable = (value != NULL && value[0] == 'R');
+        value = find_field(args, "next_pid=", NULL, &len);
+        if (value == NULL)
+        {
+            return ev->type = EVENT_NONE;
+        }
+        ev->next_pid = atoi(value);
+        value = find_field(args, "next_prio=", NULL, &len);
+        ev->next_prio = (value != NULL) ? atoi(value) : IMPORT_NORMAL_PRIO + 20;
+        ev->next_comm = find_field(args, "next_comm=", " next_pid=", &ev->next_len);
+        if (ev->next_comm == NULL)
+        {
+            ev->next_comm = "";
+            ev->next_len = 0;
+        }
+        return ev->type;
+    }
+
+    // a:1 [120] S ==> b:2 [120]
+    arrow = strstr(args, " ==> ");
+    value = (arrow != NULL) ? parse_task(args, &prev_comm, &len, &ev->prev_pid, &ev->prev_prio)
+                            : NULL;
+    if (value == NULL || value > arrow ||
+        parse_task(arrow + strlen(" ==> "), &ev->next_comm, &ev->next_len, &ev->next_pid,
+                   &ev->next_prio) == NULL)
+    {
+        return ev->type = EVENT_NONE;
+    }
+    while (*value == ' ')
+    {
+        value++;
+    }
+    ev->prev_runnable = (value[0] == 'R');
+    return ev->type;
+}
+
+static int parse_timestamp(const char *line, const char *event, sched_event *ev)
+{
+    const char *end = event;
+    const char *start;
+    const char *s;
+    char *next;
+    long long sec;
+    long frac = 0;
+    long cpu;
+    int digits = 0;
+
+    // perf script antepone "sched:" al nombre del evento
+    if (end - line >= 6 && strncmp(end - 6, "sched:", 6) == 0)
+    {
+        end -= 6;
+    }
+    while (end > line && end[-1] == ' ')
+    {
+        end--;
+    }
+    if (end == line || end[-1] != ':')
+    {
+        return 0;
+    }
+    end--;
+    for (start = end; start > line && (isdigit((unsigned char)start[-1]) || start[-1] == '.');
+         start--)
+    {
+    }
+    if (start == end || !isdigit((unsigned char)*start))
+    {
+        return 0;
+    }
+
+    // segundos.fraccion, con 6 (us) o 9 (ns) decimales: se conservan los microsegundos
+    sec = strtoll(start, &next, 10);
+    s = next;
+    if (*s == '.')
+    {
+        for (s++; s < end && isdigit((unsigned char)*s); s++)
+        {
+            if (digits < 6)
+            {
+                frac = frac * 10 + (*s - '0');
+                digits++;
+            }
+        }
+    }
+    for (; digits < 6; digits++)
+    {
+        frac *= 10;
+    }
+    ev->ts = sec * 1000000 + frac;
+
+    // La CPU es el ultimo [NNN] antes del tiempo
+    ev->cpu = 0;
+    for (s = start; s > line; s--)
+    {
+        if (s[-1] != '[' || !isdigit((unsigned char)*s))
+        {
+            continue;
+        }
+        cpu = strtol(s, &next, 10);
+        if (*next == ']')
+        {
+            ev->cpu = (int)cpu;
+            break;
+        }
+    }
+
+    return 1;
+}
+
+static const char *find_field(const char *args, const char *key, const char *until, size_t *len)
+{
+    const char *value = args;
+    const char *end;
+    size_t klen = strlen(key);
+
+    // La clave debe comenzar un campo: "pid=" no coincide con "prev_pid="
+    while ((value = strstr(value, key)) != NULL && value != args && value[-1] != ' ')
+    {
+        value += klen;
+    }
+    if (value == NULL)
+    {
+        return NULL;
+    }
+    value += klen;
+
+    end = (until != NULL) ? strstr(value, until) : NULL;
+    if (end == NULL)
+    {
+        end = value + strcspn(value, (until != NULL) ? "\n" : " \t\n");
+    }
+    while (end > value && (end[-1] == ' ' || end[-1] == '\r'))
+    {
+        end--;
+    }
+    *len = end - value;
+    return value;
+}
+
+static const char *parse_task(const char *start, const char **comm, size_t *len, int *pid,
+                              int *prio)
+{
+    const char *bracket;
+    const char *colon;
+    char *end;
+
+    // El nombre puede tener ':' y espacios: el PID sigue al ultimo ':' antes de " ["
+    bracket = strstr(start, " [");
+    if (bracket == NULL)
+    {
+        return NULL;
+    }
+    for (colon = bracket; colon > start && colon[-1] != ':'; colon--)
+    {
+    }
+    if (colon == start || !isdigit((unsigned char)*colon))
+    {
+        return NULL;
+    }
+    *comm = start;
+    *len = colon - 1 - start;
+    *pid = atoi(colon);
+    *prio = (int)strtol(bracket + 2, &end, 10);
+    if (*end != ']')
+    {
+        return NULL;
+    }
+    return end + 1;
+}
+
+static task_state *find_task(task_table *tasks, int pid)
+{
+    int k;
+
+    for (k = (unsigned)pid * 2654435761u & (tasks->nslots - 1); tasks->slots[k].pid != 0;
+         k = (k + 1) & (tasks->nslots - 1))
+    {
+        if (tasks->slots[k].pid == pid)
+        {
+            return &tasks->slots[k];
+        }
+    }
+    return NULL;
+}
+
+static task_state *open_task(task_table *tasks, int pid, const sched_event *ev)
+{
+    task_state *old;
+    int nold, i, k;
+
+    // Carga maxima 1/2: duplicar y reubicar
+    if (2 * (tasks->count + 1) > tasks->nslots)
+    {
+        old = tasks->slots;
+        nold = tasks->nslots;
+        tasks->nslots *= 2;
+        tasks->slots = (task_state *)calloc(tasks->nslots, sizeof(task_state));
+        for (i = 0; i < nold; i++)
+        {
+            if (old[i].pid == 0)
+            {
+                continue;
+            }
+            for (k = (unsigned)old[i].pid * 2654435761u & (tasks->nslots - 1);
+                 tasks->slots[k].pid != 0; k = (k + 1) & (tasks->nslots - 1))
+            {
+            }
+            tasks->slots[k] = old[i];
+        }
+        free(old);
+    }
+
+    for (k = (unsigned)pid * 2654435761u & (tasks->nslots - 1); tasks->slots[k].pid != 0;
+         k = (k + 1) & (tasks->nslots - 1))
+    {
+    }
+    tasks->slots[k].pid = pid;
+    tasks->slots[k].prio = ev->next_prio;
+    tasks->slots[k].cpu = -1;
+    tasks->slots[k].comm = intern_name_len(ev->next_comm, ev->next_len);
+    tasks->slots[k].arrival = ev->ts;
+    tasks->slots[k].run_start = -1;
+    tasks->slots[k].ran = 0;
+
+    tasks->count++;
+    tasks->peak = (tasks->count > tasks->peak) ? tasks->count : tasks->peak;
+    return &tasks->slots[k];
+}
+
+static void remove_task(task_table *tasks, task_state *t)
+{
+    int mask = tasks->nslots - 1;
+    int hole = (int)(t - tasks->slots);
+    int k, home;
+
+    // Borrado con desplazamiento hacia atras: no quedan marcas de borrado
+    for (k = (hole + 1) & mask; tasks->slots[k].pid != 0; k = (k + 1) & mask)
+    {
+        home = (unsigned)tasks->slots[k].pid * 2654435761u & mask;
+        if (((k - home) & mask) >= ((k - hole) & mask))
+        {
+            tasks->slots[hole] = tasks->slots[k];
+            hole = k;
+        }
+    }
+    tasks->slots[hole].pid = 0;
+    tasks->count--;
+}
+
+static void emit_burst(importer *imp, const task_state *t)
+{
+    process *p;
+    long long ran = t->ran;
+    long long execution;
+
+    if (t->run_start >= 0)
+    {
+        ran += imp->last - t->run_start;
+    }
+    execution = (ran + imp->unit / 2) / imp->unit;
+    if (execution < 1)
+    {
+        execution = 1;
+    }
+    if (execution > SIM_DELTA_MAX)
+    {
+        execution = SIM_DELTA_MAX;
+        imp->clamped++;
+    }
+
+    // El nombre ya esta internado: se asigna directamente
+    p = create_process("", (t->arrival > imp->origin) ? (t->arrival - imp->origin) / imp->unit : 0,
+                       (sim_delta)execution);
+    p->name = t->comm;
+    p->pid = imp->pid++;
+    p->priority = queue_of(t->prio, imp->nqueues);
+    p->cpu = (t->cpu >= 0) ? t->cpu % imp->ncpus : 0;
+    process_vector_push_back(imp->processes, p);
+}
+
+static void apply_event(importer *imp, const sched_event *ev)
+{
+    task_state *t;
+
+    if (imp->origin < 0)
+    {
+        imp->origin = ev->ts;
+    }
+    // Los eventos de distintas CPUs pueden llegar algo desordenados
+    imp->last = (ev->ts > imp->last) ? ev->ts : imp->last;
+    imp->events++;
+
+    if (ev->type == EVENT_WAKEUP)
+    {
+        // Una tarea que ya esta lista no abre otra rafaga
+        if (ev->next_pid != 0 && find_task(&imp->tasks, ev->next_pid) == NULL)
+        {
+            open_task(&imp->tasks, ev->next_pid, ev);
+        }
+        return;
+    }
+
+    // La tarea 0 (idle) no se simula
+    if (ev->prev_pid != 0)
+    {
+        t = find_task(&imp->tasks, ev->prev_pid);
+        if (t == NULL || t->run_start < 0)
+        {
+            // Estaba en la CPU antes del primer evento: su rafaga esta incompleta
+            imp->dropped += (t == NULL && !ev->prev_runnable);
+        }
+        else
+        {
+            t->ran += (ev->ts > t->run_start) ? ev->ts - t->run_start : 0;
+            t->run_start = -1;
+            t->prio = ev->prev_prio;
+            if (!ev->prev_runnable)
+            {
+                emit_burst(imp, t);
+                remove_task(&imp->tasks, t);
+            }
+        }
+    }
+
+    if (ev->next_pid != 0)
+    {
+        t = find_task(&imp->tasks, ev->next_pid);
+        if (t == NULL)
+        {
+            t = open_task(&imp->tasks, ev->next_pid, ev);
+        }
+        t->run_start = ev->ts;
+        t->prio = ev->next_prio;
+        if (t->cpu < 0)
+        {
+            t->cpu = ev->cpu;
+        }
+    }
+}
+
+static int queue_of(int prio, int nqueues)
+{
+    if (prio < IMPORT_NORMAL_PRIO || nqueues == 1)
+    {
+        return 0;
+    }
+    if (prio >= IMPORT_NORMAL_PRIO + IMPORT_NORMAL_LEVELS)
+    {
+        prio = IMPORT_NORMAL_PRIO + IMPORT_NORMAL_LEVELS - 1;
+    }
+    return 1 + (prio - IMPORT_NORMAL_PRIO) * (nqueues - 1) / IMPORT_NORMAL_LEVELS;
+}
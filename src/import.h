@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief Importacion de trazas reales del planificador de Linux.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Lee la salida de texto de `perf script` o de ftrace (trace, trace_pipe)
+ * con los eventos sched_switch, sched_wakeup y sched_wakeup_new, y
+ * reconstruye las rafagas de CPU de cada tarea: una rafaga comienza cuando
+ * la tarea despierta (o la primera vez que se le asigna la CPU) y termina
+ * cuando deja la CPU sin seguir lista (prev_state distinto de R). Cada
+ * rafaga es un proceso cuya llegada es el despertar y cuyo tiempo de
+ * ejecucion es el tiempo que la tarea estuvo en la CPU durante la rafaga.
+ *
+ * La traza se lee en una sola pasada, linea por linea, de modo que puede
+ * ser un archivo de varios GB o una tuberia (`<(perf script)`). Solo se
+ * guardan en memoria las tareas con una rafaga abierta, en una tabla hash
+ * por PID (TID) con direccionamiento abierto; la tabla no crece con la
+ * longitud de la traza sino con la cantidad de tareas listas a la vez.
+ *
+ * Los campos se aceptan en formato clave=valor (prev_comm=... prev_pid=...)
+ * o en el formato abreviado de perf (comm:pid [prio] S ==> comm:pid [prio]).
+ * Las demas lineas se ignoran.
+ */
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include "sched.h"
+
+/** @brief Prioridad de Linux a partir de la cual una tarea es normal (no de tiempo real) */
+#define IMPORT_NORMAL_PRIO 100
+
+/** @brief Cantidad de prioridades normales de Linux (nice -20..19) */
+#define IMPORT_NORMAL_LEVELS 40
+
+/**
+ * @brief Importa las rafagas de una traza de sched_switch/sched_wakeup.
+ *
+ * Las llegadas se miden desde el primer evento de la traza, en unidades de
+ * unit microsegundos; las duraciones se redondean a la unidad mas cercana
+ * (al menos 1). Las tareas de tiempo real van a la cola 1 y las normales se
+ * reparten por nice entre las colas restantes. Con varias CPUs, cada proceso
+ * queda en la CPU de la traza en la que se ejecuto primero (modulo ncpus).
+ * Las rafagas abiertas al final de la traza se cierran en su ultimo evento;
+ * las que ya estaban en la CPU al comenzar se descartan.
+ * @param path Ruta de la traza (archivo o tuberia)
+ * @param unit Microsegundos por unidad de tiempo de la simulacion
+ * @param processes Vector de procesos (los PIDs siguen a los existentes)
+ * @param nqueues Cantidad de colas de prioridad
+ * @param ncpus Cantidad de CPUs
+ * @param out Salida del resumen de la importacion
+ * @return Cantidad de procesos importados, o -1 si no se pudo leer la traza.
+ */
+int import_sched_trace(const char *path, long unit, process_vector *processes, int nqueues,
+                       int ncpus, FILE *out);
+
+#endif
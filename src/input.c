@@ -0,0 +1,295 @@
+/**
+ * @file
+ * @brief Lectura de los comandos de entrada (DEFINE, PROCESS, PERIODIC, START)
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+#include "split.h"
+#include "util.h"
+#include "realtime.h"
+
+#define MAX_LINE 1024
+
+void init_input(input_state *in, process_vector *processes, sched_options *opts)
+{
+    in->processes = processes;
+    in->queues = NULL;
+    in->nqueues = 0;
+    in->opts = opts;
+    in->next_pid = 1;
+    in->queues_defined = 0;
+    in->spare = NULL;
+    in->out = report_output(opts);
+}
+
+int process_input(process_vector *processes, priority_queue **queues, int *nqueues, sched_options *opts)
+{
+    input_state in;
+    
+    init_input(&in, processes, opts);
+    read_input(&in, stdin);
+    
+    *queues = in.queues;
+    *nqueues = in.nqueues;
+    return *nqueues;
+}
+
+int read_input(input_state *in, FILE *input)
+{
+    char line[MAX_LINE];
+
+    while (fgets(line, MAX_LINE, input)) {
+        if (process_command(in, line)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int process_command(input_state *in, char *line)
+{
+    split_list *parts;
+    
+    // Remover salto de linea
+    line[strcspn(line, "\n")] = '\0';
+    
+    // Ignorar lineas vacias y comentarios
+    if (strlen(line) == 0 || line[0] == '#') {
+        return 0;
+    }
+    
+    parts = split(line, NULL);
+    
+    if (parts->count == 0) {
+        free_split_list(parts);
+        return 0;
+    }
+    
+    // Convertir comando a minusculas para comparacion
+    lcase(parts->parts[0]);
+    
+    if (equals(parts->parts[0], "define")) {
+        if (parts->count < 3) {
+            fprintf(in->out, "Error: comando DEFINE incompleto\n");
+            free_split_list(parts);
+            return 0;
+        }
+        
+        lcase(parts->parts[1]);
+        
+        if (equals(parts->parts[1], "cpus")) {
+            // DEFINE cpus n
+            if (atoi(parts->parts[2]) < 1) {
+                fprintf(in->out, "Error: cantidad de CPUs invalida: %s\n", parts->parts[2]);
+                free_split_list(parts);
+                return 0;
+            }
+            in->opts->ncpus = atoi(parts->parts[2]);
+            fprintf(in->out, "Definidas %d CPUs\n", in->opts->ncpus);
+        }
+        else if (equals(parts->parts[1], "migration")) {
+            // DEFINE migration on|off
+            lcase(parts->parts[2]);
+            in->opts->migration = equals(parts->parts[2], "on");
+            fprintf(in->out, "Migracion entre CPUs %s\n",
+                    in->opts->migration ? "activada" : "desactivada");
+        }
+        else if (equals(parts->parts[1], "horizon")) {
+            // DEFINE horizon T
+            if (strtoll(parts->parts[2], NULL, 10) < 1) {
+                fprintf(in->out, "Error: horizonte invalido: %s\n", parts->parts[2]);
+                free_split_list(parts);
+                return 0;
+            }
+            in->opts->horizon = strtoll(parts->parts[2], NULL, 10);
+            fprintf(in->out, "Horizonte de las tareas periodicas: %" PRIsim "\n",
+                    in->opts->horizon);
+        }
+        else if (equals(parts->parts[1], "queues")) {
+            // DEFINE queues n
+            in->nqueues = atoi(parts->parts[2]);
+            in->queues = create_queues(in->nqueues);
+            in->queues_defined = 1;
+            fprintf(in->out, "Definidas %d colas de prioridad\n", in->nqueues);
+        }
+        else if (equals(parts->parts[1], "scheduling")) {
+            // DEFINE scheduling queue_num strategy
+            if (parts->count < 4 || !in->queues_defined) {
+                fprintf(in->out, "Error: debe definir las colas antes de configurar estrategias\n");
+                free_split_list(parts);
+                return 0;
+            }
+            
+            int queue_num = atoi(parts->parts[2]);
+            char *strategy_str = parts->parts[3];
+            lcase(strategy_str);
+            
+            if (queue_num < 1 || queue_num > in->nqueues) {
+                fprintf(in->out, "Error: numero de cola invalido: %d\n", queue_num);
+                free_split_list(parts);
+                return 0;
+            }
+            
+            if (equals(strategy_str, "rr")) {
+                in->queues[queue_num-1].strategy = RR;
+                fprintf(in->out, "Cola %d configurada con estrategia RR\n", queue_num);
+            } else if (equals(strategy_str, "fifo")) {
+                in->queues[queue_num-1].strategy = FIFO;
+                fprintf(in->out, "Cola %d configurada con estrategia FIFO\n", queue_num);
+            } else if (equals(strategy_str, "edf")) {
+                in->queues[queue_num-1].strategy = EDF;
+                fprintf(in->out, "Cola %d configurada con estrategia EDF\n", queue_num);
+            } else if (equals(strategy_str, "rm")) {
+                in->queues[queue_num-1].strategy = RM;
+                fprintf(in->out, "Cola %d configurada con estrategia RM\n", queue_num);
+            } else {
+                fprintf(in->out, "Error: estrategia no soportada: %s (use RR, FIFO, EDF o RM)\n",
+                        strategy_str);
+            }
+        }
+        else if (equals(parts->parts[1], "quantum")) {
+            // DEFINE quantum queue_num quantum_value
+            if (parts->count < 4 || !in->queues_defined) {
+                fprintf(in->out, "Error: debe definir las colas antes de configurar quantum\n");
+                free_split_list(parts);
+                return 0;
+            }
+            
+            int queue_num = atoi(parts->parts[2]);
+            int quantum_value = atoi(parts->parts[3]);
+            
+            if (queue_num < 1 || queue_num > in->nqueues) {
+                fprintf(in->out, "Error: numero de cola invalido: %d\n", queue_num);
+                free_split_list(parts);
+                return 0;
+            }
+            
+            in->queues[queue_num-1].quantum = quantum_value;
+            fprintf(in->out, "Cola %d configurada con quantum %d\n", queue_num, quantum_value);
+        }
+    }
+    else if (equals(parts->parts[0], "process")) {
+        // PROCESS name arrival_time execution_time priority [cpu]
+        if (parts->count < 5) {
+            fprintf(in->out, "Error: comando PROCESS incompleto\n");
+            free_split_list(parts);
+            return 0;
+        }
+        
+        char *name = parts->parts[1];
+        sim_time arrival_time = strtoll(parts->parts[2], NULL, 10);
+        long long execution_time = strtoll(parts->parts[3], NULL, 10);
+        int priority = atoi(parts->parts[4]);
+        // La CPU es opcional; lo que sigue a '#' es un comentario
+        int cpu = (parts->count > 5 && parts->parts[5][0] != '#') ? atoi(parts->parts[5]) : 1;
+        
+        if (!in->queues_defined || priority < 1 || priority > in->nqueues) {
+            fprintf(in->out, "Error: prioridad invalida %d (debe estar entre 1 y %d)\n", priority,
+                    in->nqueues);
+            free_split_list(parts);
+            return 0;
+        }
+        
+        if (cpu < 1 || cpu > in->opts->ncpus) {
+            fprintf(in->out, "Error: CPU invalida %d (debe estar entre 1 y %d)\n", cpu,
+                    in->opts->ncpus);
+            free_split_list(parts);
+            return 0;
+        }
+
+        // Las rafagas son duraciones de 32 bits (ver simtime.h)
+        if (execution_time < 0 || execution_time > SIM_DELTA_MAX) {
+            fprintf(in->out, "Error: tiempo de ejecucion invalido %lld (debe estar entre 0 y %d)\n",
+                    execution_time, SIM_DELTA_MAX);
+            free_split_list(parts);
+            return 0;
+        }
+        
+        // En el modo de memoria acotada se reutiliza el registro de un proceso finalizado
+        process *p;
+        if (in->spare != NULL && !process_vector_empty(in->spare)) {
+            p = process_vector_pop_back(in->spare);
+            reuse_process(p, name, arrival_time, (sim_delta)execution_time);
+        } else {
+            p = create_process(name, arrival_time, (sim_delta)execution_time);
+        }
+        p->pid = in->next_pid++;
+        p->priority = priority - 1; // Convertir a 0-based
+        p->cpu = cpu - 1;
+        
+        process_vector_push_back(in->processes, p);
+        
+        fprintf(in->out, "Proceso agregado: %s (llegada:%" PRIsim ", ejecucion:%lld, prioridad:%d)\n",
+                name, arrival_time, execution_time, priority);
+    }
+    else if (equals(parts->parts[0], "periodic")) {
+        // PERIODIC name phase period wcet deadline priority [cpu]
+        if (parts->count < 7) {
+            fprintf(in->out, "Error: comando PERIODIC incompleto\n");
+            free_split_list(parts);
+            return 0;
+        }
+        
+        char *name = parts->parts[1];
+        sim_time phase = strtoll(parts->parts[2], NULL, 10);
+        long long period = strtoll(parts->parts[3], NULL, 10);
+        long long wcet = strtoll(parts->parts[4], NULL, 10);
+        long long deadline = strtoll(parts->parts[5], NULL, 10);
+        int priority = atoi(parts->parts[6]);
+        int cpu = (parts->count > 7 && parts->parts[7][0] != '#') ? atoi(parts->parts[7]) : 1;
+        
+        if (!in->queues_defined || priority < 1 || priority > in->nqueues) {
+            fprintf(in->out, "Error: prioridad invalida %d (debe estar entre 1 y %d)\n", priority,
+                    in->nqueues);
+            free_split_list(parts);
+            return 0;
+        }
+        
+        if (cpu < 1 || cpu > in->opts->ncpus) {
+            fprintf(in->out, "Error: CPU invalida %d (debe estar entre 1 y %d)\n", cpu,
+                    in->opts->ncpus);
+            free_split_list(parts);
+            return 0;
+        }
+
+        // Un plazo de 0 o menos es implicito (igual al periodo)
+        if (deadline <= 0) {
+            deadline = period;
+        }
+        if (phase < 0 || period < 1 || period > SIM_DELTA_MAX || deadline > SIM_DELTA_MAX ||
+            wcet < 0 || wcet > SIM_DELTA_MAX) {
+            fprintf(in->out, "Error: tarea periodica invalida %s (fase >= 0, periodo, plazo y WCET "
+                    "entre 0 y %d)\n", name, SIM_DELTA_MAX);
+            free_split_list(parts);
+            return 0;
+        }
+        
+        process *p = create_periodic_process(name, phase, (sim_delta)period, (sim_delta)wcet,
+                                             (sim_delta)deadline);
+        p->pid = in->next_pid++;
+        p->priority = priority - 1; // Convertir a 0-based
+        p->cpu = cpu - 1;
+        
+        process_vector_push_back(in->processes, p);
+        
+        fprintf(in->out, "Tarea periodica agregada: %s (fase:%" PRIsim ", periodo:%lld, WCET:%lld, "
+                "plazo:%lld, prioridad:%d)\n", name, phase, period, wcet, deadline, priority);
+    }
+    else if (equals(parts->parts[0], "start")) {
+        fprintf(in->out, "Iniciando simulacion...\n\n");
+        free_split_list(parts);
+        return 1;
+    }
+    else {
+        fprintf(in->out, "Comando desconocido: %s\n", parts->parts[0]);
+    }
+    
+    free_split_list(parts);
+    
+    return 0;
+}
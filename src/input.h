@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Lectura de los comandos de entrada (DEFINE, PROCESS, PERIODIC, START)
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "sched.h"
+
+/** @brief Estado de la lectura de comandos */
+typedef struct
+{
+    process_vector *processes; /*!< Vector de procesos */
+    priority_queue *queues;    /*!< Colas de prioridad, o NULL */
+    int nqueues;               /*!< Cantidad de colas de prioridad */
+    sched_options *opts;       /*!< Opciones (DEFINE cpus, DEFINE migration, DEFINE horizon) */
+    int next_pid;              /*!< PID del siguiente proceso */
+    int queues_defined;        /*!< 1 si ya se ejecuto DEFINE queues */
+    process_vector *spare;     /*!< Registros de procesos para reutilizar (ver stream.h), o NULL */
+    FILE *out;                 /*!< Salida de las confirmaciones y errores de los comandos */
+} input_state;
+
+/**
+ * @brief Inicializa el estado de la lectura de comandos
+ *
+ * Las confirmaciones y errores de los comandos van a la salida de los
+ * resultados de las opciones (opts->report, o stdout).
+ * @param in Estado
+ * @param processes Vector de procesos
+ * @param opts Opciones de la simulacion
+ */
+void init_input(input_state *in, process_vector *processes, sched_options *opts);
+
+/**
+ * @brief Procesa los comandos de la entrada estandar hasta START
+ * @param processes Vector de procesos
+ * @param queues Colas de prioridad
+ * @param nqueues Numero de colas de prioridad
+ * @param opts Opciones de la simulacion (DEFINE cpus, DEFINE migration, DEFINE horizon)
+ * @return Numero de colas configuradas
+ */
+int process_input(process_vector *processes, priority_queue **queues, int *nqueues, sched_options *opts);
+
+/**
+ * @brief Procesa los comandos de una entrada hasta START o el fin del archivo
+ * @param in Estado de la lectura
+ * @param input Entrada
+ * @return 1 si se leyo START, 0 si la entrada termino antes.
+ */
+int read_input(input_state *in, FILE *input);
+
+/**
+ * @brief Procesa una linea de comando
+ * @param in Estado de la lectura
+ * @param line Linea (se modifica)
+ * @return 1 si la linea es START, 0 en otro caso.
+ */
+int process_command(input_state *in, char *line);
+
+#endif
@@ -0,0 +1,375 @@
+/**
+ * @file
+ * @brief Tabla global de nombres internados.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "intern.h"
+
+/** @brief Tamano de cada bloque de la arena (bytes) */
+#define INTERN_BLOCK_SIZE (64 * 1024)
+
+/** @brief Cantidad inicial de posiciones del indice (potencia de 2) */
+#define INTERN_INITIAL_SLOTS 256
+
+/** @brief Nombres de la primera pagina; la pagina k tiene INTERN_PAGE_BASE << k */
+#define INTERN_PAGE_BASE (INTERN_INITIAL_SLOTS / 2)
+
+/** @brief Paginas de nombres (suficientes para todos los name_id de 32 bits) */
+#define INTERN_MAX_PAGES 26
+
+/** @brief Bloque de la arena */
+typedef struct arena_block
+{
+    struct arena_block *next; /*!< Bloque anterior */
+    size_t used;              /*!< Bytes usados */
+    size_t size;              /*!< Capacidad de data */
+    char data[];              /*!< Cadenas terminadas en nulo */
+} arena_block;
+
+/** @brief Referencias de un nombre que ya no se libera (la cadena vacia o un contador lleno) */
+#define NAME_PINNED UINT32_MAX
+
+/** @brief Nombre internado */
+typedef struct
+{
+    char *string;      /*!< Cadena en la arena */
+    uint32_t length;   /*!< Cantidad de caracteres */
+    uint32_t capacity; /*!< Bytes de la cadena en la arena (con el nulo) */
+    uint32_t refs;     /*!< Referencias, 0 = identificador libre, o NAME_PINNED */
+} name_entry;
+
+/** @brief Tabla de nombres */
+typedef struct
+{
+    arena_block *blocks;                 /*!< Bloque actual de la arena (enlaza los anteriores) */
+    name_entry *pages[INTERN_MAX_PAGES]; /*!< Nombres por identificador (paginas fijas) */
+    uint32_t count;                      /*!< Cantidad de nombres (se publica al final) */
+    uint32_t *slots;                     /*!< Indice por hash: identificador + 1, o 0 = libre */
+    uint32_t nslots;                     /*!< Cantidad de posiciones del indice */
+    uint32_t *free_ids;                  /*!< Identificadores liberados, para reutilizar */
+    uint32_t nfree;                      /*!< Cantidad de identificadores liberados */
+    uint32_t free_capacity;              /*!< Capacidad de free_ids */
+} name_table;
+
+/** @brief Tabla global */
+static name_table names;
+
+/** @brief Serializa intern_name_len(), release_name() y destroy_names() */
+static pthread_mutex_t names_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Calcula el hash FNV-1a de una cadena.
+ * @param str Caracteres
+ * @param len Cantidad de caracteres
+ * @return Hash de 32 bits.
+ */
+static uint32_t hash_name(const char *str, size_t len);
+
+/**
+ * @brief Copia una cadena en la arena.
+ * @param str Caracteres
+ * @param len Cantidad de caracteres
+ * @return Copia terminada en nulo (no se mueve hasta destroy_names()).
+ */
+static char *arena_copy(const char *str, size_t len);
+
+/**
+ * @brief Duplica el indice y reubica los identificadores.
+ */
+static void grow_slots(void);
+
+/**
+ * @brief Quita un nombre del indice, corriendo hacia atras los que le siguen.
+ * @param id Identificador
+ */
+static void remove_slot(name_id id);
+
+/**
+ * @brief Obtiene la posicion de un nombre en las paginas.
+ * @param id Identificador (su pagina debe existir)
+ * @return Nombre.
+ */
+static name_entry *find_entry(name_id id);
+
+/**
+ * @brief Busca un nombre en el indice (con names_lock tomado).
+ * @param str Caracteres
+ * @param len Cantidad de caracteres
+ * @param k Posicion del indice donde esta o donde se debe insertar
+ * @return Identificador, o -1 si el nombre no esta.
+ */
+static int64_t lookup_name(const char *str, size_t len, uint32_t *k);
+
+name_id intern_name(const char *str)
+{
+    return intern_name_len(str, strlen(str));
+}
+
+name_id intern_name_len(const char *str, size_t len)
+{
+    name_entry *entry;
+    int64_t found;
+    uint32_t k, id, page;
+
+    pthread_mutex_lock(&names_lock);
+
+    // La cadena vacia es siempre el identificador 0
+    if (names.nslots == 0)
+    {
+        names.nslots = INTERN_INITIAL_SLOTS;
+        names.slots = (uint32_t *)calloc(names.nslots, sizeof(uint32_t));
+        lookup_name("", 0, &k);
+        names.pages[0] = (name_entry *)malloc(sizeof(name_entry) * INTERN_PAGE_BASE);
+        names.pages[0][0].string = arena_copy("", 0);
+        names.pages[0][0].length = 0;
+        names.pages[0][0].capacity = 1;
+        names.pages[0][0].refs = NAME_PINNED;
+        names.slots[k] = 1;
+        __atomic_store_n(&names.count, 1, __ATOMIC_RELEASE);
+    }
+
+    found = lookup_name(str, len, &k);
+    if (found >= 0)
+    {
+        entry = find_entry((name_id)found);
+        if (entry->refs != NAME_PINNED)
+        {
+            entry->refs++;
+        }
+        pthread_mutex_unlock(&names_lock);
+        return (name_id)found;
+    }
+
+    // Un identificador liberado conserva su cadena: se reescribe si el nombre cabe
+    if (names.nfree > 0)
+    {
+        id = names.free_ids[--names.nfree];
+        entry = find_entry(id);
+        if (entry->capacity < len + 1)
+        {
+            entry->string = arena_copy(str, len);
+            entry->capacity = (uint32_t)len + 1;
+        }
+        memcpy(entry->string, str, len);
+        entry->string[len] = '\0';
+        entry->length = (uint32_t)len;
+        entry->refs = 1;
+        names.slots[k] = id + 1;
+        pthread_mutex_unlock(&names_lock);
+        return id;
+    }
+
+    // Nombre nuevo: se escribe completo antes de publicar el nuevo count, de
+    // modo que name_string() y name_length() lo leen sin tomar el candado
+    id = names.count;
+    page = 31 - __builtin_clz(id / INTERN_PAGE_BASE + 1);
+    if (names.pages[page] == NULL)
+    {
+        names.pages[page] =
+            (name_entry *)malloc(sizeof(name_entry) * ((size_t)INTERN_PAGE_BASE << page));
+    }
+    entry = find_entry(id);
+    entry->string = arena_copy(str, len);
+    entry->length = (uint32_t)len;
+    entry->capacity = (uint32_t)len + 1;
+    entry->refs = 1;
+    names.slots[k] = id + 1;
+    __atomic_store_n(&names.count, id + 1, __ATOMIC_RELEASE);
+
+    // Mantener el indice a lo sumo a la mitad
+    if (names.count * 2 > names.nslots)
+    {
+        grow_slots();
+    }
+
+    pthread_mutex_unlock(&names_lock);
+    return id;
+}
+
+void release_name(name_id id)
+{
+    name_entry *entry;
+
+    pthread_mutex_lock(&names_lock);
+    if (id == NAME_EMPTY || id >= names.count)
+    {
+        pthread_mutex_unlock(&names_lock);
+        return;
+    }
+    entry = find_entry(id);
+    if (entry->refs == 0 || entry->refs == NAME_PINNED || --entry->refs > 0)
+    {
+        pthread_mutex_unlock(&names_lock);
+        return;
+    }
+
+    // Sin referencias: el nombre sale del indice y su identificador se reutiliza
+    remove_slot(id);
+    if (names.nfree == names.free_capacity)
+    {
+        names.free_capacity = (names.free_capacity > 0) ? names.free_capacity * 2 : 64;
+        names.free_ids = (uint32_t *)realloc(names.free_ids,
+                                             sizeof(uint32_t) * names.free_capacity);
+    }
+    names.free_ids[names.nfree++] = id;
+    pthread_mutex_unlock(&names_lock);
+}
+
+const char *name_string(name_id id)
+{
+    return (id < __atomic_load_n(&names.count, __ATOMIC_ACQUIRE)) ? find_entry(id)->string : "";
+}
+
+size_t name_length(name_id id)
+{
+    return (id < __atomic_load_n(&names.count, __ATOMIC_ACQUIRE)) ? find_entry(id)->length : 0;
+}
+
+void destroy_names(void)
+{
+    arena_block *block;
+    int i;
+
+    pthread_mutex_lock(&names_lock);
+    while (names.blocks != NULL)
+    {
+        block = names.blocks;
+        names.blocks = block->next;
+        free(block);
+    }
+    for (i = 0; i < INTERN_MAX_PAGES; i++)
+    {
+        free(names.pages[i]);
+    }
+    free(names.slots);
+    free(names.free_ids);
+    memset(&names, 0, sizeof(names));
+    pthread_mutex_unlock(&names_lock);
+}
+
+static uint32_t hash_name(const char *str, size_t len)
+{
+    uint32_t h = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static char *arena_copy(const char *str, size_t len)
+{
+    arena_block *block = names.blocks;
+    size_t size;
+    char *copy;
+
+    if (block == NULL || block->size - block->used < len + 1)
+    {
+        size = (len + 1 > INTERN_BLOCK_SIZE) ? len + 1 : INTERN_BLOCK_SIZE;
+        block = (arena_block *)malloc(sizeof(arena_block) + size);
+        block->used = 0;
+        block->size = size;
+        if (size > INTERN_BLOCK_SIZE && names.blocks != NULL)
+        {
+            // Un nombre mas largo que un bloque recibe su propio bloque, detras del actual
+            block->next = names.blocks->next;
+            names.blocks->next = block;
+        }
+        else
+        {
+            block->next = names.blocks;
+            names.blocks = block;
+        }
+    }
+
+    copy = block->data + block->used;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    block->used += len + 1;
+
+    return copy;
+}
+
+static void grow_slots(void)
+{
+    name_entry *entry;
+    uint32_t id, k;
+
+    free(names.slots);
+    names.nslots *= 2;
+    names.slots = (uint32_t *)calloc(names.nslots, sizeof(uint32_t));
+    for (id = 0; id < names.count; id++)
+    {
+        entry = find_entry(id);
+        if (entry->refs == 0)
+        {
+            continue;
+        }
+        for (k = hash_name(entry->string, entry->length) & (names.nslots - 1);
+             names.slots[k] != 0; k = (k + 1) & (names.nslots - 1))
+        {
+        }
+        names.slots[k] = id + 1;
+    }
+}
+
+static void remove_slot(name_id id)
+{
+    name_entry *entry = find_entry(id);
+    uint32_t mask = names.nslots - 1;
+    uint32_t i, j, home;
+
+    for (i = hash_name(entry->string, entry->length) & mask; names.slots[i] != id + 1;
+         i = (i + 1) & mask)
+    {
+    }
+
+    // Sondeo lineal: un nombre posterior sube al hueco si su posicion natural
+    // no queda entre el hueco y el lugar donde esta
+    for (j = (i + 1) & mask; names.slots[j] != 0; j = (j + 1) & mask)
+    {
+        entry = find_entry(names.slots[j] - 1);
+        home = hash_name(entry->string, entry->length) & mask;
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            names.slots[i] = names.slots[j];
+            i = j;
+        }
+    }
+    names.slots[i] = 0;
+}
+
+static name_entry *find_entry(name_id id)
+{
+    // La pagina k empieza en el identificador INTERN_PAGE_BASE * (2^k - 1)
+    uint32_t page = 31 - __builtin_clz(id / INTERN_PAGE_BASE + 1);
+
+    return &names.pages[page][id - INTERN_PAGE_BASE * ((1u << page) - 1)];
+}
+
+static int64_t lookup_name(const char *str, size_t len, uint32_t *k)
+{
+    name_entry *entry;
+    uint32_t id;
+
+    for (*k = hash_name(str, len) & (names.nslots - 1); names.slots[*k] != 0;
+         *k = (*k + 1) & (names.nslots - 1))
+    {
+        id = names.slots[*k] - 1;
+        entry = find_entry(id);
+        if (entry->length == len && memcmp(entry->string, str, len) == 0)
+        {
+            return id;
+        }
+    }
+    return -1;
+}
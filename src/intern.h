@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Tabla global de nombres internados.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Cada nombre distinto se guarda una sola vez en una arena y se identifica
+ * con un name_id de 32 bits: los procesos guardan el identificador y los
+ * nombres se resuelven solo al imprimir o graficar. Dos nombres son iguales
+ * si y solo si sus identificadores lo son.
+ *
+ * La arena crece por bloques que no se mueven, de modo que las cadenas
+ * devueltas por name_string() son validas hasta destroy_names(). La tabla
+ * es la misma para todas las simulaciones del proceso (la comparten, por
+ * ejemplo, las de un barrido en paralelo) y es segura entre hilos:
+ * intern_name() toma un candado, y name_string() y name_length() no lo
+ * toman, porque los nombres se guardan en paginas que tampoco se mueven y
+ * cada nombre se publica completo. destroy_names() se llama al terminar,
+ * sin otros hilos usando la tabla.
+ *
+ * Cada intern_name() suma una referencia al nombre. Quien descarta sus
+ * procesos antes de terminar (el modo de memoria acotada, ver stream.h)
+ * devuelve la referencia con release_name(): un nombre sin referencias sale
+ * del indice y su identificador y su cadena se reutilizan para el siguiente
+ * nombre nuevo, de modo que la tabla crece con los nombres en uso y no con
+ * todos los leidos. Los demas nombres viven hasta destroy_names().
+ */
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Identificador de un nombre internado */
+typedef uint32_t name_id;
+
+/** @brief Identificador de la cadena vacia (valor de un proceso sin nombre) */
+#define NAME_EMPTY 0
+
+/**
+ * @brief Interna una cadena terminada en nulo.
+ * @param str Cadena
+ * @return Identificador del nombre (el mismo para cadenas iguales).
+ */
+name_id intern_name(const char *str);
+
+/**
+ * @brief Interna los primeros len caracteres de una cadena (sin nulo).
+ * @param str Caracteres
+ * @param len Cantidad de caracteres
+ * @return Identificador del nombre (el mismo para cadenas iguales).
+ */
+name_id intern_name_len(const char *str, size_t len);
+
+/**
+ * @brief Devuelve una referencia a un nombre obtenida con intern_name().
+ *
+ * Sin referencias, el identificador deja de ser valido y se reutiliza: quien
+ * lo libera no debe seguir resolviendolo. La cadena vacia no se libera.
+ * @param id Identificador
+ */
+void release_name(name_id id);
+
+/**
+ * @brief Obtiene la cadena de un nombre internado.
+ * @param id Identificador
+ * @return Cadena terminada en nulo, o "" si el identificador no existe.
+ */
+const char *name_string(name_id id);
+
+/**
+ * @brief Obtiene la longitud de un nombre internado.
+ * @param id Identificador
+ * @return Cantidad de caracteres (sin el nulo).
+ */
+size_t name_length(name_id id);
+
+/**
+ * @brief Libera la tabla de nombres y su arena.
+ */
+void destroy_names(void);
+
+#endif
@@ -0,0 +1,372 @@
+/**
+ * @file
+ * @brief Kernels vectoriales sobre columnas de enteros.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#endif
+
+#include "kernels.h"
+
+/** @brief Implementacion de la reduccion de una columna */
+typedef void (*reduce_kernel)(const int *column, int count, column_summary *summary);
+
+/** @brief Implementacion de la reduccion de una columna de tiempos */
+typedef void (*reduce_time_kernel)(const sim_time *column, int count, time_summary *summary);
+
+/** @brief Implementacion disponible de los kernels */
+typedef struct
+{
+    const char *name;               /*!< Nombre de la implementacion */
+    reduce_kernel reduce;           /*!< Reduccion de una columna */
+    reduce_time_kernel reduce_time; /*!< Reduccion de una columna de tiempos */
+} kernel_set;
+
+/**
+ * @brief Reduccion escalar (portable).
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+static void reduce_scalar(const int *column, int count, column_summary *summary);
+
+/**
+ * @brief Reduccion escalar de una columna de tiempos (portable).
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+static void reduce_time_scalar(const sim_time *column, int count, time_summary *summary);
+
+#ifdef KERNELS_X86
+/**
+ * @brief Reduccion con SSE4.2 (4 valores por iteracion).
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+static void reduce_sse42(const int *column, int count, column_summary *summary);
+
+/**
+ * @brief Reduccion de tiempos con SSE4.2 (2 valores por iteracion).
+ *
+ * La comparacion de 64 bits (_mm_cmpgt_epi64) es de SSE4.2: por eso el
+ * conjunto completo se llama "sse4.2" aunque reduce_sse42() solo use SSE4.1.
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+static void reduce_time_sse42(const sim_time *column, int count, time_summary *summary);
+
+/**
+ * @brief Reduccion con AVX2 (8 valores por iteracion).
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+static void reduce_avx2(const int *column, int count, column_summary *summary);
+
+/**
+ * @brief Reduccion de tiempos con AVX2 (4 valores por iteracion).
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+static void reduce_time_avx2(const sim_time *column, int count, time_summary *summary);
+#endif
+
+/**
+ * @brief Indica si la CPU soporta una implementacion.
+ * @param set Implementacion
+ * @return 1 si la soporta, 0 en caso contrario.
+ */
+static int kernel_supported(const kernel_set *set);
+
+/** @brief Implementaciones, de la mas rapida a la portable */
+static const kernel_set kernel_sets[] = {
+#ifdef KERNELS_X86
+    {"avx2", reduce_avx2, reduce_time_avx2},
+    {"sse4.2", reduce_sse42, reduce_time_sse42},
+#endif
+    {"scalar", reduce_scalar, reduce_time_scalar},
+};
+
+/** @brief Implementacion en uso, o NULL si aun no se eligio */
+static const kernel_set *current = NULL;
+
+/**
+ * @brief Obtiene la implementacion en uso, eligiendo la mejor soportada la primera vez.
+ * @return Implementacion en uso.
+ */
+static const kernel_set *kernels(void);
+
+int process_column(const process_vector *processes, size_t offset, int *column)
+{
+    int n;
+
+    for (n = 0; n < processes->count; n++)
+    {
+        column[n] = *(const int *)((const char *)processes->items[n] + offset);
+    }
+    return n;
+}
+
+void column_reduce(const int *column, int count, column_summary *summary)
+{
+    kernels()->reduce(column, count, summary);
+}
+
+int time_column(const process_vector *processes, size_t offset, sim_time *column)
+{
+    int n;
+
+    for (n = 0; n < processes->count; n++)
+    {
+        column[n] = *(const sim_time *)((const char *)processes->items[n] + offset);
+    }
+    return n;
+}
+
+void time_column_reduce(const sim_time *column, int count, time_summary *summary)
+{
+    kernels()->reduce_time(column, count, summary);
+}
+
+const char *kernels_name(void)
+{
+    return kernels()->name;
+}
+
+int use_kernels(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(kernel_sets) / sizeof(kernel_sets[0]); i++)
+    {
+        if (strcmp(kernel_sets[i].name, name) == 0 && kernel_supported(&kernel_sets[i]))
+        {
+            __atomic_store_n(&current, &kernel_sets[i], __ATOMIC_RELEASE);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const kernel_set *kernels(void)
+{
+    const kernel_set *set = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+    size_t i;
+
+    // Si dos hilos eligen a la vez, ambos escriben la misma implementacion
+    for (i = 0; set == NULL; i++)
+    {
+        if (kernel_supported(&kernel_sets[i]))
+        {
+            set = &kernel_sets[i];
+            __atomic_store_n(&current, set, __ATOMIC_RELEASE);
+        }
+    }
+    return set;
+}
+
+static int kernel_supported(const kernel_set *set)
+{
+#ifdef KERNELS_X86
+    if (strcmp(set->name, "avx2") == 0)
+    {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (strcmp(set->name, "sse4.2") == 0)
+    {
+        return __builtin_cpu_supports("sse4.2");
+    }
+#endif
+    return strcmp(set->name, "scalar") == 0;
+}
+
+static void reduce_scalar(const int *column, int count, column_summary *summary)
+{
+    int min = INT_MAX;
+    int max = INT_MIN;
+    long long sum = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        min = (column[i] < min) ? column[i] : min;
+        max = (column[i] > max) ? column[i] : max;
+        sum += column[i];
+    }
+
+    summary->min = min;
+    summary->max = max;
+    summary->sum = sum;
+}
+
+static void reduce_time_scalar(const sim_time *column, int count, time_summary *summary)
+{
+    sim_time min = SIM_TIME_MAX;
+    sim_time max = SIM_TIME_MIN;
+    sim_time sum = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        min = (column[i] < min) ? column[i] : min;
+        max = (column[i] > max) ? column[i] : max;
+        sum += column[i];
+    }
+
+    summary->min = min;
+    summary->max = max;
+    summary->sum = sum;
+}
+
+#ifdef KERNELS_X86
+__attribute__((target("sse4.2")))
+static void reduce_sse42(const int *column, int count, column_summary *summary)
+{
+    __m128i vmin = _mm_set1_epi32(INT_MAX);
+    __m128i vmax = _mm_set1_epi32(INT_MIN);
+    __m128i vsum = _mm_setzero_si128();
+    __m128i v;
+    int lanes[4];
+    long long sums[2];
+    int i, k;
+
+    // La suma se acumula en 64 bits: dos valores por registro
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        v = _mm_loadu_si128((const __m128i *)(column + i));
+        vmin = _mm_min_epi32(vmin, v);
+        vmax = _mm_max_epi32(vmax, v);
+        vsum = _mm_add_epi64(vsum, _mm_cvtepi32_epi64(v));
+        vsum = _mm_add_epi64(vsum, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+    }
+
+    reduce_scalar(column + i, count - i, summary);
+    _mm_storeu_si128((__m128i *)lanes, vmin);
+    for (k = 0; k < 4; k++)
+    {
+        summary->min = (lanes[k] < summary->min) ? lanes[k] : summary->min;
+    }
+    _mm_storeu_si128((__m128i *)lanes, vmax);
+    for (k = 0; k < 4; k++)
+    {
+        summary->max = (lanes[k] > summary->max) ? lanes[k] : summary->max;
+    }
+    _mm_storeu_si128((__m128i *)sums, vsum);
+    summary->sum += sums[0] + sums[1];
+}
+
+__attribute__((target("sse4.2")))
+static void reduce_time_sse42(const sim_time *column, int count, time_summary *summary)
+{
+    __m128i vmin = _mm_set1_epi64x(SIM_TIME_MAX);
+    __m128i vmax = _mm_set1_epi64x(SIM_TIME_MIN);
+    __m128i vsum = _mm_setzero_si128();
+    __m128i v;
+    sim_time lanes[2];
+    int i, k;
+
+    // Sin min/max de 64 bits: se comparan y se mezclan los valores
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        v = _mm_loadu_si128((const __m128i *)(column + i));
+        vmin = _mm_blendv_epi8(vmin, v, _mm_cmpgt_epi64(vmin, v));
+        vmax = _mm_blendv_epi8(vmax, v, _mm_cmpgt_epi64(v, vmax));
+        vsum = _mm_add_epi64(vsum, v);
+    }
+
+    reduce_time_scalar(column + i, count - i, summary);
+    _mm_storeu_si128((__m128i *)lanes, vmin);
+    for (k = 0; k < 2; k++)
+    {
+        summary->min = (lanes[k] < summary->min) ? lanes[k] : summary->min;
+    }
+    _mm_storeu_si128((__m128i *)lanes, vmax);
+    for (k = 0; k < 2; k++)
+    {
+        summary->max = (lanes[k] > summary->max) ? lanes[k] : summary->max;
+    }
+    _mm_storeu_si128((__m128i *)lanes, vsum);
+    summary->sum += lanes[0] + lanes[1];
+}
+
+__attribute__((target("avx2")))
+static void reduce_avx2(const int *column, int count, column_summary *summary)
+{
+    __m256i vmin = _mm256_set1_epi32(INT_MAX);
+    __m256i vmax = _mm256_set1_epi32(INT_MIN);
+    __m256i vsum = _mm256_setzero_si256();
+    __m256i v;
+    int lanes[8];
+    long long sums[4];
+    int i, k;
+
+    // La suma se acumula en 64 bits: cuatro valores por registro
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        v = _mm256_loadu_si256((const __m256i *)(column + i));
+        vmin = _mm256_min_epi32(vmin, v);
+        vmax = _mm256_max_epi32(vmax, v);
+        vsum = _mm256_add_epi64(vsum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        vsum = _mm256_add_epi64(vsum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+
+    reduce_scalar(column + i, count - i, summary);
+    _mm256_storeu_si256((__m256i *)lanes, vmin);
+    for (k = 0; k < 8; k++)
+    {
+        summary->min = (lanes[k] < summary->min) ? lanes[k] : summary->min;
+    }
+    _mm256_storeu_si256((__m256i *)lanes, vmax);
+    for (k = 0; k < 8; k++)
+    {
+        summary->max = (lanes[k] > summary->max) ? lanes[k] : summary->max;
+    }
+    _mm256_storeu_si256((__m256i *)sums, vsum);
+    summary->sum += sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+__attribute__((target("avx2")))
+static void reduce_time_avx2(const sim_time *column, int count, time_summary *summary)
+{
+    __m256i vmin = _mm256_set1_epi64x(SIM_TIME_MAX);
+    __m256i vmax = _mm256_set1_epi64x(SIM_TIME_MIN);
+    __m256i vsum = _mm256_setzero_si256();
+    __m256i v;
+    sim_time lanes[4];
+    int i, k;
+
+    // Sin min/max de 64 bits: se comparan y se mezclan los valores
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        v = _mm256_loadu_si256((const __m256i *)(column + i));
+        vmin = _mm256_blendv_epi8(vmin, v, _mm256_cmpgt_epi64(vmin, v));
+        vmax = _mm256_blendv_epi8(vmax, v, _mm256_cmpgt_epi64(v, vmax));
+        vsum = _mm256_add_epi64(vsum, v);
+    }
+
+    reduce_time_scalar(column + i, count - i, summary);
+    _mm256_storeu_si256((__m256i *)lanes, vmin);
+    for (k = 0; k < 4; k++)
+    {
+        summary->min = (lanes[k] < summary->min) ? lanes[k] : summary->min;
+    }
+    _mm256_storeu_si256((__m256i *)lanes, vmax);
+    for (k = 0; k < 4; k++)
+    {
+        summary->max = (lanes[k] > summary->max) ? lanes[k] : summary->max;
+    }
+    _mm256_storeu_si256((__m256i *)lanes, vsum);
+    summary->sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Kernels vectoriales sobre columnas de enteros.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Los reportes recorren los procesos una vez para construir columnas
+ * contiguas (un valor por proceso) y luego las reducen con kernels
+ * vectoriales: columnas de enteros de 32 bits (PIDs, CPUs) o de tiempos
+ * de 64 bits (esperas, finalizaciones). La implementacion (AVX2, SSE4.2 o
+ * escalar) se elige en tiempo de ejecucion segun la CPU la primera vez que
+ * se usa un kernel.
+ */
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stddef.h>
+
+#include "sched.h"
+#include "simtime.h"
+
+/** @brief Resultado de reducir una columna */
+typedef struct
+{
+    int min;       /*!< Valor minimo (INT_MAX si la columna esta vacia) */
+    int max;       /*!< Valor maximo (INT_MIN si la columna esta vacia) */
+    long long sum; /*!< Suma de los valores */
+} column_summary;
+
+/** @brief Resultado de reducir una columna de tiempos */
+typedef struct
+{
+    sim_time min; /*!< Valor minimo (SIM_TIME_MAX si la columna esta vacia) */
+    sim_time max; /*!< Valor maximo (SIM_TIME_MIN si la columna esta vacia) */
+    sim_time sum; /*!< Suma de los valores */
+} time_summary;
+
+/**
+ * @brief Construye una columna con un campo entero de cada proceso.
+ * @param processes Vector de procesos
+ * @param offset Posicion del campo en la estructura (offsetof(process, campo))
+ * @param column Salida: un valor por proceso, en el orden del vector
+ * @return Cantidad de valores escritos.
+ */
+int process_column(const process_vector *processes, size_t offset, int *column);
+
+/**
+ * @brief Calcula el minimo, el maximo y la suma de una columna.
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+void column_reduce(const int *column, int count, column_summary *summary);
+
+/**
+ * @brief Construye una columna con un campo sim_time de cada proceso.
+ * @param processes Vector de procesos
+ * @param offset Posicion del campo en la estructura (offsetof(process, campo))
+ * @param column Salida: un valor por proceso, en el orden del vector
+ * @return Cantidad de valores escritos.
+ */
+int time_column(const process_vector *processes, size_t offset, sim_time *column);
+
+/**
+ * @brief Calcula el minimo, el maximo y la suma de una columna de tiempos.
+ * @param column Valores
+ * @param count Cantidad de valores
+ * @param summary Salida: resultado de la reduccion
+ */
+void time_column_reduce(const sim_time *column, int count, time_summary *summary);
+
+/**
+ * @brief Obtiene el nombre de la implementacion en uso.
+ * @return "avx2", "sse4.2" o "scalar".
+ */
+const char *kernels_name(void);
+
+/**
+ * @brief Fuerza una implementacion de los kernels.
+ * @param name "avx2", "sse4.2" o "scalar"
+ * @return 1 si la CPU la soporta y quedo en uso, 0 en caso contrario.
+ */
+int use_kernels(const char *name);
+
+#endif
@@ -267,6 +267,38 @@ list *pop_back(list *l)
     return l;
 }
 
+list *remove_node(list *l, node_iterator it)
+{
+    if (l == 0 || it == 0)
+    {
+        return l;
+    }
+
+    if (it->previous == 0)
+    { /* Primer nodo */
+        l->head = it->next;
+    }
+    else
+    {
+        it->previous->next = it->next;
+    }
+
+    if (it->next == 0)
+    { /* Ultimo nodo */
+        l->tail = it->previous;
+    }
+    else
+    {
+        it->next->previous = it->previous;
+    }
+
+    l->count--;
+
+    free(it);
+
+    return l;
+}
+
 int empty(list *l)
 {
     return ((l == 0) || l->head == 0);
@@ -97,6 +97,14 @@ list *pop_front(list *l);
  */
 list *pop_back(list *l);
 
+/**
+ * @brief Quita un nodo de la lista
+ * @param l Lista de la cual se saca el nodo
+ * @param it Nodo a quitar (se libera)
+ * @return Lista modificada
+ */
+list *remove_node(list *l, node_iterator it);
+
 /**
  * @brief Obtiene el dato que se encuentra al inicio de la lista
  * @param l Lista de la cual se va a obtener el dato
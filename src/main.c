@@ -9,209 +9,379 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sched.h"
-#include "split.h"
 #include "util.h"
 #include "plot.h"
+#include "export.h"
+#include "sweep.h"
+#include "trace.h"
+#include "realtime.h"
+#include "capacity.h"
+#include "import.h"
+#include "input.h"
+#include "repl.h"
+#include "stream.h"
+#include "context.h"
 
-#define MAX_LINE 1024
+/** @brief Cantidad maxima de archivos de exportacion */
+#define MAX_EXPORTS 8
 
 /**
- * @brief Procesa los comandos de entrada
- * @param processes Lista de procesos
- * @param queues Colas de prioridad
- * @param nqueues Numero de colas de prioridad
- * @return Numero de colas configuradas
+ * @brief Imprime las opciones de linea de comandos
+ * @param program Nombre del programa
  */
-int process_input(list *processes, priority_queue **queues, int *nqueues);
+void usage(char *program);
 
-/**
- * @brief Configura las colas de prioridad segun los comandos DEFINE
- * @param queues Colas de prioridad
- * @param queue_num Numero de cola (1-based)
- * @param strategy_str Estrategia como string ("RR" o "FIFO")
- * @param quantum Quantum para la cola
- */
-void configure_queue(priority_queue *queues, int queue_num, char *strategy_str, int quantum);
-
-int main()
+int main(int argc, char *argv[])
 {
-    list *processes = create_list();
-    priority_queue *queues = NULL;
-    int nqueues = 0;
+    sched_context ctx;
+    int plot = 1;
+    int plotting = 0;
+    plot_options plot_opts = {PLOT_FULL, 0, 0, 0, NULL};
+    export_format export_formats[MAX_EXPORTS];
+    char *export_paths[MAX_EXPORTS];
+    int nexports = 0;
+    char *sep;
+    char *trace_out = NULL;
+    char *trace_in = NULL;
+    char *configs = NULL;
+    char *address = "scheduler.sock";
+    int workers = 2;
+    int worker = 0;
+    int ntasks;
+    sim_time capacity_wait = -1;
+    int capacity_queue = 0;
+    sim_time measure = -1;
+    char *import_path = NULL;
+    long import_unit = 1;
+    int repl = 0;
+    char *daemon_address = NULL;
+    char *bounded_path = NULL;
+    char *slices_in = NULL;
+    process_stream *stream = NULL;
+    int ret;
+
+    init_sched_context(&ctx, NULL, NULL);
+
+    for (int i = 1; i < argc; i++) {
+        if (equals(argv[i], "--no-plot")) {
+            plot = 0;
+        } else if (equals(argv[i], "--quiet")) {
+            ctx.opts.quiet = 1;
+        } else if (equals(argv[i], "--plot-window") && i + 1 < argc) {
+            // --plot-window from:to
+            if (sscanf(argv[++i], "%" SCNsim ":%" SCNsim, &plot_opts.from, &plot_opts.to) != 2 ||
+                plot_opts.to <= plot_opts.from) {
+                printf("Error: ventana invalida: %s (use desde:hasta)\n", argv[i]);
+                return 1;
+            }
+            plot_opts.window = 1;
+        } else if (equals(argv[i], "--plot-overview")) {
+            plot_opts.mode = PLOT_OVERVIEW;
+        } else if (equals(argv[i], "--seq-log") && i + 1 < argc) {
+            ctx.opts.seq_log_path = argv[++i];
+        } else if (equals(argv[i], "--seq-mem-cap") && i + 1 < argc) {
+            ctx.opts.seq_mem_cap = strtoul(argv[++i], NULL, 10);
+        } else if (equals(argv[i], "--stats-out") && i + 1 < argc) {
+            ctx.opts.stats_path = argv[++i];
+        } else if (equals(argv[i], "--checkpoint") && i + 1 < argc) {
+            ctx.opts.checkpoint_path = argv[++i];
+        } else if (equals(argv[i], "--checkpoint-every") && i + 1 < argc) {
+            ctx.opts.checkpoint_every = strtol(argv[++i], NULL, 10);
+            if (ctx.opts.checkpoint_every <= 0) {
+                printf("Error: intervalo de puntos de control invalido: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--resume") && i + 1 < argc) {
+            ctx.opts.resume_path = argv[++i];
+        } else if (equals(argv[i], "--export") && i + 1 < argc) {
+            // --export formato:archivo
+            sep = strchr(argv[++i], ':');
+            if (sep == NULL || nexports == MAX_EXPORTS) {
+                printf("Error: exportacion invalida: %s (use formato:archivo)\n", argv[i]);
+                return 1;
+            }
+            *sep = '\0';
+            if (!parse_export_format(argv[i], &export_formats[nexports])) {
+                printf("Error: formato de exportacion no soportado: %s (use csv, jsonl o col)\n", argv[i]);
+                return 1;
+            }
+            export_paths[nexports++] = sep + 1;
+        } else if (equals(argv[i], "--capacity") && i + 1 < argc) {
+            // --capacity espera[:cola]
+            if (sscanf(argv[++i], "%" SCNsim ":%d", &capacity_wait, &capacity_queue) < 1 ||
+                capacity_wait < 0 || capacity_queue < 0) {
+                printf("Error: SLO de capacidad invalido: %s (use espera[:cola])\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--warmup") && i + 1 < argc) {
+            ctx.opts.warmup = strtoll(argv[++i], NULL, 10);
+            if (ctx.opts.warmup < 0) {
+                printf("Error: calentamiento invalido: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--measure") && i + 1 < argc) {
+            measure = strtoll(argv[++i], NULL, 10);
+            if (measure <= 0) {
+                printf("Error: ventana de medicion invalida: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--sample") && i + 1 < argc) {
+            // --sample k:ancho
+            if (sscanf(argv[++i], "%d:%" SCNsim, &ctx.opts.sample_every, &ctx.opts.sample_window) != 2 ||
+                ctx.opts.sample_every < 1 || ctx.opts.sample_window < 1) {
+                printf("Error: muestreo invalido: %s (use k:ancho)\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--ci") && i + 1 < argc) {
+            // --ci semiancho[:lote]
+            if (sscanf(argv[++i], "%lf:%ld", &ctx.opts.ci_width, &ctx.opts.batch_size) < 1 ||
+                ctx.opts.ci_width <= 0 || ctx.opts.batch_size < 1) {
+                printf("Error: intervalo de confianza invalido: %s (use semiancho[:lote])\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--import-sched") && i + 1 < argc) {
+            import_path = argv[++i];
+        } else if (equals(argv[i], "--import-unit") && i + 1 < argc) {
+            import_unit = strtol(argv[++i], NULL, 10);
+            if (import_unit < 1) {
+                printf("Error: unidad de importacion invalida: %s (microsegundos)\n", argv[i]);
+                return 1;
+            }
+        } else if (equals(argv[i], "--repl")) {
+            repl = 1;
+        } else if (equals(argv[i], "--daemon") && i + 1 < argc) {
+            repl = 1;
+            daemon_address = argv[++i];
+        } else if (equals(argv[i], "--bounded") && i + 1 < argc) {
+            bounded_path = argv[++i];
+        } else if (equals(argv[i], "--plot-slices") && i + 1 < argc) {
+            slices_in = argv[++i];
+        } else if (equals(argv[i], "--threads") && i + 1 < argc) {
+            ctx.opts.threads = atoi(argv[++i]);
+        } else if (equals(argv[i], "--write-trace") && i + 1 < argc) {
+            trace_out = argv[++i];
+        } else if (equals(argv[i], "--coordinator") && i + 1 < argc) {
+            configs = argv[++i];
+        } else if (equals(argv[i], "--trace") && i + 1 < argc) {
+            trace_in = argv[++i];
+        } else if (equals(argv[i], "--socket") && i + 1 < argc) {
+            address = argv[++i];
+        } else if (equals(argv[i], "--workers") && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (equals(argv[i], "--worker")) {
+            worker = 1;
+        } else if (equals(argv[i], "--help") || equals(argv[i], "-h")) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            printf("Opcion desconocida: %s\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    // La ventana de medicion comienza al terminar el calentamiento
+    if (measure > 0) {
+        ctx.opts.measure_end = ctx.opts.warmup + measure;
+    }
+    
+    // Barrido de parametros: no se lee la entrada estandar
+    if (worker) {
+        return run_worker(address);
+    }
+    if (configs != NULL) {
+        if (trace_in == NULL) {
+            printf("Error: --coordinator requiere --trace archivo\n");
+            return 1;
+        }
+        return run_coordinator(configs, trace_in, address, workers, argv[0], report_output(&ctx.opts));
+    }
     
+    // Diagrama de un archivo de slices de --bounded: no se lee la entrada estandar
+    if (slices_in != NULL) {
+        if (read_slices(slices_in, &plot_opts, ctx.processes) < 0) {
+            printf("Error: no se pudo leer el archivo de slices %s\n", slices_in);
+            return 1;
+        }
+        plotting = create_plot_async("gantt.plt", ctx.processes, &plot_opts);
+        destroy_sched_context(&ctx);
+        if (plotting && wait_plots() == 0) {
+            printf("Diagrama de Gantt generado: gantt.png\n");
+        } else {
+            printf("No se pudo generar el diagrama de Gantt\n");
+        }
+        destroy_names();
+        return 0;
+    }
+
     printf("=== SIMULADOR DE PLANIFICACION DE PROCESOS ===\n");
     printf("Leyendo comandos desde entrada estandar...\n");
-    printf("Comandos disponibles: DEFINE, PROCESS, START\n\n");
+    printf("Comandos disponibles: DEFINE, PROCESS, PERIODIC, START\n\n");
     
-    // Procesar entrada
-    nqueues = process_input(processes, &queues, &nqueues);
+    // Procesar entrada (en el modo de memoria acotada, solo hasta el primer proceso)
+    if (bounded_path != NULL) {
+        stream = create_process_stream(stdin, &ctx.opts, bounded_path);
+        if (stream == NULL) {
+            printf("Error: no se pudo crear el archivo de slices %s\n", bounded_path);
+            return 1;
+        }
+        ctx.queues = stream->in.queues;
+        ctx.nqueues = stream->in.nqueues;
+        ctx.opts.stream = stream;
+    } else {
+        load_sched_context(&ctx, stdin);
+    }
     
-    if (nqueues == 0) {
+    if (ctx.nqueues == 0) {
         printf("Error: No se definieron colas de prioridad\n");
         return 1;
     }
     
-    if (processes->count == 0) {
+    // Rafagas de una traza real de Linux, ademas de los PROCESS de la entrada
+    if (import_path != NULL &&
+        import_sched_trace(import_path, import_unit, ctx.processes, ctx.nqueues, ctx.opts.ncpus,
+                           report_output(&ctx.opts)) < 0) {
+        printf("Error: no se pudo leer la traza %s\n", import_path);
+        return 1;
+    }
+    
+    if (ctx.processes->count == 0 && (stream == NULL || peek_process(stream) == NULL)) {
         printf("Error: No se definieron procesos\n");
         return 1;
     }
     
-    // Ejecutar simulacion (prepare se llama dentro de schedule)
-    schedule(processes, queues, nqueues);
+    // El modo de memoria acotada no conserva los procesos: nada que los necesite al final
+    if (stream != NULL && (ctx.opts.ncpus > 1 || repl || capacity_wait >= 0 || trace_out != NULL ||
+                           import_path != NULL || nexports > 0 || ctx.opts.checkpoint_path != NULL ||
+                           ctx.opts.resume_path != NULL || ctx.opts.seq_log_path != NULL ||
+                           ctx.opts.measure_end >= 0 || ctx.opts.sample_every > 1)) {
+        printf("Error: --bounded simula una CPU, sin --repl, --daemon, --capacity, --write-trace, "
+               "--import-sched, --export, --checkpoint, --resume, --seq-log, --measure ni --sample\n");
+        return 1;
+    }
     
-    if (create_plot("gantt.plt", processes)) {
-        printf("Diagrama de Gantt generado: gantt.png\n");
-    } else {
-        printf("No se pudo generar el diagrama de Gantt\n");
+    // Sin diagrama (ni sesion, archivo de slices o punto de control) nadie lee las esperas
+    ctx.opts.wait_slices = plot || repl || stream != NULL || ctx.opts.checkpoint_path != NULL;
+    
+    // Trabajos de las tareas periodicas hasta el horizonte
+    ntasks = plan_periodic_jobs(ctx.processes, ctx.opts.horizon);
+    if (ntasks < 0) {
+        printf("Error: el hiperperiodo de las tareas periodicas es demasiado grande (use DEFINE horizon)\n");
+        return 1;
     }
     
-    // Limpiar memoria
-    clear_list(processes, 1);
-    destroy_list(processes, 0);
+    if (trace_out != NULL && ntasks > 0) {
+        printf("Error: la traza no guarda las tareas periodicas\n");
+    } else if (trace_out != NULL) {
+        if (write_trace(trace_out, ctx.processes)) {
+            printf("Traza guardada en %s\n", trace_out);
+        } else {
+            printf("Error: no se pudo guardar la traza en %s\n", trace_out);
+        }
+    }
     
-    for (int i = 0; i < nqueues; i++) {
-        clear_list(queues[i].ready, 0);
-        clear_list(queues[i].arrival, 0);
-        clear_list(queues[i].finished, 0);
-        destroy_list(queues[i].ready, 0);
-        destroy_list(queues[i].arrival, 0);
-        destroy_list(queues[i].finished, 0);
+    // Sesion interactiva: los procesos quedan cargados entre simulaciones
+    if (repl) {
+        ret = run_repl(&ctx, &plot_opts, daemon_address);
+        destroy_sched_context(&ctx);
+        destroy_names();
+        return ret;
     }
-    free(queues);
     
-    return 0;
-}
-
-int process_input(list *processes, priority_queue **queues, int *nqueues)
-{
-    char line[MAX_LINE];
-    split_list *parts;
-    int process_counter = 1;
-    int queues_defined = 0;
-    
-    while (fgets(line, MAX_LINE, stdin)) {
-        // Remover salto de linea
-        line[strcspn(line, "\n")] = '\0';
-        
-        // Ignorar lineas vacias y comentarios
-        if (strlen(line) == 0 || line[0] == '#') {
-            continue;
+    // Planificacion de capacidad: muchas simulaciones, sin reporte, exportacion ni diagrama
+    if (capacity_wait >= 0) {
+        if (capacity_queue > ctx.nqueues) {
+            printf("Error: numero de cola invalido: %d\n", capacity_queue);
+            return 1;
         }
-        
-        parts = split(line, NULL);
-        
-        if (parts->count == 0) {
-            free_split_list(parts);
-            continue;
+        if (!plan_capacity(ctx.processes, ctx.queues, ctx.nqueues, &ctx.opts, capacity_wait, capacity_queue - 1)) {
+            return 1;
         }
-        
-        // Convertir comando a minusculas para comparacion
-        lcase(parts->parts[0]);
-        
-        if (equals(parts->parts[0], "define")) {
-            if (parts->count < 3) {
-                printf("Error: comando DEFINE incompleto\n");
-                free_split_list(parts);
-                continue;
-            }
-            
-            lcase(parts->parts[1]);
-            
-            if (equals(parts->parts[1], "queues")) {
-                // DEFINE queues n
-                *nqueues = atoi(parts->parts[2]);
-                *queues = create_queues(*nqueues);
-                queues_defined = 1;
-                printf("Definidas %d colas de prioridad\n", *nqueues);
-            }
-            else if (equals(parts->parts[1], "scheduling")) {
-                // DEFINE scheduling queue_num strategy
-                if (parts->count < 4 || !queues_defined) {
-                    printf("Error: debe definir las colas antes de configurar estrategias\n");
-                    free_split_list(parts);
-                    continue;
-                }
-                
-                int queue_num = atoi(parts->parts[2]);
-                char *strategy_str = parts->parts[3];
-                lcase(strategy_str);
-                
-                if (queue_num < 1 || queue_num > *nqueues) {
-                    printf("Error: numero de cola invalido: %d\n", queue_num);
-                    free_split_list(parts);
-                    continue;
-                }
-                
-                if (equals(strategy_str, "rr")) {
-                    (*queues)[queue_num-1].strategy = RR;
-                    printf("Cola %d configurada con estrategia RR\n", queue_num);
-                } else if (equals(strategy_str, "fifo")) {
-                    (*queues)[queue_num-1].strategy = FIFO;
-                    printf("Cola %d configurada con estrategia FIFO\n", queue_num);
-                } else {
-                    printf("Error: estrategia no soportada: %s (use RR o FIFO)\n", strategy_str);
-                }
-            }
-            else if (equals(parts->parts[1], "quantum")) {
-                // DEFINE quantum queue_num quantum_value
-                if (parts->count < 4 || !queues_defined) {
-                    printf("Error: debe definir las colas antes de configurar quantum\n");
-                    free_split_list(parts);
-                    continue;
-                }
-                
-                int queue_num = atoi(parts->parts[2]);
-                int quantum_value = atoi(parts->parts[3]);
-                
-                if (queue_num < 1 || queue_num > *nqueues) {
-                    printf("Error: numero de cola invalido: %d\n", queue_num);
-                    free_split_list(parts);
-                    continue;
-                }
-                
-                (*queues)[queue_num-1].quantum = quantum_value;
-                printf("Cola %d configurada con quantum %d\n", queue_num, quantum_value);
-            }
+        nexports = 0;
+        plot = 0;
+    }
+    // Ejecutar simulacion (prepare se llama dentro de schedule)
+    else if (!schedule(ctx.processes, ctx.queues, ctx.nqueues, &ctx.opts)) {
+        return 1;
+    }
+    
+    // Modo de memoria acotada: el diagrama se genera despues desde el archivo de slices
+    if (stream != NULL) {
+        if (!destroy_process_stream(stream, ctx.queues, ctx.nqueues)) {
+            printf("Error: no se pudieron guardar las slices en %s\n", bounded_path);
         }
-        else if (equals(parts->parts[0], "process")) {
-            // PROCESS name arrival_time execution_time priority
-            if (parts->count < 5) {
-                printf("Error: comando PROCESS incompleto\n");
-                free_split_list(parts);
-                continue;
-            }
-            
-            char *name = parts->parts[1];
-            int arrival_time = atoi(parts->parts[2]);
-            int execution_time = atoi(parts->parts[3]);
-            int priority = atoi(parts->parts[4]);
-            
-            if (!queues_defined || priority < 1 || priority > *nqueues) {
-                printf("Error: prioridad invalida %d (debe estar entre 1 y %d)\n", priority, *nqueues);
-                free_split_list(parts);
-                continue;
-            }
-            
-            process *p = create_process(name, arrival_time, execution_time);
-            p->pid = process_counter++;
-            p->priority = priority - 1; // Convertir a 0-based
-            
-            push_back(processes, p);
-            
-            printf("Proceso agregado: %s (llegada:%d, ejecucion:%d, prioridad:%d)\n", 
-                   name, arrival_time, execution_time, priority);
+        if (plot) {
+            printf("Diagrama de Gantt: %s --plot-slices %s [--plot-window desde:hasta]\n",
+                   argv[0], bounded_path);
+            plot = 0;
         }
-        else if (equals(parts->parts[0], "start")) {
-            printf("Iniciando simulacion...\n\n");
-            free_split_list(parts);
-            break;
+    }
+    
+    // Exportar los resultados en formatos legibles por maquina
+    for (int i = 0; i < nexports; i++) {
+        if (export_results(export_paths[i], export_formats[i], ctx.processes, ctx.queues, ctx.nqueues,
+                           &ctx.opts)) {
+            printf("Resultados exportados: %s\n", export_paths[i]);
+        } else {
+            printf("Error: no se pudieron exportar los resultados a %s\n", export_paths[i]);
         }
-        else {
-            printf("Comando desconocido: %s\n", parts->parts[0]);
+    }
+    
+    // El diagrama se genera en segundo plano a partir de una copia de las slices
+    if (plot) {
+        plotting = create_plot_async("gantt.plt", ctx.processes, &plot_opts);
+    }
+    
+    // Limpiar memoria
+    destroy_sched_context(&ctx);
+    
+    // Esperar las graficas pendientes solo al salir
+    if (plot) {
+        if (plotting && wait_plots() == 0) {
+            printf("Diagrama de Gantt generado: gantt.png\n");
+        } else {
+            printf("No se pudo generar el diagrama de Gantt\n");
         }
-        
-        free_split_list(parts);
     }
+
+    // Los nombres se liberan despues de las graficas, que los resuelven al escribir
+    destroy_names();
     
-    return *nqueues;
-}
\ No newline at end of file
+    return 0;
+}
+
+void usage(char *program)
+{
+    printf("Uso: %s [opciones] < archivo\n", program);
+    printf("Opciones:\n");
+    printf("  --no-plot                  No generar el diagrama de Gantt\n");
+    printf("  --quiet                    No imprimir los mensajes de la simulacion, solo los resultados\n");
+    printf("  --plot-window desde:hasta  Graficar solo el intervalo [desde, hasta)\n");
+    printf("  --plot-overview            Graficar la densidad de CPU/espera por columna\n");
+    printf("  --seq-log archivo          Guardar la secuencia de ejecucion en un archivo\n");
+    printf("  --seq-mem-cap bytes        Memoria maxima de la secuencia antes de volcarla a disco\n");
+    printf("  --export formato:archivo   Exportar resultados (csv, jsonl o col); se puede repetir\n");
+    printf("  --stats-out archivo        Guardar los histogramas de latencia para combinarlos\n");
+    printf("  --checkpoint archivo       Guardar puntos de control periodicos de la simulacion\n");
+    printf("  --checkpoint-every N       Asignaciones de CPU entre puntos de control (%d)\n", CHECKPOINT_DEFAULT_EVERY);
+    printf("  --resume archivo           Continuar la simulacion desde un punto de control\n");
+    printf("  --threads N                Hilos para simular las CPUs (uno por nucleo)\n");
+    printf("  --warmup T                 Simular sin medir los procesos que llegan antes de T\n");
+    printf("  --measure T                Medir las llegadas de T unidades tras el calentamiento\n");
+    printf("  --sample k:ancho           Simular solo 1 de cada k ventanas de llegada\n");
+    printf("  --ci semiancho[:lote]      Parar cuando el IC de la espera media sea < semiancho * media (lote %d)\n", BATCH_DEFAULT_SIZE);
+    printf("  --capacity espera[:cola]   Buscar la tasa de llegadas maxima con p%d de la espera <= espera\n", CAPACITY_PERCENTILE);
+    printf("  --import-sched archivo     Importar rafagas de perf script o ftrace (sched_switch)\n");
+    printf("  --import-unit us           Microsegundos por unidad de tiempo al importar (1)\n");
+    printf("  --repl                     Tras START, seguir leyendo comandos (RUN, STATS, PLOT...)\n");
+    printf("  --bounded archivo          Memoria acotada: leer los procesos al llegar, slices al archivo\n");
+    printf("  --plot-slices archivo      Graficar el archivo de slices de --bounded\n");
+    printf("  --daemon direccion         Como --repl, pero atendiendo un socket Unix\n");
+    printf("  --write-trace archivo      Guardar los procesos como traza binaria\n");
+    printf("  --coordinator archivo      Barrido: repartir las configuraciones del archivo\n");
+    printf("  --trace archivo            Barrido: traza binaria a simular\n");
+    printf("  --socket direccion         Barrido: socket Unix, o tcp:puerto (scheduler.sock)\n");
+    printf("  --workers N                Barrido: trabajadores locales a lanzar (2)\n");
+    printf("  --worker                   Barrido: ejecutar como trabajador\n");
+    printf("  -h, --help                 Mostrar esta ayuda\n");
+}
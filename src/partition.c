@@ -0,0 +1,854 @@
+/**
+ * @file
+ * @brief Simulacion paralela de varias CPUs.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "partition.h"
+#include "kernels.h"
+#include "realtime.h"
+#include "seqlog.h"
+#include "stats.h"
+
+/** @brief Capacidad de un buzon de migraciones (potencia de dos) */
+#define MAILBOX_SIZE 8
+
+/** @brief Migracion de un proceso listo a la CPU vecina */
+typedef struct
+{
+    process *p;   /*!< Proceso que migra */
+    int queue;         /*!< Cola de prioridad del proceso */
+    sim_time ready_at; /*!< Tiempo desde el cual esta listo en la CPU destino */
+    long window;       /*!< Ventana en la que se envio */
+} migration;
+
+/** @brief Cola doble de migraciones (guardadas por valor) */
+DEFINE_DEQUE(migration_deque, migration)
+
+/**
+ * @brief Buzon de un solo productor y un solo consumidor, sin bloqueos.
+ *
+ * El productor es la CPU i y el consumidor la CPU (i + 1) % N; cada una
+ * pertenece a un solo hilo.
+ */
+typedef struct
+{
+    migration slots[MAILBOX_SIZE]; /*!< Mensajes */
+    unsigned head;                 /*!< Siguiente mensaje a leer (consumidor) */
+    unsigned tail;                 /*!< Siguiente posicion a escribir (productor) */
+} mailbox;
+
+/** @brief Particion de la simulacion: una CPU con sus procesos y colas */
+typedef struct
+{
+    int cpu;                  /*!< CPU (0-based) */
+    process_vector processes; /*!< Procesos en la CPU */
+    priority_queue *queues;   /*!< Colas propias de la particion */
+    int nqueues;              /*!< Cantidad de colas */
+    sched_options opts;       /*!< Opciones de la particion */
+    simulation sim;           /*!< Estado de la simulacion */
+    int ok;                   /*!< 1 = la particion se simulo */
+    int assigned;             /*!< Procesos asignados inicialmente */
+    long migrated_in;         /*!< Procesos recibidos de la CPU anterior */
+    long migrated_out;        /*!< Procesos enviados a la CPU siguiente */
+    migration_deque incoming; /*!< Migraciones recibidas, ordenadas por ready_at */
+    sim_time next_event[2];   /*!< Siguiente evento publicado (por paridad de ventana) */
+    int ready[2];             /*!< Procesos listos publicados (por paridad de ventana) */
+    int finished[2];          /*!< Procesos finalizados publicados (por paridad de ventana) */
+} partition;
+
+/** @brief Estado compartido por los hilos de la simulacion */
+typedef struct
+{
+    partition *parts;          /*!< Particiones */
+    int count;                 /*!< Cantidad de particiones */
+    int next;                  /*!< Siguiente particion sin asignar (sin migracion) */
+    int nthreads;              /*!< Cantidad de hilos */
+    int total;                 /*!< Procesos a simular */
+    sim_delta lookahead;       /*!< Longitud de las ventanas (quantum minimo) */
+    sim_time first_window;     /*!< Inicio de la primera ventana */
+    mailbox *mailboxes;        /*!< Buzon de la CPU i hacia la CPU i + 1 */
+    pthread_barrier_t barrier; /*!< Sincronizacion al final de cada ventana */
+} partition_pool;
+
+/** @brief Argumento de un hilo con ventanas */
+typedef struct
+{
+    partition_pool *pool; /*!< Estado compartido */
+    int id;               /*!< Hilo: simula las CPUs id, id + nthreads, ... */
+} window_worker_arg;
+
+/**
+ * @brief Simula una particion completa (sin migracion).
+ * @param part Particion
+ */
+static void run_partition(partition *part);
+
+/**
+ * @brief Hilo que toma particiones del conjunto hasta agotarlas.
+ * @param arg Conjunto de particiones (partition_pool *)
+ * @return NULL
+ */
+static void *partition_worker(void *arg);
+
+/**
+ * @brief Hilo que simula sus CPUs ventana por ventana, con migracion.
+ *
+ * En cada ventana [inicio, fin) cada CPU ejecuta las asignaciones que
+ * comienzan antes de fin; luego, si tiene al menos dos procesos listos,
+ * envia el ultimo de su cola de menor prioridad a la CPU siguiente. Tras la
+ * barrera cada hilo calcula, con los valores publicados por todas las CPUs,
+ * si la simulacion termino y donde empieza la siguiente ventana (saltando
+ * los intervalos sin eventos), y recibe las migraciones de la ventana.
+ * @param arg Argumento del hilo (window_worker_arg *)
+ * @return NULL
+ */
+static void *window_worker(void *arg);
+
+/**
+ * @brief Ejecuta una CPU hasta el fin de una ventana, admitiendo las migraciones pendientes.
+ * @param part Particion
+ * @param ncpus Cantidad de CPUs
+ * @param end Fin de la ventana (exclusivo)
+ */
+static void run_window(partition *part, int ncpus, sim_time end);
+
+/**
+ * @brief Envia un proceso listo a la CPU siguiente si esta mas cargada que ella.
+ *
+ * La carga de la CPU siguiente es la publicada en la ventana anterior, que
+ * no cambia hasta la proxima barrera.
+ * @param part Particion
+ * @param box Buzon hacia la CPU siguiente
+ * @param ncpus Cantidad de CPUs
+ * @param neighbour_ready Procesos listos de la CPU siguiente en la ventana anterior
+ * @param window Numero de ventana
+ * @param end Fin de la ventana
+ * @return Tiempo desde el cual el proceso esta listo en la CPU destino, o SIM_TIME_MAX.
+ */
+static sim_time send_migration(partition *part, mailbox *box, int ncpus, int neighbour_ready,
+                               long window, sim_time end);
+
+/**
+ * @brief Recibe las migraciones enviadas hasta una ventana.
+ * @param part Particion destino
+ * @param box Buzon desde la CPU anterior
+ * @param window Numero de ventana
+ */
+static void receive_migrations(partition *part, mailbox *box, long window);
+
+/**
+ * @brief Publica el siguiente evento y los procesos finalizados de una CPU.
+ * @param part Particion
+ * @param parity Paridad de la ventana
+ * @param sent Tiempo de la migracion enviada, o SIM_TIME_MAX
+ */
+static void publish(partition *part, int parity, sim_time sent);
+
+/**
+ * @brief Compara dos migraciones por tiempo (para migration_deque_insert_ordered()).
+ * @param a Migracion A
+ * @param b Migracion B
+ * @return Positivo si A esta lista antes que B, negativo si despues, 0 si a la vez.
+ */
+static int compare_ready_at(const migration *a, const migration *b);
+
+/**
+ * @brief Agrega una migracion al buzon (solo el productor).
+ * @param box Buzon
+ * @param m Migracion
+ */
+static void mailbox_push(mailbox *box, const migration *m);
+
+/**
+ * @brief Obtiene la siguiente migracion del buzon sin quitarla (solo el consumidor).
+ * @param box Buzon
+ * @return Migracion, o NULL si el buzon esta vacio.
+ */
+static migration *mailbox_peek(mailbox *box);
+
+/**
+ * @brief Quita la migracion obtenida con mailbox_peek() (solo el consumidor).
+ * @param box Buzon
+ */
+static void mailbox_pop(mailbox *box);
+
+/**
+ * @brief Copia el contenido de un archivo a una salida.
+ * @param file Archivo
+ * @param out Salida
+ */
+static void copy_output(FILE *file, FILE *out);
+
+/**
+ * @brief Agrega un registro de una particion al registro combinado.
+ * @param r Registro
+ * @param arg Registro combinado (seqlog *)
+ */
+static void merge_record(const seq_record *r, void *arg);
+
+/**
+ * @brief Suma el tiempo de CPU de un registro.
+ * @param r Registro
+ * @param arg Acumulador (long long *)
+ */
+static void add_busy_time(const seq_record *r, void *arg);
+
+/**
+ * @brief Imprime los resultados combinados de todas las particiones.
+ * @param processes Vector de procesos
+ * @param parts Particiones
+ * @param ncpus Cantidad de particiones
+ * @param nqueues Cantidad de colas
+ * @param opts Opciones de la simulacion
+ */
+static void report_partitions(process_vector *processes, partition *parts, int ncpus, int nqueues,
+                              const sched_options *opts);
+
+int schedule_partitions(process_vector *processes, priority_queue *queues, int nqueues,
+                        const sched_options *opts)
+{
+    partition *parts;
+    partition_pool pool;
+    window_worker_arg *args;
+    pthread_t *threads;
+    process_vector_iterator it;
+    process *p;
+    FILE *out = (opts->out != NULL) ? opts->out : stdout;
+    FILE *report = report_output(opts);
+    int ncpus = opts->ncpus;
+    int nthreads;
+    int started;
+    int ok = 1;
+    int i, q;
+
+    if (opts->checkpoint_path != NULL || opts->resume_path != NULL)
+    {
+        fprintf(report, "Error: los puntos de control no estan soportados con varias CPUs\n");
+        return 0;
+    }
+    // Las particiones miden todos sus procesos: no hay ventana de medicion ni medias por lotes
+    if (opts->warmup > 0 || opts->measure_end >= 0 || opts->sample_every > 1 || opts->ci_width > 0)
+    {
+        fprintf(report, "Error: --warmup, --measure, --sample y --ci no estan soportados con "
+                        "varias CPUs\n");
+        return 0;
+    }
+
+    nthreads = (opts->threads > 0) ? opts->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (nthreads < 1) ? 1 : (nthreads > ncpus) ? ncpus : nthreads;
+
+    if (!opts->quiet)
+    {
+        fprintf(out, "=== INICIANDO SIMULACION ===\n");
+        fprintf(out, "Procesos a simular: %d\n", processes->count);
+        fprintf(out, "Colas de prioridad: %d\n", nqueues);
+        fprintf(out, "CPUs: %d (hilos: %d)\n", ncpus, nthreads);
+    }
+
+    // Una particion por CPU, con copias de la configuracion de las colas
+    memset(&pool, 0, sizeof(pool));
+    pool.lookahead = SIM_DELTA_MAX;
+    for (q = 0; q < nqueues; q++)
+    {
+        if (queues[q].strategy == RR && queues[q].quantum > 0 && queues[q].quantum < pool.lookahead)
+        {
+            pool.lookahead = queues[q].quantum;
+        }
+    }
+    pool.lookahead = (pool.lookahead == SIM_DELTA_MAX) ? 1 : pool.lookahead;
+    pool.first_window = SIM_TIME_MAX;
+
+    parts = (partition *)calloc(ncpus, sizeof(partition));
+    for (i = 0; i < ncpus; i++)
+    {
+        parts[i].cpu = i;
+        init_process_vector(&parts[i].processes);
+        init_migration_deque(&parts[i].incoming);
+        parts[i].nqueues = nqueues;
+        parts[i].queues = create_queues(nqueues);
+        for (q = 0; q < nqueues; q++)
+        {
+            parts[i].queues[q].strategy = queues[q].strategy;
+            parts[i].queues[q].quantum = queues[q].quantum;
+        }
+        init_sched_options(&parts[i].opts);
+        parts[i].opts.seq_mem_cap = opts->seq_mem_cap;
+        parts[i].opts.quiet = opts->quiet;
+        parts[i].opts.wait_slices = opts->wait_slices;
+        parts[i].opts.specialize = opts->specialize;
+    }
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (p->cpu < 0 || p->cpu >= ncpus)
+        {
+            fprintf(report, "Error: proceso %s tiene CPU invalida %d\n", process_name(p),
+                    p->cpu + 1);
+            continue;
+        }
+        process_vector_push_back(&parts[p->cpu].processes, p);
+        parts[p->cpu].assigned++;
+        pool.total++;
+        if (p->arrival_time < pool.first_window)
+        {
+            pool.first_window = p->arrival_time;
+        }
+    }
+    if (pool.first_window == SIM_TIME_MAX)
+    {
+        pool.first_window = 0;
+    }
+    pool.first_window -= pool.first_window % pool.lookahead;
+
+    // Los mensajes de cada particion se guardan aparte y se imprimen en orden de CPU
+    for (i = 0; i < ncpus && !opts->quiet; i++)
+    {
+        parts[i].opts.out = tmpfile();
+        if (parts[i].opts.out == NULL)
+        {
+            fprintf(report, "Error: no se pudo crear la salida de la CPU %d\n", i + 1);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        pool.parts = parts;
+        pool.count = ncpus;
+        pool.nthreads = nthreads;
+        threads = (pthread_t *)malloc(sizeof(pthread_t) * nthreads);
+
+        if (opts->migration)
+        {
+            // Con migracion cada hilo simula siempre las mismas CPUs
+            if (!opts->quiet)
+            {
+                fprintf(out, "Migracion: ventanas de %d unidades de tiempo\n", pool.lookahead);
+            }
+            pool.mailboxes = (mailbox *)calloc(ncpus, sizeof(mailbox));
+            args = (window_worker_arg *)malloc(sizeof(window_worker_arg) * nthreads);
+            for (i = 0; i < ncpus; i++)
+            {
+                // Una CPU sin llegadas tempranas debe poder recibir migraciones
+                parts[i].opts.start_time = pool.first_window;
+                parts[i].ok = init_simulation(&parts[i].sim, &parts[i].processes, parts[i].queues,
+                                              nqueues, &parts[i].opts);
+                ok = ok && parts[i].ok;
+            }
+            if (ok)
+            {
+                pthread_barrier_init(&pool.barrier, NULL, nthreads);
+                for (started = 0; started < nthreads; started++)
+                {
+                    args[started].pool = &pool;
+                    args[started].id = started;
+                    if (pthread_create(&threads[started], NULL, window_worker, &args[started]) != 0)
+                    {
+                        break;
+                    }
+                }
+                if (started < nthreads)
+                {
+                    // La barrera espera a todos los hilos: no se puede continuar
+                    fprintf(report, "Error: no se pudieron crear los hilos de simulacion\n");
+                    exit(EXIT_FAILURE);
+                }
+                for (i = 0; i < started; i++)
+                {
+                    pthread_join(threads[i], NULL);
+                }
+                pthread_barrier_destroy(&pool.barrier);
+            }
+            free(args);
+            free(pool.mailboxes);
+        }
+        else
+        {
+            for (started = 0; started < nthreads; started++)
+            {
+                if (pthread_create(&threads[started], NULL, partition_worker, &pool) != 0)
+                {
+                    break;
+                }
+            }
+            // Sin hilos adicionales: simular en este hilo
+            if (started == 0)
+            {
+                partition_worker(&pool);
+            }
+            for (i = 0; i < started; i++)
+            {
+                pthread_join(threads[i], NULL);
+            }
+        }
+        free(threads);
+
+        for (i = 0; i < ncpus; i++)
+        {
+            if (!opts->quiet)
+            {
+                fprintf(out, "\n--- CPU %d ---\n", i + 1);
+                copy_output(parts[i].opts.out, out);
+            }
+            ok = ok && parts[i].ok;
+        }
+        if (ok)
+        {
+            report_partitions(processes, parts, ncpus, nqueues, opts);
+        }
+    }
+
+    for (i = 0; i < ncpus; i++)
+    {
+        if (parts[i].ok)
+        {
+            destroy_simulation(&parts[i].sim);
+        }
+        if (parts[i].opts.out != NULL)
+        {
+            fclose(parts[i].opts.out);
+        }
+        destroy_queues(parts[i].queues, nqueues);
+        free_process_vector(&parts[i].processes);
+        free_migration_deque(&parts[i].incoming);
+    }
+    free(parts);
+
+    return ok;
+}
+
+static void run_partition(partition *part)
+{
+    part->ok = init_simulation(&part->sim, &part->processes, part->queues,
+                               part->nqueues, &part->opts);
+    if (!part->ok)
+    {
+        return;
+    }
+    while (simulation_step(&part->sim))
+    {
+    }
+}
+
+static void *partition_worker(void *arg)
+{
+    partition_pool *pool = (partition_pool *)arg;
+    int k;
+
+    for (;;)
+    {
+        k = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (k >= pool->count)
+        {
+            break;
+        }
+        run_partition(&pool->parts[k]);
+    }
+
+    return NULL;
+}
+
+static void *window_worker(void *arg)
+{
+    window_worker_arg *w = (window_worker_arg *)arg;
+    partition_pool *pool = w->pool;
+    partition *parts = pool->parts;
+    int ncpus = pool->count;
+    long window = 0;
+    sim_time start = pool->first_window;
+    sim_time end, sent, next_event;
+    int finished, parity;
+    int c;
+
+    for (;;)
+    {
+        end = start + pool->lookahead;
+        parity = window & 1;
+
+        // Simular la ventana y enviar las migraciones
+        for (c = w->id; c < ncpus; c += pool->nthreads)
+        {
+            run_window(&parts[c], ncpus, end);
+            sent = send_migration(&parts[c], &pool->mailboxes[c], ncpus,
+                                  parts[(c + 1) % ncpus].ready[parity ^ 1], window, end);
+            publish(&parts[c], parity, sent);
+        }
+
+        pthread_barrier_wait(&pool->barrier);
+
+        // Todos los hilos llegan a la misma decision con los valores publicados
+        next_event = SIM_TIME_MAX;
+        finished = 0;
+        for (c = 0; c < ncpus; c++)
+        {
+            next_event = min(next_event, parts[c].next_event[parity]);
+            finished += parts[c].finished[parity];
+        }
+        if (finished == pool->total || next_event == SIM_TIME_MAX)
+        {
+            break;
+        }
+
+        for (c = w->id; c < ncpus; c += pool->nthreads)
+        {
+            receive_migrations(&parts[c], &pool->mailboxes[(c + ncpus - 1) % ncpus], window);
+        }
+
+        // Saltar las ventanas sin eventos
+        start = next_event - next_event % pool->lookahead;
+        start = (start > end) ? start : end;
+        window++;
+    }
+
+    return NULL;
+}
+
+static void run_window(partition *part, int ncpus, sim_time end)
+{
+    simulation *sim = &part->sim;
+    migration m;
+    sim_time ready_at;
+
+    for (;;)
+    {
+        ready_at = migration_deque_empty(&part->incoming)
+                       ? SIM_TIME_MAX
+                       : migration_deque_front(&part->incoming).ready_at;
+
+        while (simulation_step_before(sim, min(ready_at, end)))
+        {
+        }
+        if (ready_at >= end)
+        {
+            break;
+        }
+
+        // Admitir el proceso migrado: su espera sigue contando desde ready_since
+        if (sim->now < ready_at)
+        {
+            sim->now = ready_at;
+            process_arrival(sim->now, sim->queues, sim->nqueues,
+                            sim->opts->quiet ? NULL : sim->out);
+        }
+        m = migration_deque_pop_front(&part->incoming);
+        if (!sim->opts->quiet)
+        {
+            fprintf(sim->out, "[T=%" PRIsim "] Proceso %s llega desde CPU %d\n",
+                    sim->now, process_name(m.p), (part->cpu + ncpus - 1) % ncpus + 1);
+        }
+        m.p->cpu = part->cpu;
+        push_ready(&sim->queues[m.queue], m.p);
+        process_vector_push_back(&part->processes, m.p);
+        sim->remaining++;
+        part->migrated_in++;
+    }
+}
+
+static sim_time send_migration(partition *part, mailbox *box, int ncpus, int neighbour_ready,
+                               long window, sim_time end)
+{
+    simulation *sim = &part->sim;
+    migration m;
+    process_vector_iterator it;
+    int ready = get_ready_count(sim->queues, sim->nqueues);
+    int q;
+
+    // Solo si queda al menos un proceso listo y la migracion no invierte la carga
+    if (ready < 2 || ready <= neighbour_ready + 1)
+    {
+        return SIM_TIME_MAX;
+    }
+
+    // El ultimo proceso de la cola de menor prioridad es el que mas esperaria
+    for (q = sim->nqueues - 1; process_deque_empty(sim->queues[q].ready); q--)
+    {
+    }
+    m.p = process_deque_pop_back(sim->queues[q].ready);
+    m.queue = q;
+    m.ready_at = (sim->now > end) ? sim->now : end;
+    m.window = window;
+
+    for (it = process_vector_tail(&part->processes); it != 0 && *it != m.p;
+         it = process_vector_previous(&part->processes, it))
+    {
+    }
+    process_vector_remove_at(&part->processes, (int)(it - part->processes.items));
+    sim->remaining--;
+    part->migrated_out++;
+
+    if (!sim->opts->quiet)
+    {
+        fprintf(sim->out, "[T=%" PRIsim "] Proceso %s migra a CPU %d\n",
+                m.ready_at, process_name(m.p), (part->cpu + 1) % ncpus + 1);
+    }
+    mailbox_push(box, &m);
+
+    return m.ready_at;
+}
+
+static void receive_migrations(partition *part, mailbox *box, long window)
+{
+    migration *m;
+
+    // Solo las migraciones de esta ventana: el productor puede ir una adelante
+    while ((m = mailbox_peek(box)) != NULL && m->window <= window)
+    {
+        migration_deque_insert_ordered(&part->incoming, *m, compare_ready_at);
+        mailbox_pop(box);
+    }
+}
+
+static void publish(partition *part, int parity, sim_time sent)
+{
+    simulation *sim = &part->sim;
+    sim_time next_event;
+
+    part->ready[parity] = get_ready_count(sim->queues, sim->nqueues);
+    if (part->ready[parity] > 0)
+    {
+        next_event = sim->now;
+    }
+    else
+    {
+        next_event = get_next_arrival(sim->queues, sim->nqueues);
+        next_event = (next_event == -1) ? SIM_TIME_MAX : next_event;
+    }
+    if (!migration_deque_empty(&part->incoming))
+    {
+        next_event = min(next_event, migration_deque_front(&part->incoming).ready_at);
+    }
+
+    part->next_event[parity] = min(next_event, sent);
+    part->finished[parity] = part->assigned + part->migrated_in - part->migrated_out -
+                             sim->remaining;
+}
+
+static int compare_ready_at(const migration *a, const migration *b)
+{
+    sim_time ta = a->ready_at;
+    sim_time tb = b->ready_at;
+
+    return (ta < tb) - (ta > tb);
+}
+
+static void mailbox_push(mailbox *box, const migration *m)
+{
+    unsigned tail = __atomic_load_n(&box->tail, __ATOMIC_RELAXED);
+
+    while (tail - __atomic_load_n(&box->head, __ATOMIC_ACQUIRE) == MAILBOX_SIZE)
+    {
+        sched_yield();
+    }
+    box->slots[tail % MAILBOX_SIZE] = *m;
+    __atomic_store_n(&box->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static migration *mailbox_peek(mailbox *box)
+{
+    unsigned head = __atomic_load_n(&box->head, __ATOMIC_RELAXED);
+
+    if (head == __atomic_load_n(&box->tail, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+    return &box->slots[head % MAILBOX_SIZE];
+}
+
+static void mailbox_pop(mailbox *box)
+{
+    __atomic_store_n(&box->head, box->head + 1, __ATOMIC_RELEASE);
+}
+
+static void copy_output(FILE *file, FILE *out)
+{
+    char buf[8192];
+    size_t n;
+
+    fflush(file);
+    rewind(file);
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+    {
+        fwrite(buf, 1, n, out);
+    }
+}
+
+static void merge_record(const seq_record *r, void *arg)
+{
+    seqlog_push_record((seqlog *)arg, r);
+}
+
+static void add_busy_time(const seq_record *r, void *arg)
+{
+    *(long long *)arg += (long long)r->length * r->repeat;
+}
+
+static void report_partitions(process_vector *processes, partition *parts, int ncpus, int nqueues,
+                              const sched_options *opts)
+{
+    FILE *report = report_output(opts);
+    sched_stats *stats;
+    seqlog *sequence;
+    process **by_pid;
+    process_vector_iterator it;
+    process *p;
+    column_summary summary;
+    time_summary waiting;
+    sim_time *times;
+    int *column;
+    long long busy;
+    long dispatches = 0;
+    sim_time total_time = 0;
+    int max_pid = 0;
+    int i;
+
+    for (i = 0; i < ncpus; i++)
+    {
+        total_time = (parts[i].sim.now > total_time) ? parts[i].sim.now : total_time;
+    }
+
+    // IMPRIMIR RESULTADOS DE LA SIMULACION
+    fprintf(report, "\n=== RESULTADOS DE LA SIMULACION ===\n");
+    fprintf(report, "Colas de prioridad: %d\n", nqueues);
+    fprintf(report, "CPUs: %d\n", ncpus);
+    fprintf(report, "Tiempo total de la simulacion: %" PRIsim " unidades de tiempo\n", total_time);
+
+    times = (sim_time *)malloc(sizeof(sim_time) * (processes->count + 1));
+    time_column_reduce(times, time_column(processes, offsetof(process, waiting_time), times),
+                       &waiting);
+    free(times);
+    fprintf(report, "Tiempo promedio de espera: %.2f unidades de tiempo\n",
+            (double)waiting.sum / processes->count);
+    column = (int *)malloc(sizeof(int) * (processes->count + 1));
+    column_reduce(column, process_column(processes, offsetof(process, pid), column), &summary);
+    max_pid = (summary.max > 0) ? summary.max : 0;
+    free(column);
+
+    // TABLA DE PROCESOS (CPU en la que termino)
+    fprintf(report, "\n%5s%15s%6s%21s%10s%21s%21s\n",
+            "#", "Proceso", "CPU", "T. Llegada", "Tamaño", "T. Espera", "T. Finalizacion");
+    fprintf(report, "----------------------------------------------------------------------"
+                    "-----------------------------\n");
+    i = 1;
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        fprintf(report, "%5d%15s%6d%21" PRIsim "%10d%21" PRIsim "%21" PRIsim "\n",
+                i++, process_name(p), p->cpu + 1, p->arrival_time, p->execution_time,
+                p->waiting_time, p->finished_time);
+    }
+
+    // RESUMEN POR CPU
+    fprintf(report, "\n%5s%10s%21s%14s%14s", "CPU", "Procesos", "T. total", "Asignaciones",
+            "Utilizacion");
+    fprintf(report, opts->migration ? "%10s%10s\n" : "\n", "Salidas", "Entradas");
+    for (i = 0; i < ncpus; i++)
+    {
+        busy = 0;
+        seqlog_foreach(parts[i].sim.sequence, add_busy_time, &busy);
+        fprintf(report, "%5d%10d%21" PRIsim "%14ld%13.1f%%",
+                i + 1, parts[i].processes.count, parts[i].sim.now, parts[i].sim.dispatches,
+                (total_time > 0) ? 100.0 * busy / total_time : 0.0);
+        if (opts->migration)
+        {
+            fprintf(report, "%10ld%10ld", parts[i].migrated_out, parts[i].migrated_in);
+        }
+        fprintf(report, "\n");
+        dispatches += parts[i].sim.dispatches;
+    }
+
+    // PLAZOS DE LAS TAREAS PERIODICAS (la CPU de cada tarea es aquella en la que termino)
+    report_periodic(processes, parts[0].queues, nqueues, ncpus, report);
+
+    // PERCENTILES DE LATENCIA Y THROUGHPUT (los histogramas se suman)
+    stats = (opts->stats != NULL) ? opts->stats : create_stats(nqueues);
+    for (i = 0; i < ncpus; i++)
+    {
+        stats_merge(stats, parts[i].sim.stats);
+    }
+    print_stats(stats, report);
+    if (opts->stats_path != NULL)
+    {
+        FILE *stats_file = fopen(opts->stats_path, "wb");
+        if (stats_file == NULL || !write_stats(stats, stats_file))
+        {
+            fprintf(report, "Error: no se pudieron guardar las estadisticas en %s\n",
+                    opts->stats_path);
+        }
+        if (stats_file != NULL)
+        {
+            fclose(stats_file);
+        }
+    }
+    if (stats != opts->stats)
+    {
+        destroy_stats(stats);
+    }
+
+    // SECUENCIA DE EJECUCION: registro combinado en orden de CPU
+    if (opts->seq_log_path != NULL)
+    {
+        sequence = create_seqlog(opts->seq_log_path, opts->seq_mem_cap);
+        if (sequence == NULL)
+        {
+            fprintf(report, "Error: no se pudo crear el registro de secuencia %s\n",
+                    opts->seq_log_path);
+        }
+        else
+        {
+            int *pids = (int *)malloc(sizeof(int) * (processes->count + 1));
+            const char **names = (const char **)malloc(sizeof(char *) * (processes->count + 1));
+
+            for (i = 0; i < ncpus; i++)
+            {
+                seqlog_foreach(parts[i].sim.sequence, merge_record, sequence);
+            }
+            sequence->dispatches = dispatches;
+
+            i = 0;
+            for (it = process_vector_head(processes); it != 0;
+                 it = process_vector_next(processes, it), i++)
+            {
+                p = *it;
+                pids[i] = p->pid;
+                names[i] = process_name(p);
+            }
+            if (seqlog_finish(sequence, pids, names, i))
+            {
+                fprintf(report, "\nSecuencia guardada en %s (%ld asignaciones, %ld registros)\n",
+                        sequence->path, sequence->dispatches, sequence->spilled);
+            }
+            free(pids);
+            free(names);
+            destroy_seqlog(sequence);
+        }
+    }
+
+    by_pid = (process **)calloc(max_pid + 1, sizeof(process *));
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        if (p->pid >= 0)
+        {
+            by_pid[p->pid] = p;
+        }
+    }
+    fprintf(report, "\nSecuencia de ejecucion:\n");
+    for (i = 0; i < ncpus; i++)
+    {
+        fprintf(report, "CPU %d: ", i + 1);
+        print_sequence(parts[i].sim.sequence, by_pid, max_pid, report);
+        fprintf(report, "\n");
+    }
+    free(by_pid);
+}
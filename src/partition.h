@@ -0,0 +1,29 @@
+/**
+ * @file
+ * @brief Simulacion paralela de CPUs independientes.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Con DEFINE cpus N cada proceso queda fijado a una CPU (sexto parametro de
+ * PROCESS) y no migra, de modo que cada CPU es una particion independiente
+ * con sus propias colas de prioridad. Las particiones se simulan en hilos
+ * separados y sus resultados se combinan en orden de CPU, por lo que la
+ * salida no depende de la cantidad de hilos.
+ */
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "sched.h"
+
+/**
+ * @brief Simula cada CPU como una particion independiente.
+ * @param processes Vector de procesos (process.cpu indica su CPU)
+ * @param queues Colas de prioridad (configuracion comun a todas las CPUs)
+ * @param nqueues Cantidad de colas de prioridad
+ * @param opts Opciones de la simulacion (opts->ncpus, opts->threads)
+ * @return 1 si la simulacion se ejecuto, 0 en caso de error.
+ */
+int schedule_partitions(process_vector *processes, priority_queue *queues, int nqueues,
+                        const sched_options *opts);
+
+#endif
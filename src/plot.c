@@ -8,8 +8,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
-#include "list.h"
 #include "plot.h"
 #include "sched.h"
 #include "split.h"
@@ -18,40 +18,313 @@
 // Include headers for Linux/Unix systems
 #ifdef __linux__
 #include <unistd.h>
+#include <spawn.h>
 #include <sys/wait.h>
 #endif
 
-int create_plot(char *path, list *processes)
+#include <pthread.h>
+
+/** @brief Copia de las slices de un proceso para graficar */
+typedef struct
 {
-    int max_time;
-    int xticks;
-    int nprocesses;
+    int pid;          /*!< PID del proceso */
+    name_id name;     /*!< Nombre del proceso (se resuelve al escribir el script) */
+    int nslices;      /*!< Cantidad de slices (una slice periodica cuenta una vez) */
+    slice *slices;    /*!< Copia de las slices, ordenadas por tiempo inicial */
+    sim_time *max_to; /*!< Indice de intervalos: maximo fin (ultima repeticion) de slices[0..i] */
+    int y;            /*!< Posicion en el eje Y */
+} plot_row;
 
-    node_iterator it;
-    node_iterator slice_it;
-    process *proc;
-    slice *s;
-    int line_style;
+/** @brief Grafica pendiente de generar */
+typedef struct plot_job
+{
+    char *path;            /*!< Ruta del script de gnuplot */
+    char *image_path;      /*!< Ruta de la imagen generada */
+    int nrows;             /*!< Cantidad de procesos */
+    plot_row *rows;        /*!< Copia de los procesos */
+    sim_time max_time;     /*!< Tiempo maximo de planificacion */
+    plot_options opts;     /*!< Opciones del diagrama */
+    int result;            /*!< 1 = script escrito y gnuplot lanzado */
+#ifdef __linux__
+    pid_t gnuplot_pid;     /*!< PID del proceso gnuplot, o -1 */
+#endif
+    pthread_t thread;      /*!< Hilo que escribe el script */
+    struct plot_job *next; /*!< Siguiente grafica pendiente */
+} plot_job;
 
-    char *image_path;
-    char *plot_cmd;
+/** @brief Graficas lanzadas en segundo plano que aun no se han esperado */
+static plot_job *pending_plots = NULL;
 
-    image_path = concat(remove_extension(path), ".png");
-    plot_cmd = concat("gnuplot \"", concat(path, "\""));
+/** @brief Protege pending_plots (se pueden lanzar graficas desde varios hilos) */
+static pthread_mutex_t pending_lock = PTHREAD_MUTEX_INITIALIZER;
 
-    int line_cnt;
-    FILE *stream;
+/**
+ * @brief Toma una copia de los procesos y sus slices.
+ * @param path Ruta del archivo de salida
+ * @param processes Vector de procesos simulados.
+ * @param opts Opciones del diagrama, o NULL para graficar todas las slices.
+ * @return Nueva grafica pendiente, o NULL si no hay procesos.
+ */
+static plot_job *create_plot_job(char *path, process_vector *processes, const plot_options *opts);
 
-    if (processes == 0 || processes->count == 0)
+/**
+ * @brief Libera la memoria de una grafica.
+ * @param job Grafica a liberar
+ */
+static void free_plot_job(plot_job *job);
+
+/**
+ * @brief Escribe el script de gnuplot y lanza gnuplot.
+ * @param arg Grafica pendiente (plot_job *)
+ * @return NULL
+ */
+static void *run_plot_job(void *arg);
+
+/**
+ * @brief Espera a que gnuplot termine de generar la imagen.
+ * @param job Grafica pendiente
+ * @return 1 si la imagen se genero, 0 en caso contrario.
+ */
+static int finish_plot_job(plot_job *job);
+
+/**
+ * @brief Construye el indice de intervalos de las slices de un proceso.
+ *
+ * Las slices se ordenan por tiempo inicial (normalmente ya lo estan) y se
+ * calcula el maximo prefijo de los tiempos finales (de la ultima repeticion
+ * de las slices periodicas), que es monotono y permite buscar por biseccion
+ * la primera slice que puede traslaparse con una ventana, aun si las slices
+ * se traslapan entre si.
+ * @param row Proceso a indexar
+ */
+static void build_slice_index(plot_row *row);
+
+/**
+ * @brief Busca la primera slice que puede traslaparse con [from, ...).
+ * @param row Proceso indexado
+ * @param from Tiempo inicial de la ventana
+ * @return Indice de la primera slice con max_to > from, o nslices.
+ */
+static int first_overlap(plot_row *row, sim_time from);
+
+/**
+ * @brief Calcula las repeticiones de una slice que se traslapan con [from, to).
+ *
+ * La repeticion k ocupa [s->from + k * period, s->from + k * period + length):
+ * la primera es la primera que termina despues de from y la ultima, la
+ * ultima que empieza antes de to.
+ * @param s Slice
+ * @param from Tiempo inicial de la ventana
+ * @param to Tiempo final de la ventana
+ * @param first Salida: primera repeticion
+ * @param last Salida: ultima repeticion
+ * @return 1 si alguna repeticion se traslapa, 0 en caso contrario.
+ */
+static int overlapping_repeats(const slice *s, sim_time from, sim_time to, int *first,
+                               int *last);
+
+/**
+ * @brief Calcula el tiempo cubierto por las repeticiones first..last de una
+ * slice antes de x, sin recorrerlas.
+ * @param s Slice
+ * @param first Primera repeticion
+ * @param last Ultima repeticion
+ * @param x Tiempo
+ * @return Suma de la parte de cada repeticion anterior a x.
+ */
+static double covered_before(const slice *s, int first, int last, double x);
+
+/**
+ * @brief Escribe una flecha por cada repeticion de slice que se traslapa con [from, to).
+ * @param stream Archivo del script
+ * @param row Proceso indexado
+ * @param from Tiempo inicial de la ventana
+ * @param to Tiempo final de la ventana
+ * @param line_cnt Contador de flechas
+ */
+static void write_slice_arrows(FILE *stream, plot_row *row, sim_time from, sim_time to,
+                               int *line_cnt);
+
+/**
+ * @brief Escribe la densidad de CPU/WAIT del proceso por columna de pixeles.
+ *
+ * Acumula el tiempo de CPU y de espera de cada columna y emite una flecha
+ * por cada racha de columnas con el mismo estado dominante, de modo que la
+ * cantidad de flechas no depende de la cantidad de slices. El tiempo de una
+ * slice periodica en cada columna se calcula con covered_before(), sin
+ * recorrer sus repeticiones.
+ * @param stream Archivo del script
+ * @param row Proceso indexado
+ * @param from Tiempo inicial de la ventana
+ * @param to Tiempo final de la ventana
+ * @param cpu Acumulador de CPU por columna (PLOT_COLUMNS elementos)
+ * @param wait Acumulador de espera por columna (PLOT_COLUMNS elementos)
+ * @param line_cnt Contador de flechas
+ */
+static void write_density_arrows(FILE *stream, plot_row *row, sim_time from, sim_time to,
+                                 double *cpu, double *wait, int *line_cnt);
+
+/**
+ * @brief Compara dos slices por tiempo inicial (para qsort).
+ */
+static int compare_slice_from(const void *a, const void *b);
+
+int create_plot(char *path, process_vector *processes)
+{
+    plot_job *job;
+    int ret;
+
+    job = create_plot_job(path, processes, NULL);
+    if (job == NULL)
+    {
+        return 0;
+    }
+
+    run_plot_job(job);
+    ret = finish_plot_job(job);
+    free_plot_job(job);
+
+    return ret;
+}
+
+int create_plot_async(char *path, process_vector *processes, const plot_options *opts)
+{
+    plot_job *job;
+
+    job = create_plot_job(path, processes, opts);
+    if (job == NULL)
+    {
+        return 0;
+    }
+
+    if (pthread_create(&job->thread, NULL, run_plot_job, job) != 0)
     {
+        fprintf(stderr, "Warning! unable to start plot thread!\n");
+        free_plot_job(job);
         return 0;
     }
 
-    //Obtener la cantidad de procesos
-    nprocesses = processes->count;
+    pthread_mutex_lock(&pending_lock);
+    job->next = pending_plots;
+    pending_plots = job;
+    pthread_mutex_unlock(&pending_lock);
+
+    return 1;
+}
+
+int wait_plots()
+{
+    plot_job *job, *jobs;
+    int failed = 0;
+
+    // Tomar la lista completa: las graficas que se lancen despues no se esperan aqui
+    pthread_mutex_lock(&pending_lock);
+    jobs = pending_plots;
+    pending_plots = NULL;
+    pthread_mutex_unlock(&pending_lock);
+
+    while (jobs != NULL)
+    {
+        job = jobs;
+        jobs = job->next;
+
+        pthread_join(job->thread, NULL);
+        if (!finish_plot_job(job))
+        {
+            failed++;
+        }
+        free_plot_job(job);
+    }
+
+    return failed;
+}
+
+static plot_job *create_plot_job(char *path, process_vector *processes, const plot_options *opts)
+{
+    plot_job *job;
+    process_vector_iterator it;
+    process *proc;
+    plot_row *row;
+
+    if (processes == 0 || processes->count == 0)
+    {
+        return NULL;
+    }
+
+    job = (plot_job *)malloc(sizeof(plot_job));
+    memset(job, 0, sizeof(plot_job));
+    job->path = concat(path, "");
+    job->image_path = concat(remove_extension(path), ".png");
+    job->opts.mode = PLOT_FULL;
+    if (opts != NULL)
+    {
+        job->opts = *opts;
+    }
+#ifdef __linux__
+    job->gnuplot_pid = -1;
+#endif
 
     // Obtener el tiempo maximo de planificacion
-    max_time = max_scheduling_time(processes);
+    job->max_time = max_scheduling_time(processes);
+
+    // Copiar los procesos y sus slices
+    job->nrows = processes->count;
+    job->rows = (plot_row *)malloc(sizeof(plot_row) * job->nrows);
+
+    row = job->rows;
+    for (it = process_vector_head(processes); it != 0;
+         it = process_vector_next(processes, it), row++)
+    {
+        proc = *it;
+        row->pid = proc->pid;
+        row->y = proc->pid;
+        row->name = proc->name;
+        // Las slices periodicas (rondas Round Robin) se copian sin expandir
+        row->nslices = proc->slices.count;
+        row->slices = (slice *)malloc(sizeof(slice) * (row->nslices > 0 ? row->nslices : 1));
+        if (row->nslices > 0)
+        {
+            memcpy(row->slices, slice_vector_head(&proc->slices), sizeof(slice) * row->nslices);
+        }
+        row->max_to = NULL;
+    }
+
+    return job;
+}
+
+static void free_plot_job(plot_job *job)
+{
+    int i;
+
+    for (i = 0; i < job->nrows; i++)
+    {
+        free(job->rows[i].slices);
+        free(job->rows[i].max_to);
+    }
+    free(job->rows);
+    free(job->path);
+    free(job->image_path);
+    free(job);
+}
+
+static void *run_plot_job(void *arg)
+{
+    plot_job *job = (plot_job *)arg;
+    sim_time max_time;
+    sim_time xticks;
+    int nvisible;
+    sim_time from, to;
+    int first, last;
+    int i, k;
+    plot_row *row;
+    int line_cnt;
+    double *cpu = NULL;
+    double *wait = NULL;
+    FILE *stream;
+
+    job->result = 0;
+
+    max_time = job->max_time;
 
     if (max_time == 0)
     {
@@ -59,48 +332,103 @@ int create_plot(char *path, list *processes)
         max_time = 10;
     }
 
+    // Indexar las slices solo si se grafica un subconjunto o una vista general
+    if (job->opts.window || job->opts.mode == PLOT_OVERVIEW)
+    {
+        for (i = 0; i < job->nrows; i++)
+        {
+            build_slice_index(&job->rows[i]);
+        }
+    }
+
+    // Rango de tiempo a graficar
+    from = 0;
+    to = max_time;
+    nvisible = job->nrows;
+
+    if (job->opts.window)
+    {
+        from = job->opts.from;
+        to = job->opts.to;
+        if (to <= from)
+        {
+            to = from + 1;
+        }
+
+        // Solo se grafican los procesos con alguna repeticion de slice dentro de la ventana
+        nvisible = 0;
+        for (i = 0; i < job->nrows; i++)
+        {
+            row = &job->rows[i];
+            row->y = 0;
+            for (k = first_overlap(row, from); k < row->nslices && row->slices[k].from < to; k++)
+            {
+                if (overlapping_repeats(&row->slices[k], from, to, &first, &last))
+                {
+                    row->y = ++nvisible;
+                    break;
+                }
+            }
+        }
+    }
+
     // Open file to plot command
-    stream = fopen(path, "w");
+    stream = fopen(job->path, "w");
 
     if (stream == NULL)
     {
-        return 0;
+        return NULL;
     }
 
     xticks = 5;
 
-    if (max_time > 100)
+    if (to - from > 100)
     {
         xticks = 10;
     }
 
-    if (max_time < 20)
+    if (to - from < 20)
     {
         xticks = 1;
     }
 
+    // Para rangos muy grandes, usar aproximadamente 10 marcas
+    if (to - from > 1000)
+    {
+        xticks = (to - from) / 10;
+    }
+
     fprintf(stream, "set term pngcairo dashed size 1024,768\n");
-    fprintf(stream, "set output '%s'\n", image_path);
+    fprintf(stream, "set output '%s'\n", job->image_path);
     fprintf(stream, "set style fill solid\n");
-    fprintf(stream, "set xrange [0:%d]\n", max_time + (max_time % xticks) + xticks);
-    fprintf(stream, "set yrange [0:%d]\n", nprocesses + 1);
+    if (job->opts.window)
+    {
+        fprintf(stream, "set xrange [%" PRIsim ":%" PRIsim "]\n", from, to);
+        fprintf(stream, "set yrange [0:%d]\n", nvisible + 1);
+    }
+    else
+    {
+        fprintf(stream, "set xrange [0:%" PRIsim "]\n", max_time + (max_time % xticks) + xticks);
+        fprintf(stream, "set yrange [0:%d]\n", job->nrows + 1);
+    }
     fprintf(stream, "unset ytics\n");
     fprintf(stream, "set title 'Planificacion de Procesos'\n");
-    
+
     // Configurar etiquetas del eje Y con nombres de procesos
     fprintf(stream, "set ytics(");
-    for (it = head(processes); it != 0; it = next(it))
+    k = 0;
+    for (i = 0; i < job->nrows; i++)
     {
-        proc = (process *)it->data;
-        fprintf(stream, "'%s' %d", proc->name, proc->pid);
-        if (it->next != 0)
+        row = &job->rows[i];
+        if (row->y == 0)
         {
-            fprintf(stream, ",");
+            continue;
         }
+        fprintf(stream, "%s'%s' %d", (k++ > 0) ? "," : "", name_string(row->name), row->y);
     }
     fprintf(stream, ")\n");
-    
-    fprintf(stream, "set xtics %d\n", xticks);
+
+    fprintf(stream, "set xtics %" PRIsim "\n", xticks);
     fprintf(stream, "unset key\n");
     fprintf(stream, "set xlabel 'Tiempo'\n");
     fprintf(stream, "set ylabel 'Proceso'\n");
@@ -114,79 +442,331 @@ int create_plot(char *path, list *processes)
     fprintf(stream, "set style arrow 2 heads size screen 0.008,100 ls 2\n");
     fprintf(stream, "set style arrow 3 heads size screen 0.008,100 ls 3\n");
 
+    if (job->opts.mode == PLOT_OVERVIEW)
+    {
+        // Tonos claros para columnas ocupadas menos de la mitad del tiempo
+        fprintf(stream, "set style line 4 lt 1 lw 2 lc rgb '#a0ffa0'\n"); // Verde claro - CPU parcial
+        fprintf(stream, "set style line 5 lt 1 lw 1 lc rgb '#ffa0a0'\n"); // Rojo claro - Espera parcial
+        fprintf(stream, "set style arrow 4 nohead ls 4\n");
+        fprintf(stream, "set style arrow 5 nohead ls 5\n");
+
+        cpu = (double *)malloc(sizeof(double) * PLOT_COLUMNS);
+        wait = (double *)malloc(sizeof(double) * PLOT_COLUMNS);
+    }
+
     // Generar flechas para cada slice de tiempo
     line_cnt = 1;
-    for (it = head(processes); it != 0; it = next(it))
+    for (i = 0; i < job->nrows; i++)
     {
-        proc = (process *)it->data;
-        for (slice_it = head(proc->slices); slice_it != 0; slice_it = next(slice_it))
+        row = &job->rows[i];
+        if (row->y == 0)
         {
-            s = (slice *)slice_it->data;
-            line_style = 1;
-            if (s->type == WAIT)
-            {
-                line_style = 3; // Estilo rojo para tiempo de espera
-            }
-            fprintf(stream, "set arrow %d from %d,%d to %d,%d as %d\n",
-                    line_cnt++, s->from, proc->pid,
-                    s->to, proc->pid, line_style);
+            continue;
+        }
+        if (job->opts.mode == PLOT_OVERVIEW)
+        {
+            write_density_arrows(stream, row, from, to, cpu, wait, &line_cnt);
+        }
+        else if (job->opts.window)
+        {
+            write_slice_arrows(stream, row, from, to, &line_cnt);
+        }
+        else
+        {
+            write_slice_arrows(stream, row, SIM_TIME_MIN, SIM_TIME_MAX, &line_cnt);
         }
     }
 
+    free(cpu);
+    free(wait);
+
     // Plot no data (NaN) - solo para generar el grafico con las flechas
     fprintf(stream, "plot NaN\n");
     fclose(stream);
 
-// Execute gnuplot command based on operating system
+// Launch gnuplot based on operating system
 #ifdef __linux__
-    pid_t pid;
-    if ((pid = fork()) < 0)
-    {
-        fprintf(stderr, "Warning! unable to execute plot program!\n");
-        free(image_path);
-        return 0;
-    }
+    char *argv[] = {"gnuplot", job->path, NULL};
+    extern char **environ;
 
-    if (pid == 0)
+    // posix_spawnp es seguro desde un hilo, a diferencia de fork()+exit()
+    if (posix_spawnp(&job->gnuplot_pid, "gnuplot", NULL, NULL, argv, environ) != 0)
     {
-        // Child process
-        execlp("gnuplot", "gnuplot", path, (char *)NULL);
         fprintf(stderr, "Warning! error executing plot program! Make sure gnuplot is installed.\n");
-        exit(EXIT_FAILURE);
-    }
-    else
-    {
-        // Parent process
-        int status = 0;
-        if (waitpid(pid, &status, 0) != pid)
-        {
-            fprintf(stderr, "Warning! unable to plot chart!\n");
-            free(image_path);
-            return 0;
-        }
-        
-        if (WEXITSTATUS(status) != 0)
-        {
-            fprintf(stderr, "Warning! gnuplot execution failed!\n");
-            free(image_path);
-            return 0;
-        }
+        job->gnuplot_pid = -1;
+        return NULL;
     }
 #else
     // Fallback for other systems - use system() call
-    char *full_cmd = concat("gnuplot \"", concat(path, "\""));
+    char *full_cmd = concat("gnuplot \"", concat(job->path, "\""));
     int result = system(full_cmd);
     free(full_cmd);
-    
+
     if (result != 0)
     {
         fprintf(stderr, "Warning! gnuplot execution failed!\n");
-        free(image_path);
+        return NULL;
+    }
+#endif
+
+    job->result = 1;
+    return NULL;
+}
+
+static int finish_plot_job(plot_job *job)
+{
+    if (!job->result)
+    {
+        return 0;
+    }
+
+#ifdef __linux__
+    int status = 0;
+    if (waitpid(job->gnuplot_pid, &status, 0) != job->gnuplot_pid)
+    {
+        fprintf(stderr, "Warning! unable to plot chart!\n");
+        return 0;
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Warning! gnuplot execution failed!\n");
         return 0;
     }
 #endif
 
-    printf("Diagram generated: %s\n", image_path);
-    free(image_path);
+    fprintf((job->opts.out != NULL) ? job->opts.out : stdout, "Diagram generated: %s\n",
+            job->image_path);
     return 1;
-}
\ No newline at end of file
+}
+
+static int compare_slice_from(const void *a, const void *b)
+{
+    const slice *s1 = (const slice *)a;
+    const slice *s2 = (const slice *)b;
+    return (s1->from > s2->from) - (s1->from < s2->from);
+}
+
+static void build_slice_index(plot_row *row)
+{
+    int i;
+
+    for (i = 1; i < row->nslices; i++)
+    {
+        if (row->slices[i].from < row->slices[i - 1].from)
+        {
+            qsort(row->slices, row->nslices, sizeof(slice), compare_slice_from);
+            break;
+        }
+    }
+
+    row->max_to = (sim_time *)malloc(sizeof(sim_time) * (row->nslices > 0 ? row->nslices : 1));
+    for (i = 0; i < row->nslices; i++)
+    {
+        row->max_to[i] = slice_last_end(&row->slices[i]);
+        if (i > 0 && row->max_to[i - 1] > row->max_to[i])
+        {
+            row->max_to[i] = row->max_to[i - 1];
+        }
+    }
+}
+
+static int first_overlap(plot_row *row, sim_time from)
+{
+    int lo = 0;
+    int hi = row->nslices;
+    int mid;
+
+    if (row->max_to == NULL)
+    {
+        return 0;
+    }
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (row->max_to[mid] > from)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+static int overlapping_repeats(const slice *s, sim_time from, sim_time to, int *first,
+                               int *last)
+{
+    sim_time k;
+
+    if (s->repeat <= 0 || s->from >= to || slice_last_end(s) <= from)
+    {
+        return 0;
+    }
+    if (s->repeat == 1 || s->period <= 0)
+    {
+        *first = 0;
+        *last = 0;
+        return 1;
+    }
+
+    // Primera repeticion que termina despues de from: from < s->from + k * period + length
+    *first = (slice_end(s) > from) ? 0 : (int)((from - slice_end(s)) / s->period + 1);
+    // Ultima repeticion que empieza antes de to: s->from + k * period < to
+    k = (to - s->from - 1) / s->period;
+    *last = (k < s->repeat - 1) ? (int)k : s->repeat - 1;
+    return *first <= *last;
+}
+
+static double covered_before(const slice *s, int first, int last, double x)
+{
+    double period = s->period;
+    double length = s->length;
+    double count = last - first + 1;
+    double t = x - (s->from + (double)first * period);
+    double started, full;
+
+    if (t <= 0)
+    {
+        return 0;
+    }
+
+    // Repeticiones que empiezan antes de x y, de ellas, las que terminan antes de x
+    started = (period > 0) ? floor(t / period) + 1 : count;
+    started = (started < count) ? started : count;
+    full = (t < length) ? 0 : (period > 0) ? floor((t - length) / period) + 1 : count;
+    full = (full < count) ? full : count;
+
+    // Las repeticiones k = full .. started - 1 aportan t - k * period cada una
+    return full * length + (started - full) * t -
+           period * (full + started - 1) * (started - full) / 2;
+}
+
+static void write_slice_arrows(FILE *stream, plot_row *row, sim_time from, sim_time to,
+                               int *line_cnt)
+{
+    int j, k;
+    int first, last;
+    slice *s;
+    sim_time start;
+    int line_style;
+
+    for (j = first_overlap(row, from); j < row->nslices && row->slices[j].from < to; j++)
+    {
+        s = &row->slices[j];
+        if (!overlapping_repeats(s, from, to, &first, &last))
+        {
+            continue;
+        }
+        line_style = 1;
+        if (s->type == WAIT)
+        {
+            line_style = 3; // Estilo rojo para tiempo de espera
+        }
+        for (k = first; k <= last; k++)
+        {
+            start = s->from + (sim_time)k * s->period;
+            fprintf(stream, "set arrow %d from %" PRIsim ",%d to %" PRIsim ",%d as %d\n",
+                    (*line_cnt)++, (start > from) ? start : from, row->y,
+                    (start + s->length < to) ? start + s->length : to, row->y, line_style);
+        }
+    }
+}
+
+static void write_density_arrows(FILE *stream, plot_row *row, sim_time from, sim_time to,
+                                 double *cpu, double *wait, int *line_cnt)
+{
+    double width = (double)(to - from) / PLOT_COLUMNS;
+    double start, end, col_from, col_to, time;
+    int c, c_from, c_to, run;
+    int j;
+    int first, last;
+    int style, run_style;
+    slice *s;
+
+    memset(cpu, 0, sizeof(double) * PLOT_COLUMNS);
+    memset(wait, 0, sizeof(double) * PLOT_COLUMNS);
+
+    // Acumular la ocupacion de cada columna; solo se visitan las slices de la ventana
+    for (j = first_overlap(row, from); j < row->nslices && row->slices[j].from < to; j++)
+    {
+        s = &row->slices[j];
+        if (!overlapping_repeats(s, from, to, &first, &last))
+        {
+            continue;
+        }
+        start = s->from + (sim_time)first * s->period;
+        end = s->from + (sim_time)last * s->period + s->length;
+        start = (start > from) ? start : from;
+        end = (end < to) ? end : to;
+        if (end <= start)
+        {
+            continue;
+        }
+
+        c_from = (int)((start - from) / width);
+        c_to = (int)((end - from) / width);
+        if (c_to >= PLOT_COLUMNS)
+        {
+            c_to = PLOT_COLUMNS - 1;
+        }
+
+        for (c = c_from; c <= c_to; c++)
+        {
+            col_from = from + c * width;
+            col_to = col_from + width;
+            col_from = (start > col_from) ? start : col_from;
+            col_to = (end < col_to) ? end : col_to;
+            if (col_to <= col_from)
+            {
+                continue;
+            }
+            // Una sola repeticion cubre toda la columna recortada
+            time = (first == last) ? col_to - col_from
+                                   : covered_before(s, first, last, col_to) -
+                                         covered_before(s, first, last, col_from);
+            if (s->type == CPU)
+            {
+                cpu[c] += time;
+            }
+            else
+            {
+                wait[c] += time;
+            }
+        }
+    }
+
+    // Emitir una flecha por cada racha de columnas con el mismo estilo
+    run = 0;
+    run_style = 0;
+    for (c = 0; c <= PLOT_COLUMNS; c++)
+    {
+        style = 0;
+        if (c < PLOT_COLUMNS)
+        {
+            if (cpu[c] > 0 && cpu[c] >= wait[c])
+            {
+                style = (cpu[c] + wait[c] >= width / 2) ? 1 : 4;
+            }
+            else if (wait[c] > 0)
+            {
+                style = (cpu[c] + wait[c] >= width / 2) ? 3 : 5;
+            }
+        }
+
+        if (style != run_style)
+        {
+            if (run_style != 0)
+            {
+                fprintf(stream, "set arrow %d from %.2f,%d to %.2f,%d as %d\n",
+                        (*line_cnt)++, from + run * width, row->y,
+                        from + c * width, row->y, run_style);
+            }
+            run = c;
+            run_style = style;
+        }
+    }
+}
@@ -9,14 +9,54 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include "list.h"
+#include "sched.h"
+#include "simtime.h"
+
+/** @brief Cantidad de columnas (pixeles) del modo de vista general */
+#define PLOT_COLUMNS 1000
+
+/** @brief Modo de generacion del diagrama */
+typedef enum
+{
+    PLOT_FULL,    /*!< Una flecha por cada slice */
+    PLOT_OVERVIEW /*!< Densidad de CPU/WAIT por columna de pixeles */
+} plot_mode;
+
+/** @brief Opciones del diagrama de Gantt */
+typedef struct
+{
+    plot_mode mode; /*!< Modo de generacion */
+    int window;     /*!< 1 = graficar solo la ventana [from, to) */
+    sim_time from;  /*!< Tiempo inicial de la ventana */
+    sim_time to;    /*!< Tiempo final de la ventana */
+    FILE *out;      /*!< Salida del aviso de diagrama generado, o NULL = stdout */
+} plot_options;
 
 /**
  * @brief Crea el diagrama de Gantt con los procesos simulados.
  * @param path Ruta del archivo de salida
- * @param processes Lista de procesos simulados.
+ * @param processes Vector de procesos simulados.
  * @return 1 si se puede crear la grafica, 0 en caso contrario.
  */
-int create_plot(char *path, list *processes);
+int create_plot(char *path, process_vector *processes);
+
+/**
+ * @brief Crea el diagrama de Gantt en segundo plano.
+ *
+ * Toma una copia de las slices de los procesos, de modo que el vector
+ * puede liberarse inmediatamente despues de la llamada. El script se
+ * escribe en un hilo aparte y gnuplot se lanza sin esperar su resultado.
+ * @param path Ruta del archivo de salida
+ * @param processes Vector de procesos simulados.
+ * @param opts Opciones del diagrama, o NULL para graficar todas las slices.
+ * @return 1 si se pudo iniciar la generacion, 0 en caso contrario.
+ */
+int create_plot_async(char *path, process_vector *processes, const plot_options *opts);
+
+/**
+ * @brief Espera a que terminen todas las graficas pendientes.
+ * @return Cantidad de graficas pendientes que fallaron.
+ */
+int wait_plots();
 
-#endif
\ No newline at end of file
+#endif
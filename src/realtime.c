@@ -0,0 +1,335 @@
+/**
+ * @file
+ * @brief Tareas periodicas y estrategias de tiempo real (EDF y RM).
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "realtime.h"
+
+/**
+ * @brief Calcula el maximo comun divisor de dos tiempos.
+ * @param a Tiempo A (positivo)
+ * @param b Tiempo B (positivo)
+ * @return Maximo comun divisor.
+ */
+static sim_time gcd_time(sim_time a, sim_time b);
+
+/**
+ * @brief Obtiene el plazo absoluto del trabajo actual de un proceso.
+ * @param p Proceso
+ * @return Plazo, o SIM_TIME_MAX si el proceso no es periodico.
+ */
+static sim_time absolute_deadline(const process *p);
+
+/**
+ * @brief Desempata dos procesos por PID.
+ * @param a Proceso A
+ * @param b Proceso B
+ * @return Positivo si A tiene menor PID, negativo si tiene mayor, 0 si es el mismo.
+ */
+static int compare_pid(const process *a, const process *b);
+
+/**
+ * @brief Imprime la prueba de utilizacion de una cola en una CPU.
+ * @param processes Vector de procesos
+ * @param queues Colas de prioridad
+ * @param queue Cola (0-based)
+ * @param cpu CPU (0-based)
+ * @param ncpus Cantidad de CPUs
+ * @param out Salida
+ */
+static void print_utilization(process_vector *processes, priority_queue *queues, int queue,
+                              int cpu, int ncpus, FILE *out);
+
+process *create_periodic_process(const char *name, sim_time phase, sim_delta period,
+                                 sim_delta wcet, sim_delta deadline)
+{
+    process *p = create_process(name, phase, wcet);
+    periodic_task *task = (periodic_task *)malloc(sizeof(periodic_task));
+
+    task->phase = phase;
+    task->period = period;
+    task->deadline = deadline;
+    task->jobs = 1;
+    task->completed = 0;
+    task->misses = 0;
+    task->response = (histogram *)malloc(sizeof(histogram));
+    hist_reset(task->response);
+    p->task = task;
+
+    return p;
+}
+
+void destroy_periodic_task(periodic_task *task)
+{
+    if (task != NULL)
+    {
+        free(task->response);
+        free(task);
+    }
+}
+
+void restart_periodic_task(process *p)
+{
+    p->arrival_time = p->task->phase;
+    p->task->completed = 0;
+    p->task->misses = 0;
+    hist_reset(p->task->response);
+}
+
+int plan_periodic_jobs(process_vector *processes, sim_time horizon)
+{
+    process_vector_iterator it;
+    periodic_task *task;
+    sim_time hyperperiod = 1;
+    sim_time max_phase = 0;
+    sim_time g;
+    int ntasks = 0;
+
+    // Horizonte por defecto: fase maxima + minimo comun multiplo de los periodos
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        task = (*it)->task;
+        if (task == NULL)
+        {
+            continue;
+        }
+        ntasks++;
+        max_phase = (task->phase > max_phase) ? task->phase : max_phase;
+        g = gcd_time(hyperperiod, task->period);
+        if (hyperperiod / g > SIM_TIME_MAX / task->period)
+        {
+            hyperperiod = -1;
+            break;
+        }
+        hyperperiod = hyperperiod / g * task->period;
+    }
+    if (ntasks == 0)
+    {
+        return 0;
+    }
+    if (horizon < 0)
+    {
+        if (hyperperiod < 0 || hyperperiod > SIM_TIME_MAX - max_phase)
+        {
+            return -1;
+        }
+        horizon = max_phase + hyperperiod;
+    }
+
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        task = (*it)->task;
+        if (task != NULL)
+        {
+            task->jobs = (horizon > task->phase)
+                             ? (long)((horizon - task->phase + task->period - 1) / task->period)
+                             : 1;
+        }
+    }
+
+    return ntasks;
+}
+
+int finish_job(process *p, sim_time now, FILE *out)
+{
+    periodic_task *task = p->task;
+    sim_time response = now - p->arrival_time;
+
+    hist_record(task->response, response);
+    if (response > task->deadline)
+    {
+        task->misses++;
+        if (out != NULL)
+        {
+            fprintf(out, "[T=%" PRIsim "] Tarea %s perdio el plazo del trabajo %ld (atraso %" PRIsim
+                    ")\n", now, process_name(p), task->completed + 1, response - task->deadline);
+        }
+    }
+    task->completed++;
+
+    if (task->completed >= task->jobs)
+    {
+        p->arrival_time = task->phase;
+        return 0;
+    }
+
+    // Liberacion del siguiente trabajo (puede haber pasado ya)
+    p->arrival_time = task->phase + (sim_time)task->completed * task->period;
+    p->remaining_time = p->execution_time;
+    return 1;
+}
+
+int compare_deadline(process *const *a, process *const *b)
+{
+    sim_time da = absolute_deadline(*a);
+    sim_time db = absolute_deadline(*b);
+
+    if (da != db)
+    {
+        return (da < db) - (da > db);
+    }
+    return compare_pid(*a, *b);
+}
+
+int compare_rate(process *const *a, process *const *b)
+{
+    sim_time ta = ((*a)->task != NULL) ? (*a)->task->period : SIM_TIME_MAX;
+    sim_time tb = ((*b)->task != NULL) ? (*b)->task->period : SIM_TIME_MAX;
+
+    if (ta != tb)
+    {
+        return (ta < tb) - (ta > tb);
+    }
+    return compare_pid(*a, *b);
+}
+
+void report_periodic(process_vector *processes, priority_queue *queues, int nqueues, int ncpus,
+                     FILE *out)
+{
+    process_vector_iterator it;
+    periodic_task *task;
+    process *p;
+    long jobs = 0, misses = 0;
+    int i = 1;
+    int q, cpu;
+
+    for (it = process_vector_head(processes); it != 0 && (*it)->task == NULL;
+         it = process_vector_next(processes, it))
+    {
+    }
+    if (it == 0)
+    {
+        return;
+    }
+
+    fprintf(out, "\n=== TAREAS PERIODICAS ===\n");
+    fprintf(out, "%5s%15s%10s%10s%10s%10s%10s%12s%12s%12s\n", "#", "Tarea", "Periodo", "WCET",
+            "Plazo", "Trabajos", "Perdidos", "Atraso p50", "Atraso p99", "Atraso max");
+    fprintf(out, "-------------------------------------------------------------------------------"
+                 "---------------------------\n");
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        task = p->task;
+        if (task == NULL)
+        {
+            continue;
+        }
+        fprintf(out, "%5d%15s%10d%10d%10d%10ld%10ld", i++, process_name(p), task->period,
+                p->execution_time, task->deadline, task->completed, task->misses);
+        // El atraso de un trabajo es su tiempo de respuesta menos el plazo relativo
+        if (task->response->count > 0)
+        {
+            fprintf(out, "%12lld%12lld%12lld\n",
+                    hist_percentile(task->response, 50) - task->deadline,
+                    hist_percentile(task->response, 99) - task->deadline,
+                    task->response->max - task->deadline);
+        }
+        else
+        {
+            fprintf(out, "%12s%12s%12s\n", "-", "-", "-");
+        }
+        jobs += task->completed;
+        misses += task->misses;
+    }
+    fprintf(out, "Trabajos completados: %ld, plazos perdidos: %ld (%.2f%%)\n", jobs, misses,
+            (jobs > 0) ? 100.0 * misses / jobs : 0.0);
+
+    fprintf(out, "\nPrueba de utilizacion:\n");
+    for (q = 0; q < nqueues; q++)
+    {
+        if (queues[q].strategy != EDF && queues[q].strategy != RM)
+        {
+            continue;
+        }
+        for (cpu = 0; cpu < ncpus; cpu++)
+        {
+            print_utilization(processes, queues, q, cpu, ncpus, out);
+        }
+    }
+}
+
+static sim_time gcd_time(sim_time a, sim_time b)
+{
+    sim_time t;
+
+    while (b != 0)
+    {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static sim_time absolute_deadline(const process *p)
+{
+    return (p->task != NULL) ? p->arrival_time + p->task->deadline : SIM_TIME_MAX;
+}
+
+static int compare_pid(const process *a, const process *b)
+{
+    return (a->pid < b->pid) - (a->pid > b->pid);
+}
+
+static void print_utilization(process_vector *processes, priority_queue *queues, int queue,
+                              int cpu, int ncpus, FILE *out)
+{
+    process_vector_iterator it;
+    periodic_task *task;
+    double utilization = 0, density = 0, bound;
+    int implicit = 1;
+    int n = 0;
+    const char *verdict;
+
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        task = (*it)->task;
+        if (task == NULL || (*it)->priority != queue || (*it)->cpu != cpu)
+        {
+            continue;
+        }
+        n++;
+        utilization += (double)(*it)->execution_time / task->period;
+        density += (double)(*it)->execution_time /
+                   ((task->deadline < task->period) ? task->deadline : task->period);
+        implicit = implicit && task->deadline >= task->period;
+    }
+    if (n == 0)
+    {
+        return;
+    }
+
+    // EDF: densidad <= 1 basta; RM: cota de Liu y Layland con plazos implicitos
+    bound = (queues[queue].strategy == EDF) ? 1.0 : n * (pow(2.0, 1.0 / n) - 1);
+    if (utilization > 1.0)
+    {
+        verdict = "no planificable (U > 1)";
+    }
+    else if (queues[queue].strategy == EDF && density <= 1.0)
+    {
+        verdict = "planificable";
+    }
+    else if (queues[queue].strategy == RM && implicit && utilization <= bound)
+    {
+        verdict = "planificable";
+    }
+    else
+    {
+        verdict = "no concluyente";
+    }
+
+    fprintf(out, "Cola %d (%s)", queue + 1, strategy_name(queues[queue].strategy));
+    if (ncpus > 1)
+    {
+        fprintf(out, " CPU %d", cpu + 1);
+    }
+    fprintf(out, ": %d tareas, U = %.3f, densidad = %.3f, cota = %.3f -> %s\n", n, utilization,
+            density, bound, verdict);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file
+ * @brief Tareas periodicas y estrategias de tiempo real (EDF y RM).
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Una tarea periodica es un proceso cuyos trabajos se liberan cada periodo
+ * desde su fase, cada uno con execution_time (WCET) de CPU y un plazo
+ * relativo. Los trabajos no se materializan: el proceso guarda solo el
+ * trabajo actual (arrival_time es su liberacion y remaining_time lo que le
+ * falta) y la cantidad de trabajos completados, de modo que un hiperperiodo
+ * de millones de trabajos ocupa la misma memoria que un proceso. Al terminar
+ * un trabajo, el siguiente se libera de inmediato si ya paso su tiempo, o el
+ * proceso vuelve a la cola de llegada hasta su liberacion.
+ *
+ * En las colas EDF y RM la cola de listos es un monticulo (process_heap):
+ * EDF elige el plazo absoluto mas cercano y RM el periodo mas corto, y el
+ * trabajo en ejecucion se expropia cuando se libera uno de mayor prioridad.
+ * Los procesos que no son periodicos tienen plazo y periodo infinitos.
+ */
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include "sched.h"
+#include "stats.h"
+
+/** @brief Tarea periodica */
+typedef struct periodic_task
+{
+    sim_time phase;      /*!< Liberacion del primer trabajo */
+    sim_delta period;    /*!< Distancia entre liberaciones */
+    sim_delta deadline;  /*!< Plazo relativo a la liberacion */
+    long jobs;           /*!< Trabajos liberados antes del horizonte */
+    long completed;      /*!< Trabajos completados */
+    long misses;         /*!< Trabajos que terminaron despues de su plazo */
+    histogram *response; /*!< Tiempos de respuesta de los trabajos */
+} periodic_task;
+
+/**
+ * @brief Crea un proceso periodico.
+ * @param name Nombre de la tarea
+ * @param phase Liberacion del primer trabajo
+ * @param period Periodo (mayor que 0)
+ * @param wcet Tiempo de ejecucion de cada trabajo
+ * @param deadline Plazo relativo (mayor que 0)
+ * @return Nuevo proceso con su tarea (un solo trabajo hasta plan_periodic_jobs()).
+ */
+process *create_periodic_process(const char *name, sim_time phase, sim_delta period,
+                                 sim_delta wcet, sim_delta deadline);
+
+/**
+ * @brief Libera una tarea periodica.
+ * @param task Tarea, o NULL
+ */
+void destroy_periodic_task(periodic_task *task);
+
+/**
+ * @brief Reinicia la tarea de un proceso: vuelve al primer trabajo.
+ * @param p Proceso periodico
+ */
+void restart_periodic_task(process *p);
+
+/**
+ * @brief Fija la cantidad de trabajos de cada tarea periodica.
+ *
+ * Cada tarea libera los trabajos que comienzan antes del horizonte (al menos
+ * uno). Sin horizonte se usa la fase maxima mas el hiperperiodo (minimo
+ * comun multiplo de los periodos).
+ * @param processes Vector de procesos
+ * @param horizon Horizonte, o -1 = fase maxima + hiperperiodo
+ * @return Cantidad de tareas periodicas, o -1 si el hiperperiodo no cabe en sim_time.
+ */
+int plan_periodic_jobs(process_vector *processes, sim_time horizon);
+
+/**
+ * @brief Termina el trabajo actual de una tarea periodica.
+ *
+ * Registra su tiempo de respuesta y si perdio el plazo. Si quedan trabajos,
+ * pasa al siguiente: arrival_time queda en su liberacion y remaining_time en
+ * el WCET; si no, arrival_time vuelve a la fase.
+ * @param p Proceso periodico
+ * @param now Tiempo de finalizacion del trabajo
+ * @param out Salida de los mensajes de la simulacion, o NULL para no imprimirlos
+ * @return 1 si la tarea tiene mas trabajos, 0 si termino.
+ */
+int finish_job(process *p, sim_time now, FILE *out);
+
+/**
+ * @brief Compara dos procesos por plazo absoluto (EDF).
+ * @param a Proceso A (elemento de la cola)
+ * @param b Proceso B (elemento de la cola)
+ * @return Positivo si A va antes que B, negativo si va despues (desempate por PID).
+ */
+int compare_deadline(process *const *a, process *const *b);
+
+/**
+ * @brief Compara dos procesos por periodo (RM).
+ * @param a Proceso A (elemento de la cola)
+ * @param b Proceso B (elemento de la cola)
+ * @return Positivo si A va antes que B, negativo si va despues (desempate por PID).
+ */
+int compare_rate(process *const *a, process *const *b);
+
+/**
+ * @brief Imprime los plazos perdidos y los percentiles de atraso de cada
+ * tarea periodica, y la prueba de utilizacion de cada cola EDF o RM por CPU.
+ * No imprime nada si no hay tareas periodicas.
+ * @param processes Vector de procesos
+ * @param queues Colas de prioridad
+ * @param nqueues Cantidad de colas de prioridad
+ * @param ncpus Cantidad de CPUs
+ * @param out Salida
+ */
+void report_periodic(process_vector *processes, priority_queue *queues, int nqueues, int ncpus,
+                     FILE *out);
+
+#endif
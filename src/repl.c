@@ -0,0 +1,424 @@
+/**
+ * @file
+ * @brief Sesion interactiva: simular varias veces sin volver a leer la entrada.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "repl.h"
+#include "input.h"
+#include "checkpoint.h"
+#include "realtime.h"
+#include "stats.h"
+#include "sweep.h"
+#include "util.h"
+
+/** @brief Longitud maxima de una linea de comando */
+#define REPL_LINE 1024
+
+/** @brief Resultado de un comando */
+typedef enum
+{
+    REPL_CONTINUE, /*!< Seguir leyendo comandos */
+    REPL_QUIT,     /*!< Terminar la sesion o la conexion */
+    REPL_SHUTDOWN  /*!< Detener el servicio */
+} repl_result;
+
+/** @brief Estado de una sesion */
+typedef struct
+{
+    sched_context *ctx;        /*!< Procesos, colas y opciones de la sesion */
+    input_state in;            /*!< Lectura de DEFINE, PROCESS y PERIODIC sobre el contexto */
+    plot_options plot;         /*!< Opciones del diagrama */
+    simulation sim;            /*!< Ultima simulacion de una CPU */
+    int simulated;             /*!< 1 si sim tiene una simulacion */
+    int ran;                   /*!< 1 si las estadisticas son de la ultima simulacion */
+    int verbose;               /*!< 1 = mostrar los mensajes de la simulacion */
+    FILE *reply;               /*!< Salida de las respuestas (stdout o la conexion) */
+    FILE *initial_out;         /*!< Salida de los mensajes al iniciar la sesion */
+    FILE *initial_report;      /*!< Salida de los resultados al iniciar la sesion */
+    int initial_quiet;         /*!< opts->quiet al iniciar la sesion */
+} repl_session;
+
+/**
+ * @brief Ejecuta una linea de comando.
+ * @param s Sesion
+ * @param line Linea (se modifica)
+ * @return Accion a seguir.
+ */
+static repl_result repl_command(repl_session *s, char *line);
+
+/**
+ * @brief Vuelve a simular los procesos de la sesion e imprime un resumen.
+ * @param s Sesion
+ */
+static void repl_run(repl_session *s);
+
+/**
+ * @brief Descarta la ultima simulacion (los procesos o las colas cambiaron).
+ * @param s Sesion
+ */
+static void forget_run(repl_session *s);
+
+/**
+ * @brief Imprime las colas, las CPUs y la cantidad de procesos.
+ * @param s Sesion
+ */
+static void print_session(repl_session *s);
+
+/**
+ * @brief Imprime los comandos de la sesion.
+ * @param reply Salida de las respuestas
+ */
+static void print_commands(FILE *reply);
+
+/**
+ * @brief Atiende conexiones en un socket hasta SHUTDOWN.
+ * @param s Sesion
+ * @param address Direccion del socket
+ * @return 0 al terminar normalmente, 1 si no se pudo abrir el socket.
+ */
+static int serve(repl_session *s, char *address);
+
+/**
+ * @brief Obtiene el tiempo de un reloj monotono.
+ * @return Segundos.
+ */
+static double now_seconds(void);
+
+int run_repl(sched_context *ctx, const plot_options *plot_opts, char *address)
+{
+    repl_session s;
+    sched_options *opts = &ctx->opts;
+    char line[REPL_LINE];
+    int ret = 0;
+
+    memset(&s, 0, sizeof(s));
+    s.ctx = ctx;
+    init_input(&s.in, ctx->processes, opts);
+    s.in.queues = ctx->queues;
+    s.in.nqueues = ctx->nqueues;
+    s.in.queues_defined = 1;
+    s.in.next_pid = ctx->processes->count + 1;
+    s.plot = *plot_opts;
+    s.initial_out = opts->out;
+    s.initial_report = opts->report;
+    s.initial_quiet = opts->quiet;
+    s.reply = report_output(opts);
+    opts->stats = create_stats(ctx->nqueues);
+    opts->snapshots = create_snapshot_set(ctx->nqueues);
+
+    print_session(&s);
+    if (address != NULL)
+    {
+        ret = serve(&s, address);
+    }
+    else
+    {
+        fprintf(s.reply, "Sesion interactiva (HELP muestra los comandos)\n");
+        while (fgets(line, sizeof(line), stdin) && repl_command(&s, line) == REPL_CONTINUE)
+        {
+            fflush(s.reply);
+        }
+    }
+
+    forget_run(&s);
+    destroy_stats(opts->stats);
+    opts->stats = NULL;
+    destroy_snapshot_set(opts->snapshots);
+    opts->snapshots = NULL;
+    opts->out = s.initial_out;
+    opts->report = s.initial_report;
+    opts->quiet = s.initial_quiet;
+    return ret;
+}
+
+static repl_result repl_command(repl_session *s, char *line)
+{
+    char command[16] = "";
+    char arg[REPL_LINE] = "";
+    int ncpus, count;
+    sim_time horizon;
+
+    if (sscanf(line, "%15s %1023s", command, arg) < 1 || command[0] == '#')
+    {
+        return REPL_CONTINUE;
+    }
+    lcase(command);
+
+    if (equals(command, "run") || equals(command, "start"))
+    {
+        repl_run(s);
+    }
+    else if (equals(command, "report"))
+    {
+        if (s->simulated)
+        {
+            // La respuesta va a la conexion actual, no a la de RUN
+            s->sim.report = s->reply;
+            report_simulation(&s->sim);
+        }
+        else
+        {
+            fprintf(s->reply, "Error: no hay una simulacion de una CPU para reportar (use RUN)\n");
+        }
+    }
+    else if (equals(command, "stats"))
+    {
+        if (s->ran)
+        {
+            print_stats(s->ctx->opts.stats, s->reply);
+        }
+        else
+        {
+            fprintf(s->reply, "Error: no hay una simulacion (use RUN)\n");
+        }
+    }
+    else if (equals(command, "plot"))
+    {
+        s->plot.out = s->reply;
+        if (!s->ran)
+        {
+            fprintf(s->reply, "Error: no hay una simulacion (use RUN)\n");
+        }
+        else if (create_plot_async((arg[0] != '\0') ? arg : "gantt.plt", s->ctx->processes,
+                                   &s->plot) &&
+                 wait_plots() == 0)
+        {
+            fprintf(s->reply, "Diagrama de Gantt generado: %s\n",
+                    (arg[0] != '\0') ? arg : "gantt.plt");
+        }
+        else
+        {
+            fprintf(s->reply, "No se pudo generar el diagrama de Gantt\n");
+        }
+    }
+    else if (equals(command, "show"))
+    {
+        print_session(s);
+    }
+    else if (equals(command, "verbose"))
+    {
+        s->verbose = equals(lcase(arg), "on");
+        fprintf(s->reply, "Mensajes de la simulacion %s\n",
+                s->verbose ? "activados" : "desactivados");
+    }
+    else if (equals(command, "help"))
+    {
+        print_commands(s->reply);
+    }
+    else if (equals(command, "quit") || equals(command, "exit"))
+    {
+        return REPL_QUIT;
+    }
+    else if (equals(command, "shutdown"))
+    {
+        return REPL_SHUTDOWN;
+    }
+    else if (equals(command, "define") && equals(lcase(arg), "queues"))
+    {
+        // Los procesos ya tienen asignada su cola
+        fprintf(s->reply, "Error: la cantidad de colas no se puede cambiar en la sesion\n");
+    }
+    else
+    {
+        // DEFINE, PROCESS y PERIODIC: la siguiente simulacion usa los cambios
+        forget_run(s);
+        ncpus = s->ctx->opts.ncpus;
+        count = s->ctx->processes->count;
+        horizon = s->ctx->opts.horizon;
+        process_command(&s->in, line);
+        if (s->ctx->opts.ncpus != ncpus && s->ctx->opts.ncpus > 1)
+        {
+            fprintf(s->reply, "Con varias CPUs, RUN imprime el reporte completo\n");
+        }
+        // Solo los cambios de quantum o estrategia pueden reanudarse desde una instantanea
+        if (s->ctx->processes->count != count || s->ctx->opts.ncpus != ncpus ||
+            s->ctx->opts.horizon != horizon)
+        {
+            clear_snapshots(s->ctx->opts.snapshots);
+        }
+    }
+
+    return REPL_CONTINUE;
+}
+
+static void repl_run(repl_session *s)
+{
+    sched_options *opts = &s->ctx->opts;
+    process_vector_iterator it;
+    process *p;
+    long long total_waiting = 0;
+    int finished = 0;
+    double start = now_seconds();
+
+    forget_run(s);
+    if (plan_periodic_jobs(s->ctx->processes, opts->horizon) < 0)
+    {
+        fprintf(s->reply, "Error: el hiperperiodo de las tareas periodicas es demasiado grande "
+                          "(use DEFINE horizon)\n");
+        return;
+    }
+    stats_reset(opts->stats);
+    // Sin VERBOSE la simulacion no imprime mensajes (quiet)
+    opts->out = s->reply;
+    opts->report = s->reply;
+    opts->quiet = !s->verbose;
+
+    // Varias CPUs: las particiones imprimen su propio reporte
+    if (opts->ncpus > 1)
+    {
+        s->ran = schedule(s->ctx->processes, s->ctx->queues, s->ctx->nqueues, opts);
+        fprintf(s->reply, "RUN: %.2f ms\n", 1000 * (now_seconds() - start));
+        return;
+    }
+
+    if (!init_simulation(&s->sim, s->ctx->processes, s->ctx->queues, s->ctx->nqueues, opts))
+    {
+        return;
+    }
+    while (simulation_step(&s->sim))
+    {
+    }
+    s->simulated = 1;
+    s->ran = 1;
+
+    for (it = process_vector_head(s->ctx->processes); it != 0;
+         it = process_vector_next(s->ctx->processes, it))
+    {
+        p = *it;
+        if (p->state == FINISHED)
+        {
+            finished++;
+            total_waiting += p->waiting_time;
+        }
+    }
+    fprintf(s->reply, "RUN: T=%" PRIsim ", %d/%d procesos finalizados, espera media %.2f, "
+            "%ld asignaciones, %.2f ms",
+            s->sim.now, finished, s->ctx->processes->count,
+            (finished > 0) ? (double)total_waiting / finished : 0.0, s->sim.dispatches,
+            1000 * (now_seconds() - start));
+    if (opts->snapshots->resumed > 0)
+    {
+        fprintf(s->reply, " (reanudada desde T=%" PRIsim ", %ld asignaciones)",
+                opts->snapshots->resumed_at, opts->snapshots->resumed);
+    }
+    fprintf(s->reply, "\n");
+}
+
+static void forget_run(repl_session *s)
+{
+    if (s->simulated)
+    {
+        destroy_simulation(&s->sim);
+    }
+    s->simulated = 0;
+    s->ran = 0;
+}
+
+static void print_session(repl_session *s)
+{
+    int i;
+
+    fprintf(s->reply, "Procesos: %d, CPUs: %d\n", s->ctx->processes->count, s->ctx->opts.ncpus);
+    for (i = 0; i < s->ctx->nqueues; i++)
+    {
+        fprintf(s->reply, "Cola %d: %s", i + 1, strategy_name(s->ctx->queues[i].strategy));
+        if (s->ctx->queues[i].strategy == RR)
+        {
+            fprintf(s->reply, " (quantum %d)", s->ctx->queues[i].quantum);
+        }
+        fprintf(s->reply, "\n");
+    }
+}
+
+static void print_commands(FILE *reply)
+{
+    fprintf(reply, "Comandos:\n");
+    fprintf(reply,
+            "  DEFINE ..., PROCESS ..., PERIODIC ...  Como en la entrada (salvo DEFINE queues)\n");
+    fprintf(reply, "  RUN                  Simular de nuevo e imprimir un resumen\n");
+    fprintf(reply, "  REPORT               Reporte completo de la ultima simulacion\n");
+    fprintf(reply, "  STATS                Percentiles de latencia de la ultima simulacion\n");
+    fprintf(reply, "  PLOT [archivo]       Diagrama de Gantt de la ultima simulacion\n");
+    fprintf(reply, "  SHOW                 Colas, CPUs y cantidad de procesos\n");
+    fprintf(reply, "  VERBOSE on|off       Mostrar los mensajes de la simulacion en RUN\n");
+    fprintf(reply, "  QUIT                 Terminar la sesion (o la conexion)\n");
+    fprintf(reply, "  SHUTDOWN             Detener el servicio\n");
+}
+
+static int serve(repl_session *s, char *address)
+{
+    char line[REPL_LINE];
+    repl_result result = REPL_CONTINUE;
+    FILE *client, *reply;
+    int listen_fd, fd;
+
+    listen_fd = open_socket(address, 1);
+    if (listen_fd < 0)
+    {
+        fprintf(s->reply, "Error: no se pudo escuchar en %s\n", address);
+        return 1;
+    }
+    fprintf(s->reply, "Atendiendo comandos en %s (SHUTDOWN lo detiene)\n", address);
+    fflush(s->reply);
+
+    // Un cliente que se desconecta a mitad de una respuesta no detiene el servicio
+    signal(SIGPIPE, SIG_IGN);
+
+    while (result != REPL_SHUTDOWN && (fd = accept(listen_fd, NULL, NULL)) >= 0)
+    {
+        client = fdopen(fd, "r");
+        if (client == NULL)
+        {
+            close(fd);
+            continue;
+        }
+        reply = fdopen(dup(fd), "w");
+        if (reply == NULL)
+        {
+            fclose(client);
+            continue;
+        }
+
+        // Las respuestas, los reportes y los errores de los comandos van al
+        // cliente mientras dure la conexion; la salida estandar no cambia
+        s->reply = reply;
+        s->in.out = reply;
+        result = REPL_CONTINUE;
+        while (result == REPL_CONTINUE && fgets(line, sizeof(line), client))
+        {
+            result = repl_command(s, line);
+            fprintf(reply, ".\n");
+            fflush(reply);
+        }
+        s->ctx->opts.report = s->initial_report;
+        s->reply = report_output(&s->ctx->opts);
+        s->in.out = s->reply;
+        fclose(reply);
+        fclose(client);
+    }
+
+    close(listen_fd);
+    if (strncmp(address, "tcp:", 4) != 0)
+    {
+        unlink(address);
+    }
+    return 0;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
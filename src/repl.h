@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @brief Sesion interactiva: simular varias veces sin volver a leer la entrada.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * La sesion conserva el vector de procesos y las colas leidos al iniciar
+ * (entrada estandar hasta START y --import-sched) y acepta comandos, uno por
+ * linea, desde la entrada estandar o desde un socket Unix. Cada RUN vuelve a
+ * simular con prepare() y restart_process() sobre los mismos procesos, sin
+ * mensajes por asignacion, e imprime un resumen de una linea; los demas
+ * comandos consultan la ultima simulacion. Con una CPU, RUN reanuda desde la
+ * instantanea anterior a la primera asignacion de las colas cambiadas (ver
+ * checkpoint.h).
+ *
+ * Comandos:
+ * - DEFINE, PROCESS, PERIODIC: como en la entrada (salvo DEFINE queues).
+ * - RUN (o START): simular e imprimir el resumen.
+ * - REPORT: reporte completo de la ultima simulacion.
+ * - STATS: percentiles de latencia y throughput de la ultima simulacion.
+ * - PLOT [archivo]: diagrama de Gantt de la ultima simulacion (gantt.plt).
+ * - SHOW: colas, CPUs y cantidad de procesos.
+ * - VERBOSE on|off: mostrar los mensajes de la simulacion en RUN.
+ * - HELP, QUIT (terminar la sesion o la conexion), SHUTDOWN (detener el servicio).
+ *
+ * En el socket, cada respuesta termina con una linea "." para que un cliente
+ * sepa cuando dejar de leer. Se atiende una conexion a la vez.
+ */
+#ifndef REPL_H
+#define REPL_H
+
+#include "context.h"
+#include "plot.h"
+
+/**
+ * @brief Ejecuta una sesion interactiva.
+ * @param ctx Contexto con los procesos, las colas y las opciones (la sesion puede agregar procesos)
+ * @param plot_opts Opciones del diagrama de Gantt
+ * @param address Socket Unix (o tcp:puerto) donde atender, o NULL = entrada estandar
+ * @return 0 al terminar normalmente, 1 si no se pudo abrir el socket.
+ */
+int run_repl(sched_context *ctx, const plot_options *plot_opts, char *address);
+
+#endif
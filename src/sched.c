@@ -7,200 +7,1419 @@
 
 #include <math.h>
 #include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "sched.h"
+#include "kernels.h"
+#include "seqlog.h"
+#include "checkpoint.h"
+#include "partition.h"
+#include "realtime.h"
+#include "stream.h"
+#include "util.h"
+
+/** @brief Estado para imprimir la secuencia de ejecucion */
+typedef struct
+{
+    const char **names; /*!< Nombres de los procesos indexados por PID */
+    int max_pid;        /*!< PID maximo */
+    int first;          /*!< 1 = aun no se ha impreso ningun elemento */
+    FILE *report;       /*!< Salida */
+} sequence_printer;
+
+/**
+ * @brief Imprime un grupo de registros de la secuencia de ejecucion.
+ * @param records Registros (un registro o una serie de rondas Round Robin)
+ * @param count Cantidad de registros
+ * @param arg Estado de impresion (sequence_printer *)
+ */
+static void print_sequence_group(const seq_record *records, int count, void *arg);
+
+/**
+ * @brief Obtiene el nombre de un proceso para imprimir la secuencia (seqlog_namer).
+ * @param pid PID del proceso
+ * @param arg Estado de impresion (sequence_printer *)
+ * @return Nombre del proceso, o "?" si no se conoce.
+ */
+static const char *sequence_name(int pid, void *arg);
+
+/**
+ * @brief Cuenta los quantums que un proceso RR puede ejecutar sin ser expropiado.
+ *
+ * Sin otros procesos listos, el proceso solo deja la CPU cuando llega otro
+ * proceso, cuando termina o al alcanzar el limite de la asignacion. Solo se
+ * cuentan quantums completos; el ultimo quantum parcial se asigna aparte.
+ * @param sim Simulacion
+ * @param p Proceso en ejecucion (sin otros procesos listos)
+ * @param quantum Quantum de su cola
+ * @param limit Tiempo limite (exclusivo) para iniciar una asignacion
+ * @return Cantidad de quantums consecutivos (al menos 1).
+ */
+static int uncontended_quantums(simulation *sim, process *p, sim_delta quantum, sim_time limit);
+
+/**
+ * @brief Ejecuta de una vez varias rondas Round Robin completas de una cola.
+ *
+ * Si ningun proceso de la cola termina y nadie llega antes del fin de las
+ * rondas, el orden de la cola se repite: cada proceso recibe un quantum por
+ * ronda y espera los quantums de los demas. Los tiempos se actualizan
+ * aritmeticamente y se agregan slices y registros periodicos.
+ * @param sim Simulacion
+ * @param queue Cola Round Robin de mayor prioridad con procesos listos
+ * @param limit Tiempo limite (exclusivo) para iniciar una asignacion
+ * @return 1 si se ejecutaron al menos dos rondas, 0 si no convenia.
+ */
+static int run_rr_rounds(simulation *sim, int queue, sim_time limit);
+
+/**
+ * @brief Ejecuta el trabajo de mayor prioridad de una cola EDF o RM.
+ *
+ * El trabajo corre hasta terminar, hasta que se hace listo uno que lo
+ * expropia (de mayor prioridad en su cola, o cualquiera en una cola de
+ * mayor prioridad) o hasta el limite, en una sola asignacion.
+ * @param sim Simulacion
+ * @param queue Cola EDF o RM de mayor prioridad con procesos listos
+ * @param limit Tiempo limite (exclusivo) de la asignacion
+ */
+static void run_realtime(simulation *sim, int queue, sim_time limit);
+
+/**
+ * @brief Indica si un proceso en ejecucion en una cola EDF o RM debe dejar la CPU.
+ * @param sim Simulacion
+ * @param queue Cola del proceso
+ * @param p Proceso en ejecucion (fuera de la cola de listos)
+ * @return 1 si hay un proceso listo de mayor prioridad, 0 en caso contrario.
+ */
+static int realtime_preempted(simulation *sim, int queue, process *p);
+
+/**
+ * @brief Obtiene la funcion de orden de la cola de listos de una cola EDF o RM.
+ * @param queue Cola de prioridad
+ * @return compare_deadline() o compare_rate().
+ */
+static int (*ready_order(const priority_queue *queue))(process *const *, process *const *);
+
+/**
+ * @brief Procesa el fin de la rafaga de un proceso que acaba de ejecutarse.
+ *
+ * Un proceso normal finaliza. Una tarea periodica finaliza solo despues de
+ * su ultimo trabajo; si no, vuelve a la cola de listos (su siguiente trabajo
+ * ya fue liberado) o a la cola de llegada.
+ * @param sim Simulacion
+ * @param queue Cola del proceso
+ * @param p Proceso con remaining_time = 0
+ */
+static void complete_process(simulation *sim, int queue, process *p);
+
+/**
+ * @brief Registra la primera asignacion de CPU de un proceso medido (first_run_time).
+ * @param sim Simulacion
+ * @param queue Cola del proceso
+ * @param p Proceso
+ */
+static void record_response(simulation *sim, int queue, process *p);
+
+/**
+ * @brief Registra la finalizacion de un proceso (o trabajo) medido en el
+ * tiempo actual, y marca la simulacion como convergida si el intervalo de
+ * confianza de la espera media alcanzo el ancho objetivo.
+ * @param sim Simulacion
+ * @param queue Cola del proceso
+ * @param p Proceso
+ * @param waiting Espera del proceso (o del trabajo)
+ */
+static void record_finish(simulation *sim, int queue, process *p, sim_time waiting);
+
+/**
+ * @brief Quita de las colas de llegada los procesos que no se simulan: los
+ * que llegan despues de la ventana de medicion o fuera de las ventanas de
+ * muestreo.
+ * @param sim Simulacion recien preparada
+ * @return Cantidad de procesos quitados.
+ */
+static int sample_arrivals(simulation *sim);
+
+/**
+ * @brief Imprime la ventana de medicion, el muestreo y la espera media con
+ * su intervalo de confianza por medias por lotes.
+ * @param sim Simulacion terminada
+ */
+static void report_measurement(simulation *sim);
+
+/**
+ * @brief Procesa las llegadas hasta el tiempo actual.
+ *
+ * En el modo de memoria acotada, primero pasa a las colas de llegada los
+ * procesos leidos que llegan hasta el tiempo actual.
+ * @param sim Simulacion
+ * @return Cantidad de procesos que se pasaron a estado de listo
+ */
+static int admit_arrivals(simulation *sim);
+
+/**
+ * @brief Obtiene el tiempo de la siguiente llegada a las primeras colas.
+ *
+ * En el modo de memoria acotada lee procesos hasta que el siguiente por leer
+ * no llega antes que los de las colas de llegada (o llega despues de until).
+ * @param sim Simulacion
+ * @param nqueues Cantidad de colas a considerar (las de mayor prioridad)
+ * @param until Llegadas posteriores que no interesan
+ * @return Tiempo de la siguiente llegada, o -1 si no hay llegadas.
+ */
+static sim_time next_arrival(simulation *sim, int nqueues, sim_time until);
+
+/**
+ * @brief Pasa el siguiente proceso leido a la cola de llegada de su prioridad.
+ * @param sim Simulacion en modo de memoria acotada
+ */
+static void admit_streamed(simulation *sim);
+
+/**
+ * @brief Asigna la CPU a una cola con cualquier estrategia (ciclo generico).
+ *
+ * Consulta la estrategia de la cola, opts->quiet y opts->wait_slices en cada
+ * asignacion.
+ * @param sim Simulacion
+ * @param cola_actual Cola de mayor prioridad con procesos listos
+ * @param limit Tiempo limite (exclusivo) para iniciar una asignacion
+ * @return 1 (siempre asigna la CPU).
+ */
+static int dispatch_generic(simulation *sim, int cola_actual, sim_time limit);
+
+/**
+ * @brief Elige el ciclo de asignacion de una simulacion.
+ * @param sim Simulacion con sus colas y opciones
+ * @return Ciclo especializado si todas las colas son FIFO o todas Round Robin
+ *         (y opts->specialize), dispatch_generic() en caso contrario.
+ */
+static dispatch_fn select_dispatch(const simulation *sim);
+
+/**
+ * @brief Imprime el mensaje de una asignacion.
+ * @param sim Simulacion
+ * @param queue Cola del proceso
+ * @param p Proceso asignado (antes de descontar el tiempo asignado)
+ * @param quantums Quantums consecutivos asignados
+ */
+static void print_dispatch(simulation *sim, int queue, process *p, int quantums);
+
+/**
+ * @brief Acumula la espera de un proceso hasta un tiempo, con sus slices de
+ * espera solo si opts->wait_slices.
+ * @param sim Simulacion
+ * @param p Proceso
+ * @param now Tiempo en que deja de esperar
+ */
+static void accrue(simulation *sim, process *p, sim_time now);
+
+/**
+ * @brief Acumula la espera de un proceso sin registrar slices de espera.
+ * @param p Proceso
+ * @param now Tiempo en que deja de esperar
+ */
+static void accrue_waiting_time(process *p, sim_time now);
+
+/**
+ * @brief Define un ciclo de asignacion para colas de una sola estrategia.
+ *
+ * Equivale a dispatch_generic() con todas las colas FIFO (IS_RR = 0) o Round
+ * Robin (IS_RR = 1). La estrategia y las opciones son constantes: las ramas
+ * de la otra estrategia, los mensajes y las slices de espera que no se usan
+ * no se generan, aun sin optimizaciones, y el quantum se lee una vez.
+ * @param name Nombre de la funcion (dispatch_fn)
+ * @param IS_RR 1 = Round Robin, 0 = FIFO
+ * @param VERBOSE 1 = imprimir cada asignacion (!opts->quiet)
+ * @param WAITS 1 = registrar las slices de espera (opts->wait_slices)
+ */
+#define DEFINE_DISPATCH(name, IS_RR, VERBOSE, WAITS)                                      \
+    static int name(simulation *sim, int queue, sim_time limit)                          \
+    {                                                                                    \
+        priority_queue *q = &sim->queues[queue];                                         \
+        sim_delta quantum = q->quantum;                                                  \
+        sim_delta assigned, total;                                                       \
+        int quantums = 1;                                                                \
+        process *p;                                                                      \
+                                                                                         \
+        if (IS_RR && q->ready->count > 1 && run_rr_rounds(sim, queue, limit))            \
+        {                                                                                \
+            return 1;                                                                    \
+        }                                                                                \
+                                                                                         \
+        p = process_deque_pop_front(q->ready);                                           \
+        if (WAITS)                                                                       \
+        {                                                                                \
+            accrue_waiting(p, sim->now);                                                 \
+        }                                                                                \
+        else                                                                             \
+        {                                                                                \
+            accrue_waiting_time(p, sim->now);                                            \
+        }                                                                                \
+        p->state = RUNNING;                                                              \
+        if (p->first_run_time < 0)                                                       \
+        {                                                                                \
+            p->first_run_time = sim->now;                                                \
+            record_response(sim, queue, p);                                              \
+        }                                                                                \
+                                                                                         \
+        /* FIFO: todo el tiempo restante; RR: un quantum, o varios sin competencia */    \
+        assigned = p->remaining_time;                                                    \
+        if (IS_RR)                                                                       \
+        {                                                                                \
+            assigned = min(quantum, p->remaining_time);                                  \
+            if (get_ready_count(sim->queues, sim->nqueues) == 0)                         \
+            {                                                                            \
+                quantums = uncontended_quantums(sim, p, quantum, limit);                 \
+            }                                                                            \
+        }                                                                                \
+        total = assigned * quantums;                                                     \
+                                                                                         \
+        p->context_switches += quantums;                                                 \
+        if (VERBOSE)                                                                     \
+        {                                                                                \
+            print_dispatch(sim, queue, p, quantums);                                     \
+        }                                                                                \
+        p->cpu_time += total;                                                            \
+        p->remaining_time -= total;                                                      \
+        slice_vector_push_back(&p->slices, create_slice(CPU, sim->now, sim->now + total)); \
+        if (sim->sequence != NULL)                                                       \
+        {                                                                                \
+            seqlog_append_run(sim->sequence, p->pid, sim->now, assigned, quantums);      \
+        }                                                                                \
+        sim->dispatches += quantums;                                                     \
+        sim->now += total;                                                               \
+        admit_arrivals(sim);                                                             \
+                                                                                         \
+        if (p->remaining_time <= 0)                                                      \
+        {                                                                                \
+            complete_process(sim, queue, p);                                             \
+        }                                                                                \
+        else                                                                             \
+        {                                                                                \
+            p->state = READY;                                                            \
+            p->ready_since = sim->now;                                                   \
+            if (IS_RR)                                                                   \
+            {                                                                            \
+                process_deque_push_back(q->ready, p);                                    \
+            }                                                                            \
+            else                                                                         \
+            {                                                                            \
+                process_deque_push_front(q->ready, p);                                   \
+            }                                                                            \
+        }                                                                                \
+        return 1;                                                                        \
+    }
+
+void init_sched_options(sched_options *opts)
+{
+    opts->seq_log_path = NULL;
+    opts->seq_mem_cap = SEQLOG_DEFAULT_MEM_CAP;
+    opts->stats_path = NULL;
+    opts->stats = NULL;
+    opts->checkpoint_path = NULL;
+    opts->checkpoint_every = CHECKPOINT_DEFAULT_EVERY;
+    opts->resume_path = NULL;
+    opts->ncpus = 1;
+    opts->migration = 0;
+    opts->threads = 0;
+    opts->start_time = -1;
+    opts->horizon = -1;
+    opts->warmup = 0;
+    opts->measure_end = -1;
+    opts->sample_every = 1;
+    opts->sample_window = 1;
+    opts->ci_width = 0;
+    opts->batch_size = BATCH_DEFAULT_SIZE;
+    opts->out = NULL;
+    opts->report = NULL;
+    opts->snapshots = NULL;
+    opts->stream = NULL;
+    opts->quiet = 0;
+    opts->wait_slices = 1;
+    opts->specialize = 1;
+}
+
+FILE *report_output(const sched_options *opts)
+{
+    return (opts->report != NULL) ? opts->report : stdout;
+}
+
+int process_measured(const sched_options *opts, const process *p)
+{
+    return p->arrival_time >= opts->warmup &&
+           (opts->measure_end < 0 || p->arrival_time < opts->measure_end);
+}
+
+int process_reported(const sched_options *opts, const process *p)
+{
+    return p->finished_time >= 0 && process_measured(opts, p);
+}
+
+/* Rutina para la planificacion - Simplificada solo para FIFO y RR */
+int schedule(process_vector *processes, priority_queue *queues, int nqueues,
+             const sched_options *opts)
+{
+    simulation sim;
+    sched_options default_opts;
+    checkpoint_writer *writer = NULL;
+    long next_checkpoint;
+
+    if (opts == NULL)
+    {
+        init_sched_options(&default_opts);
+        opts = &default_opts;
+    }
+
+    // Varias CPUs: cada una es una particion independiente
+    if (opts->ncpus > 1)
+    {
+        return schedule_partitions(processes, queues, nqueues, opts);
+    }
+
+    if (!init_simulation(&sim, processes, queues, nqueues, opts))
+    {
+        return 0;
+    }
+
+    if (opts->checkpoint_path != NULL && opts->checkpoint_every > 0)
+    {
+        writer = create_checkpoint_writer(opts->checkpoint_path);
+    }
+
+    // Algoritmo principal de planificacion
+    next_checkpoint = sim.dispatches - sim.dispatches % opts->checkpoint_every +
+                      opts->checkpoint_every;
+    while (simulation_step(&sim))
+    {
+        // Guardar un punto de control cada checkpoint_every asignaciones
+        // (una asignacion puede agrupar varios quantums)
+        if (writer != NULL && sim.dispatches >= next_checkpoint)
+        {
+            checkpoint_async(writer, &sim);
+            next_checkpoint = sim.dispatches - sim.dispatches % opts->checkpoint_every +
+                              opts->checkpoint_every;
+        }
+    }
+
+    if (writer != NULL && destroy_checkpoint_writer(writer) > 0)
+    {
+        fprintf(sim.report, "Error: no se pudo guardar el punto de control %s\n",
+                opts->checkpoint_path);
+    }
+
+    report_simulation(&sim);
+    destroy_simulation(&sim);
+
+    return 1;
+}
+
+int init_simulation(simulation *sim, process_vector *processes, priority_queue *queues,
+                    int nqueues, const sched_options *opts)
+{
+    process_vector_iterator it;
+    process *p;
+    char *seq_path;
+    int periodic = 0;
+    int i;
+
+    // El punto de control no guarda las medias por lotes
+    if ((opts->checkpoint_path != NULL || opts->resume_path != NULL) && opts->ci_width > 0)
+    {
+        fprintf(report_output(opts), "Error: los puntos de control no estan soportados con la "
+                                     "parada por intervalo de confianza\n");
+        return 0;
+    }
+
+    // El punto de control no guarda el estado de los trabajos periodicos
+    if (opts->checkpoint_path != NULL || opts->resume_path != NULL || opts->snapshots != NULL)
+    {
+        for (it = process_vector_head(processes); it != 0 && !periodic;
+             it = process_vector_next(processes, it))
+        {
+            periodic = ((*it)->task != NULL);
+        }
+    }
+    if (periodic && (opts->checkpoint_path != NULL || opts->resume_path != NULL))
+    {
+        fprintf(report_output(opts),
+                "Error: los puntos de control no estan soportados con tareas periodicas\n");
+        return 0;
+    }
+
+    memset(sim, 0, sizeof(simulation));
+    sim->processes = processes;
+    sim->queues = queues;
+    sim->nqueues = nqueues;
+    sim->opts = opts;
+    sim->out = (opts->out != NULL) ? opts->out : stdout;
+    sim->report = report_output(opts);
+    sim->remaining = processes->count;
+    sim->dispatch = select_dispatch(sim);
+    // Las instantaneas son puntos de control: mismas restricciones
+    sim->snapshots = (periodic || opts->ci_width > 0 || opts->checkpoint_path != NULL ||
+                      opts->resume_path != NULL)
+                         ? NULL
+                         : opts->snapshots;
+    if (sim->snapshots == NULL && opts->snapshots != NULL)
+    {
+        clear_snapshots(opts->snapshots);
+    }
+    // Modo de memoria acotada: el siguiente proceso por leer cuenta como pendiente
+    sim->stream = opts->stream;
+    if (sim->stream != NULL && peek_process(sim->stream) != NULL)
+    {
+        sim->remaining++;
+    }
+
+    // Tablas de procesos por posicion y por PID
+    sim->nprocesses = processes->count;
+    sim->table = (process **)malloc(sizeof(process *) * (processes->count + 1));
+    i = 0;
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        sim->table[i++] = p;
+        sim->max_pid = (p->pid > sim->max_pid) ? p->pid : sim->max_pid;
+    }
+    sim->by_pid = (process **)calloc(sim->max_pid + 1, sizeof(process *));
+    for (i = 0; i < sim->nprocesses; i++)
+    {
+        if (sim->table[i]->pid >= 0)
+        {
+            sim->by_pid[sim->table[i]->pid] = sim->table[i];
+        }
+    }
+
+    sim->stats = (opts->stats != NULL) ? opts->stats : create_stats(nqueues);
+
+    // Sin mensajes (quiet) solo se imprimen los errores, en el reporte
+    if (!opts->quiet)
+    {
+        fprintf(sim->out, "=== INICIANDO SIMULACION ===\n");
+        fprintf(sim->out, "Procesos a simular: %d\n", sim->remaining);
+        fprintf(sim->out, "Colas de prioridad: %d\n", nqueues);
+    }
+
+    // IMPORTANTE: Preparar las colas antes de empezar
+    prepare(processes, queues, nqueues, opts->quiet ? NULL : sim->out, sim->report);
+    batch_reset(&sim->batches, opts->batch_size);
+    if (opts->measure_end >= 0 || opts->sample_every > 1)
+    {
+        sim->sampled_out = sample_arrivals(sim);
+        sim->remaining -= sim->sampled_out;
+        if (!opts->quiet)
+        {
+            fprintf(sim->out, "Procesos fuera de las ventanas simuladas: %d\n", sim->sampled_out);
+        }
+    }
+
+    // Volver a simular desde la instantanea anterior a la primera decision que cambio
+    if (sim->snapshots != NULL)
+    {
+        i = resume_snapshot(sim->snapshots, sim);
+        if (i > 0)
+        {
+            if (!opts->quiet)
+            {
+                fprintf(sim->out, "Reanudando desde una instantanea (T=%" PRIsim ", %ld asignaciones, %d procesos restantes)\n",
+                        sim->now, sim->dispatches, sim->remaining);
+            }
+            return 1;
+        }
+        if (i < 0)
+        {
+            // Restauracion a medias: preparar de nuevo sin instantaneas
+            destroy_simulation(sim);
+            return init_simulation(sim, processes, queues, nqueues, opts);
+        }
+    }
+
+    if (opts->resume_path != NULL)
+    {
+        // Continuar desde el punto de control (incluye la secuencia)
+        if (!load_checkpoint(sim, opts->resume_path))
+        {
+            fprintf(sim->report, "Error: no se pudo reanudar desde %s\n", opts->resume_path);
+            destroy_simulation(sim);
+            return 0;
+        }
+        if (!opts->quiet)
+        {
+            fprintf(sim->out, "Reanudando desde %s (T=%" PRIsim ", %ld asignaciones, %d procesos restantes)\n",
+                    opts->resume_path, sim->now, sim->dispatches, sim->remaining);
+        }
+        return 1;
+    }
+
+    // Con puntos de control la secuencia debe ser persistente para poder reanudarla
+    // (en el modo de memoria acotada no se registra: crece con la simulacion)
+    seq_path = opts->seq_log_path;
+    if (seq_path == NULL && opts->checkpoint_path != NULL)
+    {
+        seq_path = concat(opts->checkpoint_path, ".seq");
+    }
+    if (sim->stream == NULL)
+    {
+        sim->sequence = create_seqlog(seq_path, opts->seq_mem_cap);
+        if (sim->sequence == NULL)
+        {
+            fprintf(sim->report, "Error: no se pudo crear el registro de secuencia %s\n", seq_path);
+            sim->sequence = create_seqlog(NULL, opts->seq_mem_cap);
+        }
+    }
+    if (seq_path != opts->seq_log_path)
+    {
+        free(seq_path);
+    }
+
+    // Obtener el tiempo minimo de llegada
+    sim->now = next_arrival(sim, nqueues, SIM_TIME_MAX);
+    if (sim->now == -1)
+        sim->now = 0;
+    if (opts->start_time >= 0 && opts->start_time < sim->now)
+        sim->now = opts->start_time;
+
+    if (!opts->quiet)
+    {
+        fprintf(sim->out, "Tiempo inicial: %" PRIsim "\n", sim->now);
+    }
+
+    // Procesar llegadas iniciales
+    admit_arrivals(sim);
+
+    return 1;
+}
+
+int simulation_step(simulation *sim)
+{
+    if (simulation_step_before(sim, SIM_TIME_MAX) && sim->remaining > 0 && !sim->converged)
+    {
+        return 1;
+    }
+    if (sim->snapshots != NULL)
+    {
+        take_snapshot(sim->snapshots, sim, sim->nqueues);
+    }
+    return 0;
+}
+
+int simulation_step_before(simulation *sim, sim_time limit)
+{
+    priority_queue *queues = sim->queues;
+    int nqueues = sim->nqueues;
+    int cola_actual = 0;
+    sim_time siguiente_llegada = 0;
+    int i;
+
+    while (sim->remaining > 0)
+    {
+        // Buscar la cola de mayor prioridad que tenga procesos listos
+        int cola_encontrada = 0;
+
+        /*  recorrer desde 0 (máxima prioridad) hasta nqueues-1
+           para escoger la primera cola no vacía. */
+        for (i = 0; i < nqueues; i++)
+        {
+            if (!process_deque_empty(queues[i].ready))
+            {
+                cola_actual = i; // Siempre la de mayor prioridad
+                cola_encontrada = 1;
+                break;
+            }
+        }
+
+        if (cola_encontrada)
+        {
+            break;
+        }
+
+        // No hay procesos listos, avanzar al siguiente evento de llegada
+        siguiente_llegada = next_arrival(sim, nqueues, SIM_TIME_MAX);
+        if (siguiente_llegada == -1 || siguiente_llegada >= limit)
+        {
+            // No hay mas llegadas antes del limite
+            return 0;
+        }
+        sim->now = siguiente_llegada;
+        admit_arrivals(sim);
+    }
+
+    if (sim->remaining <= 0 || sim->now >= limit)
+    {
+        return 0;
+    }
+
+    // Hasta aqui la configuracion de la cola no influyo en ninguna decision
+    if (sim->snapshots != NULL)
+    {
+        take_snapshot(sim->snapshots, sim, cola_actual);
+    }
+
+    // Ciclo elegido al iniciar: especializado o generico
+    return sim->dispatch(sim, cola_actual, limit);
+}
+
+void report_simulation(simulation *sim)
+{
+    FILE *report = sim->report;
+    process_vector *processes = sim->processes;
+    const sched_options *opts = sim->opts;
+    process_vector_iterator it;
+    process *p;
+    time_summary waiting;
+    sim_time *column;
+    int excluded = 0;
+    int i, n;
+
+    // IMPRIMIR RESULTADOS DE LA SIMULACION
+    fprintf(report, "\n=== RESULTADOS DE LA SIMULACION ===\n");
+    fprintf(report, "Colas de prioridad: %d\n", sim->nqueues);
+    fprintf(report, "Tiempo total de la simulacion: %" PRIsim " unidades de tiempo\n", sim->now);
+
+    // Modo de memoria acotada: los procesos finalizados ya no estan en memoria
+    if (sim->stream != NULL)
+    {
+        report_stream(sim->stream, report);
+    }
+    else
+    {
+        // Calcular tiempo promedio de espera de los procesos reportados (columna
+        // de esperas reducida con SIMD)
+        double tiempo_promedio_espera = 0;
+        column = (sim_time *)malloc(sizeof(sim_time) * (processes->count + 1));
+        n = 0;
+        for (it = process_vector_head(processes); it != 0;
+             it = process_vector_next(processes, it))
+        {
+            if (process_reported(sim->opts, *it))
+            {
+                column[n++] = (*it)->waiting_time;
+            }
+        }
+        time_column_reduce(column, n, &waiting);
+        free(column);
+        tiempo_promedio_espera = (n > 0) ? (double)waiting.sum / n : 0.0;
+        fprintf(report, "Tiempo promedio de espera: %.2f unidades de tiempo\n",
+                tiempo_promedio_espera);
+
+        // TABLA DE PROCESOS
+        // Las columnas de tiempo caben un sim_time de 64 bits
+        fprintf(report, "\n%5s%15s%21s%10s%21s%21s\n",
+                "#", "Proceso", "T. Llegada", "Tamaño", "T. Espera", "T. Finalizacion");
+        fprintf(report, "----------------------------------------------------------------------"
+                        "-----------------------\n");
+
+        // La numeracion sigue la entrada: los procesos excluidos dejan un hueco
+        i = 0;
+        for (it = process_vector_head(processes); it != 0;
+             it = process_vector_next(processes, it))
+        {
+            p = *it;
+            i++;
+            if (!process_reported(sim->opts, p))
+            {
+                excluded++;
+                continue;
+            }
+            fprintf(report, "%5d%15s%21" PRIsim "%10d%21" PRIsim "%21" PRIsim "\n",
+                    i, process_name(p), p->arrival_time, p->execution_time,
+                    p->waiting_time, p->finished_time);
+        }
+        if (excluded > 0)
+        {
+            fprintf(report, "Procesos excluidos de la tabla y del promedio (calentamiento, fuera "
+                    "de la medicion o sin finalizar): %d\n", excluded);
+        }
+
+        // PLAZOS DE LAS TAREAS PERIODICAS
+        report_periodic(processes, sim->queues, sim->nqueues, 1, report);
+    }
+
+    // VENTANA DE MEDICION (estado estacionario)
+    if (opts->warmup > 0 || opts->measure_end >= 0 || opts->sample_every > 1 || opts->ci_width > 0)
+    {
+        report_measurement(sim);
+    }
+
+    // PERCENTILES DE LATENCIA Y THROUGHPUT
+    print_stats(sim->stats, report);
+    if (opts->stats_path != NULL)
+    {
+        FILE *stats_file = fopen(opts->stats_path, "wb");
+        if (stats_file == NULL || !write_stats(sim->stats, stats_file))
+        {
+            fprintf(report, "Error: no se pudieron guardar las estadisticas en %s\n",
+                    opts->stats_path);
+        }
+        if (stats_file != NULL)
+        {
+            fclose(stats_file);
+        }
+    }
+
+    // SECUENCIA DE EJECUCION (no se registra en el modo de memoria acotada)
+    if (sim->sequence == NULL)
+    {
+        return;
+    }
+
+    // Guardar la tabla de nombres en el registro persistente
+    if (sim->sequence->path != NULL)
+    {
+        int *pids = (int *)malloc(sizeof(int) * (sim->nprocesses + 1));
+        const char **names = (const char **)malloc(sizeof(char *) * (sim->nprocesses + 1));
+        for (i = 0; i < sim->nprocesses; i++)
+        {
+            pids[i] = sim->table[i]->pid;
+            names[i] = process_name(sim->table[i]);
+        }
+        if (seqlog_finish(sim->sequence, pids, names, i))
+        {
+            fprintf(report, "\nSecuencia guardada en %s (%ld asignaciones, %ld registros)\n",
+                    sim->sequence->path, sim->sequence->dispatches, sim->sequence->spilled);
+        }
+        free(pids);
+        free(names);
+    }
+
+    fprintf(report, "\nSecuencia de ejecucion:\n");
+    print_sequence(sim->sequence, sim->by_pid, sim->max_pid, report);
+    fprintf(report, "\n");
+}
+
+void print_sequence(seqlog *sequence, process **by_pid, int max_pid, FILE *report)
+{
+    sequence_printer printer;
+    seq_grouper grouper;
+    int i;
+
+    printer.max_pid = max_pid;
+    printer.names = (const char **)calloc(printer.max_pid + 1, sizeof(char *));
+    for (i = 0; i <= max_pid; i++)
+    {
+        if (by_pid[i] != NULL)
+        {
+            printer.names[i] = process_name(by_pid[i]);
+        }
+    }
+    printer.first = 1;
+    printer.report = report;
+
+    init_seq_grouper(&grouper, print_sequence_group, &printer);
+    seqlog_foreach(sequence, seq_grouper_visit, &grouper);
+    finish_seq_grouper(&grouper);
+
+    free(printer.names);
+}
+
+void destroy_simulation(simulation *sim)
+{
+    if (sim->stats != NULL && sim->stats != sim->opts->stats)
+    {
+        destroy_stats(sim->stats);
+    }
+    destroy_seqlog(sim->sequence);
+    free(sim->table);
+    free(sim->by_pid);
+    memset(sim, 0, sizeof(simulation));
+}
+
+static int dispatch_generic(simulation *sim, int cola_actual, sim_time limit)
+{
+    priority_queue *queues = sim->queues;
+    int nqueues = sim->nqueues;
+    process *proceso_actual = NULL;
+    sim_delta tiempo_asignado = 0;
+    sim_delta tiempo_total = 0;
+    int quantums = 1;
+
+    // Colas de tiempo real: el trabajo de mayor prioridad corre hasta ser expropiado
+    if (queues[cola_actual].strategy == EDF || queues[cola_actual].strategy == RM)
+    {
+        run_realtime(sim, cola_actual, limit);
+        return 1;
+    }
+
+    // Varios procesos en una cola Round Robin: ejecutar rondas completas de una vez
+    if (queues[cola_actual].strategy == RR && queues[cola_actual].ready->count > 1 &&
+        run_rr_rounds(sim, cola_actual, limit))
+    {
+        return 1;
+    }
+
+    // Obtener el primer proceso de la cola (FIFO simple)
+    proceso_actual = process_deque_pop_front(queues[cola_actual].ready);
+
+    // Contar la espera desde que el proceso quedo listo
+    accrue(sim, proceso_actual, sim->now);
+
+    // Cambiar estado del proceso a RUNNING
+    proceso_actual->state = RUNNING;
+    if (proceso_actual->first_run_time < 0)
+    {
+        proceso_actual->first_run_time = sim->now;
+        record_response(sim, cola_actual, proceso_actual);
+    }
+
+    // Calcular tiempo a asignar
+    if (queues[cola_actual].strategy == RR)
+    {
+        // Round Robin: usar quantum
+        tiempo_asignado = min(queues[cola_actual].quantum, proceso_actual->remaining_time);
+
+        // Si es el unico proceso listo, los quantums hasta la siguiente
+        // llegada se ejecutan de una vez
+        if (get_ready_count(queues, nqueues) == 0)
+        {
+            quantums = uncontended_quantums(sim, proceso_actual, queues[cola_actual].quantum,
+                                            limit);
+        }
+    }
+    else
+    {
+        // FIFO: dar todo el tiempo restante (no expropiativo)
+        tiempo_asignado = proceso_actual->remaining_time;
+    }
+    tiempo_total = tiempo_asignado * quantums;
+
+    proceso_actual->context_switches += quantums;
+    if (!sim->opts->quiet)
+    {
+        print_dispatch(sim, cola_actual, proceso_actual, quantums);
+    }
+
+    // Actualizar tiempos del proceso actual
+    proceso_actual->cpu_time += tiempo_total;
+    proceso_actual->remaining_time -= tiempo_total;
+
+    // Agregar slice de CPU al proceso (uno solo para los quantums seguidos)
+    slice_vector_push_back(&proceso_actual->slices,
+                           create_slice(CPU, sim->now, sim->now + tiempo_total));
+
+    // Agregar a la secuencia de ejecucion
+    if (sim->sequence != NULL)
+    {
+        seqlog_append_run(sim->sequence, proceso_actual->pid, sim->now, tiempo_asignado, quantums);
+    }
+    sim->dispatches += quantums;
+
+    // Avanzar el tiempo
+    sim->now += tiempo_total;
+
+    // Procesar llegadas durante este intervalo
+    admit_arrivals(sim);
+
+    // Verificar si el proceso ha finalizado
+    if (proceso_actual->remaining_time <= 0)
+    {
+        complete_process(sim, cola_actual, proceso_actual);
+    }
+    else
+    {
+        // El proceso no finalizo, volver a la cola de listos
+        proceso_actual->state = READY;
+        proceso_actual->ready_since = sim->now;
+
+        if (queues[cola_actual].strategy == RR)
+        {
+            // Round Robin: insertar al final de la cola
+            process_deque_push_back(queues[cola_actual].ready, proceso_actual);
+        }
+        else
+        {
+            // FIFO: insertar al inicio (continua su ejecucion)
+            // NOTA: en general para FIFO no se espera que llegue aquí
+            // porque para FIFO asignamos todo el remaining_time.
+            process_deque_push_front(queues[cola_actual].ready, proceso_actual);
+        }
+    }
 
-/* Rutina para la planificacion - Simplificada solo para FIFO y RR */
-void schedule(list *processes, priority_queue *queues, int nqueues)
+    return 1;
+}
+
+// Ciclos especializados: [Round Robin][mensajes][slices de espera]
+DEFINE_DISPATCH(dispatch_fifo_quiet, 0, 0, 0)
+DEFINE_DISPATCH(dispatch_fifo_quiet_waits, 0, 0, 1)
+DEFINE_DISPATCH(dispatch_fifo, 0, 1, 0)
+DEFINE_DISPATCH(dispatch_fifo_waits, 0, 1, 1)
+DEFINE_DISPATCH(dispatch_rr_quiet, 1, 0, 0)
+DEFINE_DISPATCH(dispatch_rr_quiet_waits, 1, 0, 1)
+DEFINE_DISPATCH(dispatch_rr, 1, 1, 0)
+DEFINE_DISPATCH(dispatch_rr_waits, 1, 1, 1)
+
+static dispatch_fn select_dispatch(const simulation *sim)
 {
-    int tiempo_actual = 0;
-    int procesos_restantes = processes->count;
-    int cola_actual = 0;
-    process *proceso_actual = NULL;
-    int tiempo_asignado = 0;
-    int siguiente_llegada = 0;
+    static const dispatch_fn specialized[2][2][2] = {
+        {{dispatch_fifo_quiet, dispatch_fifo_quiet_waits}, {dispatch_fifo, dispatch_fifo_waits}},
+        {{dispatch_rr_quiet, dispatch_rr_quiet_waits}, {dispatch_rr, dispatch_rr_waits}}};
+    strategy s = sim->queues[0].strategy;
     int i;
 
-    list *sequence = create_list(); // Secuencia de ejecucion
-    sequence_item *si;              // Item de secuencia de CPU
-
-    node_iterator it;
-    process *p;
-    int total_waiting = 0;
-    int tiempo_total_simulacion = 0;
+    if (!sim->opts->specialize || (s != FIFO && s != RR))
+    {
+        return dispatch_generic;
+    }
+    for (i = 1; i < sim->nqueues; i++)
+    {
+        if (sim->queues[i].strategy != s)
+        {
+            return dispatch_generic;
+        }
+    }
+    return specialized[s == RR][!sim->opts->quiet][sim->opts->wait_slices != 0];
+}
 
-    printf("=== INICIANDO SIMULACION ===\n");
-    printf("Procesos a simular: %d\n", procesos_restantes);
-    printf("Colas de prioridad: %d\n", nqueues);
+static void print_dispatch(simulation *sim, int queue, process *p, int quantums)
+{
+    if (quantums > 1)
+    {
+        fprintf(sim->out, "[T=%" PRIsim "] Ejecutando %s (prioridad %d, tiempo restante: %d, %d quantums)\n",
+                sim->now, process_name(p), queue + 1, p->remaining_time, quantums);
+    }
+    else
+    {
+        fprintf(sim->out, "[T=%" PRIsim "] Ejecutando %s (prioridad %d, tiempo restante: %d)\n",
+                sim->now, process_name(p), queue + 1, p->remaining_time);
+    }
+}
 
-    // IMPORTANTE: Preparar las colas antes de empezar
-    prepare(processes, queues, nqueues);
+static void accrue(simulation *sim, process *p, sim_time now)
+{
+    if (sim->opts->wait_slices)
+    {
+        accrue_waiting(p, now);
+    }
+    else
+    {
+        accrue_waiting_time(p, now);
+    }
+}
 
-    // Obtener el tiempo minimo de llegada
-    tiempo_actual = get_next_arrival(queues, nqueues);
-    if (tiempo_actual == -1)
-        tiempo_actual = 0;
+static void accrue_waiting_time(process *p, sim_time now)
+{
+    if (now > p->ready_since)
+    {
+        p->waiting_time += now - p->ready_since;
+    }
+    p->ready_since = now;
+}
 
-    printf("Tiempo inicial: %d\n", tiempo_actual);
+static int run_rr_rounds(simulation *sim, int queue, sim_time limit)
+{
+    process_deque *ready = sim->queues[queue].ready;
+    sim_delta quantum = sim->queues[queue].quantum;
+    int k = ready->count;
+    sim_time arrival = next_arrival(sim, sim->nqueues, SIM_TIME_MAX);
+    sim_time start = sim->now;
+    sim_time rounds, total, from;
+    sim_delta period;
+    int j;
+    process_deque_iterator it;
+    process *p;
 
-    // Procesar llegadas iniciales
-    process_arrival(tiempo_actual, queues, nqueues);
+    // La ronda debe caber en una slice, y las repeticiones en un int
+    if ((sim_time)quantum * k > SIM_DELTA_MAX)
+    {
+        return 0;
+    }
+    period = quantum * k;
+    rounds = min((SIM_TIME_MAX - start) / period, INT_MAX);
 
-    // Algoritmo principal de planificacion 
-    while (procesos_restantes > 0)
+    // Ningun proceso debe terminar: asi el orden de la cola no cambia
+    for (it = process_deque_head(ready); it != 0; it = process_deque_next(ready, it))
+    {
+        p = *it;
+        rounds = min(rounds, (p->remaining_time - 1) / quantum);
+    }
+    // Nadie debe llegar antes del fin de la ultima asignacion
+    if (arrival != -1)
+    {
+        rounds = min(rounds, (arrival - start - 1) / quantum / k);
+    }
+    // Cada asignacion debe comenzar antes del limite (sin desbordar si no hay limite)
+    if (limit - start < SIM_TIME_MAX - quantum)
+    {
+        rounds = min(rounds, (limit - start + quantum - 1) / quantum / k);
+    }
+    if (rounds < 2)
     {
+        return 0;
+    }
 
-        // Buscar la cola de mayor prioridad que tenga procesos listos
-        int cola_encontrada = 0;
+    total = rounds * period;
+    if (!sim->opts->quiet)
+    {
+        fprintf(sim->out, "[T=%" PRIsim "] Ejecutando %d rondas de %d procesos (prioridad %d, quantum %d)\n",
+                start, (int)rounds, k, queue + 1, quantum);
+    }
 
-        /*  recorrer desde 0 (máxima prioridad) hasta nqueues-1
-           para escoger la primera cola no vacía. */
-        for (i = 0; i < nqueues; i++)
+    // Los demas procesos listos siguen acumulando su espera desde ready_since
+    j = 0;
+    for (it = process_deque_head(ready); it != 0; it = process_deque_next(ready, it), j++)
+    {
+        p = *it;
+        from = start + j * quantum;
+        accrue(sim, p, from);
+        if (p->first_run_time < 0)
         {
-            if (!empty(queues[i].ready))
-            {
-                cola_actual = i; // Siempre la de mayor prioridad
-                cola_encontrada = 1; 
-                break;
-            }
+            p->first_run_time = from;
+            record_response(sim, queue, p);
+        }
+        p->context_switches += rounds;
+        p->cpu_time += rounds * quantum;
+        p->remaining_time -= (sim_delta)(rounds * quantum);
+        p->waiting_time += (rounds - 1) * (period - quantum);
+
+        // Un quantum por ronda y la espera entre rondas; la espera final queda pendiente
+        slice_vector_push_back(&p->slices, create_periodic_slice(CPU, from, from + quantum,
+                                                                 period, (int)rounds));
+        if (sim->opts->wait_slices)
+        {
+            slice_vector_push_back(&p->slices, create_periodic_slice(WAIT, from + quantum,
+                                                                     from + period, period,
+                                                                     (int)rounds - 1));
         }
+        p->ready_since = from + (rounds - 1) * period + quantum;
+        if (sim->sequence != NULL)
+        {
+            seqlog_append_periodic(sim->sequence, p->pid, from, quantum, (int)rounds, period);
+        }
+    }
+
+    sim->dispatches += rounds * k;
+    sim->now += total;
+    admit_arrivals(sim);
+
+    return 1;
+}
+
+static void run_realtime(simulation *sim, int queue, sim_time limit)
+{
+    priority_queue *queues = sim->queues;
+    process *p = process_heap_pop(queues[queue].ready, ready_order(&queues[queue]));
+    sim_time start = sim->now;
+    sim_time end, arrival;
+
+    accrue(sim, p, start);
+    p->state = RUNNING;
+    if (p->first_run_time < 0)
+    {
+        p->first_run_time = start;
+        record_response(sim, queue, p);
+    }
+    p->context_switches++;
+    if (!sim->opts->quiet)
+    {
+        print_dispatch(sim, queue, p, 1);
+    }
 
-        if (!cola_encontrada)
+    // Solo las llegadas a esta cola o a una de mayor prioridad pueden expropiarlo
+    do
+    {
+        end = min(sim->now + p->remaining_time, limit);
+        arrival = next_arrival(sim, queue + 1, end);
+        if (arrival != -1)
         {
-            // No hay procesos listos, avanzar al siguiente evento de llegada
-            siguiente_llegada = get_next_arrival(queues, nqueues);
-            if (siguiente_llegada == -1)
-            {
-                // No hay mas llegadas, terminar
-                break;
-            }
-            tiempo_actual = siguiente_llegada;
-            process_arrival(tiempo_actual, queues, nqueues);
-            continue;
+            end = min(end, arrival);
         }
+        p->cpu_time += end - sim->now;
+        p->remaining_time -= (sim_delta)(end - sim->now);
+        sim->now = end;
+        admit_arrivals(sim);
+    } while (p->remaining_time > 0 && sim->now < limit && !realtime_preempted(sim, queue, p));
+
+    // La rafaga no supera SIM_DELTA_MAX, asi que la asignacion cabe en una slice
+    slice_vector_push_back(&p->slices, create_slice(CPU, start, sim->now));
+    if (sim->sequence != NULL)
+    {
+        seqlog_append_run(sim->sequence, p->pid, start, (sim_delta)(sim->now - start), 1);
+    }
+    sim->dispatches++;
 
-        // Obtener el primer proceso de la cola (FIFO simple)
-        proceso_actual = front(queues[cola_actual].ready);
-        pop_front(queues[cola_actual].ready);
+    if (p->remaining_time > 0)
+    {
+        p->state = READY;
+        p->ready_since = sim->now;
+        push_ready(&queues[queue], p);
+    }
+    else
+    {
+        complete_process(sim, queue, p);
+    }
+}
 
-        // Cambiar estado del proceso a RUNNING
-        proceso_actual->state = RUNNING;
-        printf("[T=%d] Ejecutando %s (prioridad %d, tiempo restante: %d)\n",
-               tiempo_actual, proceso_actual->name, cola_actual + 1, proceso_actual->remaining_time);
+static int realtime_preempted(simulation *sim, int queue, process *p)
+{
+    priority_queue *queues = sim->queues;
+    int i;
 
-        // Calcular tiempo a asignar
-        if (queues[cola_actual].strategy == RR)
+    for (i = 0; i < queue; i++)
+    {
+        if (!process_deque_empty(queues[i].ready))
         {
-            // Round Robin: usar quantum
-            tiempo_asignado = min(queues[cola_actual].quantum, proceso_actual->remaining_time);
+            return 1;
         }
-        else
+    }
+
+    return !process_deque_empty(queues[queue].ready) &&
+           ready_order(&queues[queue])(process_deque_at(queues[queue].ready, 0), &p) > 0;
+}
+
+static int (*ready_order(const priority_queue *queue))(process *const *, process *const *)
+{
+    return (queue->strategy == EDF) ? compare_deadline : compare_rate;
+}
+
+static void complete_process(simulation *sim, int queue, process *p)
+{
+    priority_queue *q = &sim->queues[queue];
+
+    if (p->task != NULL)
+    {
+        // Cada trabajo cuenta como una finalizacion; su espera es lo que no ejecuto
+        record_finish(sim, queue, p, sim->now - p->arrival_time - p->execution_time);
+        if (finish_job(p, sim->now, sim->opts->quiet ? NULL : sim->out))
         {
-            // FIFO: dar todo el tiempo restante (no expropiativo)
-            tiempo_asignado = proceso_actual->remaining_time;
+            // Siguiente trabajo: listo si ya fue liberado, si no a la cola de llegada
+            if (p->arrival_time <= sim->now)
+            {
+                p->state = READY;
+                p->ready_since = sim->now;
+                push_ready(q, p);
+            }
+            else
+            {
+                p->state = LOADED;
+                process_deque_insert_ordered(q->arrival, p, compare_arrival);
+            }
+            return;
         }
+    }
+    else
+    {
+        record_finish(sim, queue, p, p->waiting_time);
+    }
 
-        // Actualizar tiempos del proceso actual
-        proceso_actual->cpu_time += tiempo_asignado;
-        proceso_actual->remaining_time -= tiempo_asignado;
+    p->state = FINISHED;
+    p->finished_time = sim->now;
+    sim->remaining--;
+    if (!sim->opts->quiet)
+    {
+        fprintf(sim->out, "[T=%" PRIsim "] Proceso %s FINALIZADO\n", sim->now, process_name(p));
+    }
 
-        // Agregar slice de CPU al proceso
-        push_back(proceso_actual->slices,
-                  create_slice(CPU, tiempo_actual, tiempo_actual + tiempo_asignado));
+    // Modo de memoria acotada: agregar sus metricas, guardar sus slices y reutilizar el registro
+    if (sim->stream != NULL)
+    {
+        retire_process(sim->stream, p);
+    }
+    else
+    {
+        process_deque_push_back(q->finished, p);
+    }
+}
 
-        // Agregar a la secuencia de ejecucion
-        si = (sequence_item *)malloc(sizeof(sequence_item));
-        si->name = proceso_actual->name;
-        si->time = tiempo_asignado;
-        push_back(sequence, si);
 
-        // Aumentar tiempo de espera de los demas procesos listos
-        add_waiting_time(processes, proceso_actual, tiempo_actual, tiempo_asignado);
+static void record_response(simulation *sim, int queue, process *p)
+{
+    if (process_measured(sim->opts, p))
+    {
+        stats_record_response(sim->stats, queue, p->first_run_time - p->arrival_time);
+    }
+}
 
-        // Avanzar el tiempo
-        tiempo_actual += tiempo_asignado;
+static void record_finish(simulation *sim, int queue, process *p, sim_time waiting)
+{
+    double half_width;
 
-        // Procesar llegadas durante este intervalo
-        process_arrival(tiempo_actual, queues, nqueues);
+    if (!process_measured(sim->opts, p))
+    {
+        return;
+    }
+    stats_record_finish(sim->stats, queue, waiting, sim->now - p->arrival_time, sim->now);
 
-        // Verificar si el proceso ha finalizado
-        if (proceso_actual->remaining_time <= 0)
+    // Parar cuando el intervalo de confianza de la espera media es suficientemente angosto
+    if (batch_record(&sim->batches, (double)waiting) && sim->opts->ci_width > 0)
+    {
+        half_width = batch_half_width(&sim->batches);
+        if (half_width >= 0 && half_width <= sim->opts->ci_width * batch_mean(&sim->batches))
         {
-            proceso_actual->state = FINISHED;
-            proceso_actual->finished_time = tiempo_actual;
-            push_back(queues[cola_actual].finished, proceso_actual);
-            procesos_restantes--;
-            printf("[T=%d] Proceso %s FINALIZADO\n", tiempo_actual, proceso_actual->name);
+            sim->converged = 1;
         }
-        else
-        {
-            // El proceso no finalizo, volver a la cola de listos
-            proceso_actual->state = READY;
+    }
+}
 
-            if (queues[cola_actual].strategy == RR)
-            {
-                // Round Robin: insertar al final de la cola
-                push_back(queues[cola_actual].ready, proceso_actual);
-            }
-            else
+static int sample_arrivals(simulation *sim)
+{
+    const sched_options *opts = sim->opts;
+    process_deque *arrival;
+    process *p;
+    int removed = 0;
+    int i, q, n;
+
+    // Rotar cada cola una vez conservando el orden de los procesos que quedan
+    for (q = 0; q < sim->nqueues; q++)
+    {
+        arrival = sim->queues[q].arrival;
+        n = arrival->count;
+        for (i = 0; i < n; i++)
+        {
+            p = process_deque_pop_front(arrival);
+            if ((opts->measure_end >= 0 && p->arrival_time >= opts->measure_end) ||
+                (p->arrival_time / opts->sample_window) % opts->sample_every != 0)
             {
-                // FIFO: insertar al inicio (continua su ejecucion)
-                // NOTA: en general para FIFO no se espera que llegue aquí
-                // porque para FIFO asignamos todo el remaining_time.
-                push_front(queues[cola_actual].ready, proceso_actual);
+                removed++;
+                continue;
             }
+            process_deque_push_back(arrival, p);
         }
     }
 
-    // CALCULAR ESTADISTICAS FINALES
-    tiempo_total_simulacion = tiempo_actual;
+    return removed;
+}
 
-    // IMPRIMIR RESULTADOS DE LA SIMULACION
-    printf("\n=== RESULTADOS DE LA SIMULACION ===\n");
-    printf("Colas de prioridad: %d\n", nqueues);
-    printf("Tiempo total de la simulacion: %d unidades de tiempo\n", tiempo_total_simulacion);
+static void report_measurement(simulation *sim)
+{
+    FILE *report = sim->report;
+    const sched_options *opts = sim->opts;
+    double half_width = batch_half_width(&sim->batches);
+
+    fprintf(report, "\n=== VENTANA DE MEDICION ===\n");
+    fprintf(report, "Calentamiento: llegadas antes de T=%" PRIsim " (no se miden)\n", opts->warmup);
+    if (opts->measure_end >= 0)
+    {
+        fprintf(report, "Medicion: llegadas hasta T=%" PRIsim " (las posteriores no se simulan)\n",
+                opts->measure_end);
+    }
+    if (opts->sample_every > 1)
+    {
+        fprintf(report, "Muestreo: 1 de cada %d ventanas de %" PRIsim " unidades de tiempo\n",
+                opts->sample_every, opts->sample_window);
+    }
+    if (sim->stream != NULL)
+    {
+        fprintf(report, "Procesos simulados: %ld leidos\n", sim->stream->read);
+    }
+    else
+    {
+        fprintf(report, "Procesos simulados: %d de %d\n", sim->nprocesses - sim->sampled_out,
+                sim->nprocesses);
+    }
+    fprintf(report, "Finalizaciones medidas: %ld\n", sim->batches.count);
+
+    if (half_width >= 0)
+    {
+        fprintf(report, "Espera media: %.2f +- %.2f (IC 95%%, %ld lotes de %ld)\n",
+                batch_mean(&sim->batches), half_width, sim->batches.batches, sim->batches.size);
+    }
+    else
+    {
+        fprintf(report,
+                "Espera media: %.2f (menos de %d lotes de %ld: sin intervalo de confianza)\n",
+                batch_mean(&sim->batches), BATCH_MIN_BATCHES, sim->batches.size);
+    }
+    if (opts->ci_width > 0)
+    {
+        if (sim->converged)
+        {
+            fprintf(report, "Parada anticipada en T=%" PRIsim ": semiancho <= %.1f%% de la media "
+                    "(%d procesos sin finalizar)\n",
+                    sim->now, opts->ci_width * 100, sim->remaining);
+        }
+        else
+        {
+            fprintf(report, "No se alcanzo el semiancho objetivo (%.1f%% de la media)\n",
+                    opts->ci_width * 100);
+        }
+    }
+}
+
+static int admit_arrivals(simulation *sim)
+{
+    process *p;
+
+    if (sim->stream != NULL)
+    {
+        while ((p = peek_process(sim->stream)) != NULL && p->arrival_time <= sim->now)
+        {
+            admit_streamed(sim);
+        }
+    }
+    return process_arrival(sim->now, sim->queues, sim->nqueues,
+                           sim->opts->quiet ? NULL : sim->out);
+}
+
+static sim_time next_arrival(simulation *sim, int nqueues, sim_time until)
+{
+    sim_time arrival = get_next_arrival(sim->queues, nqueues);
+    process *p;
 
-    // Calcular tiempo promedio de espera
-    float tiempo_promedio_espera = 0;
-    for (it = head(processes); it != 0; it = next(it))
+    // Los procesos se leen en orden de llegada: basta con leer hasta uno que
+    // no llegue antes que los que ya estan en las colas de llegada
+    if (sim->stream != NULL)
     {
-        p = (process *)it->data;
-        total_waiting += p->waiting_time;
+        while ((p = peek_process(sim->stream)) != NULL && p->arrival_time <= until &&
+               (arrival == -1 || p->arrival_time < arrival))
+        {
+            admit_streamed(sim);
+            arrival = get_next_arrival(sim->queues, nqueues);
+        }
     }
-    tiempo_promedio_espera = (float)total_waiting / processes->count;
-    printf("Tiempo promedio de espera: %.2f unidades de tiempo\n", tiempo_promedio_espera);
+    return arrival;
+}
 
-    // TABLA DE PROCESOS
-    printf("\n%5s%15s%12s%10s%12s%18s\n",
-           "#", "Proceso", "T. Llegada", "Tamaño", "T. Espera", "T. Finalizacion");
-    printf("--------------------------------------------------------------------------------\n");
+static void admit_streamed(simulation *sim)
+{
+    process *p = next_process(sim->stream);
+
+    process_deque_insert_ordered(sim->queues[p->priority].arrival, p, compare_arrival);
 
-    i = 1;
-    for (it = head(processes); it != 0; it = next(it))
+    // El proceso ya contaba como pendiente; el siguiente por leer tambien cuenta
+    if (peek_process(sim->stream) != NULL)
     {
-        p = (process *)it->data;
-        printf("%5d%15s%12d%10d%12d%18d\n",
-               i++, p->name, p->arrival_time, p->execution_time,
-               p->waiting_time, p->finished_time);
+        sim->remaining++;
     }
+}
+
+static int uncontended_quantums(simulation *sim, process *p, sim_delta quantum, sim_time limit)
+{
+    // La rafaga no supera SIM_DELTA_MAX, asi que los quantums caben en una slice
+    sim_time n = p->remaining_time / quantum;
+    sim_time arrival = next_arrival(sim, sim->nqueues, SIM_TIME_MAX);
 
-    // SECUENCIA DE EJECUCION
-    printf("\nSecuencia de ejecucion:\n");
-    for (it = head(sequence); it != 0; it = next(it))
+    // El quantum j (j >= 1) comienza en now + j * quantum y requiere que no
+    // haya llegado nadie hasta ese momento
+    if (arrival != -1)
+    {
+        n = min(n, (arrival - sim->now + quantum - 1) / quantum);
+    }
+    if (limit - sim->now < SIM_TIME_MAX - quantum)
     {
-        si = (sequence_item *)it->data;
-        printf("%s(%d) ", si->name, si->time);
-        if (next(it) != NULL)
-            printf("- ");
+        n = min(n, (limit - sim->now + quantum - 1) / quantum);
     }
-    printf("\n");
 
-    // Limpiar memoria de la secuencia
-    clear_list(sequence, 1);
-    destroy_list(sequence, 0);
+    return (n > 1) ? (int)n : 1;
+}
+
+static void print_sequence_group(const seq_record *records, int count, void *arg)
+{
+    sequence_printer *printer = (sequence_printer *)arg;
+
+    print_seq_rounds(printer->report, records, count, records[0].repeat, sequence_name, printer,
+                     &printer->first);
+}
+
+static const char *sequence_name(int pid, void *arg)
+{
+    sequence_printer *printer = (sequence_printer *)arg;
+
+    if (pid >= 0 && pid <= printer->max_pid && printer->names[pid] != NULL)
+    {
+        return printer->names[pid];
+    }
+    return "?";
 }
 
 priority_queue *create_queues(int n)
@@ -214,59 +1433,113 @@ priority_queue *create_queues(int n)
     {
         ret[i].strategy = RR; // Por defecto RR
         ret[i].quantum = 1;   // Quantum por defecto
-        ret[i].arrival = create_list();
-        ret[i].ready = create_list();
-        ret[i].finished = create_list();
+        ret[i].arrival = create_process_deque();
+        ret[i].ready = create_process_deque();
+        ret[i].finished = create_process_deque();
     }
 
     return ret;
 }
 
-void print_queue(priority_queue *queue)
+void destroy_queues(priority_queue *queues, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        destroy_process_deque(queues[i].ready);
+        destroy_process_deque(queues[i].arrival);
+        destroy_process_deque(queues[i].finished);
+    }
+    free(queues);
+}
+
+void push_ready(priority_queue *queue, process *p)
+{
+    if (queue->strategy == EDF || queue->strategy == RM)
+    {
+        process_heap_push(queue->ready, p, ready_order(queue));
+    }
+    else
+    {
+        process_deque_push_back(queue->ready, p);
+    }
+}
+
+const char *strategy_name(strategy s)
+{
+    switch (s)
+    {
+    case FIFO:
+        return "FIFO";
+    case EDF:
+        return "EDF";
+    case RM:
+        return "RM";
+    default:
+        return "RR";
+    }
+}
+
+void print_queue(priority_queue *queue, FILE *out)
 {
-    node_iterator ptr;
+    process_deque_iterator ptr;
 
-    printf("%s q=", (queue->strategy == RR) ? "RR" : "FIFO");
-    printf("%d ", queue->quantum);
+    fprintf(out, "%s q=", strategy_name(queue->strategy));
+    fprintf(out, "%d ", queue->quantum);
 
-    printf("ready (%d): { ", queue->ready->count);
-    for (ptr = head(queue->ready); ptr != 0; ptr = next(ptr))
+    fprintf(out, "ready (%d): { ", queue->ready->count);
+    for (ptr = process_deque_head(queue->ready); ptr != 0;
+         ptr = process_deque_next(queue->ready, ptr))
     {
-        print_process((process *)ptr->data);
+        print_process(*ptr, out);
     }
-    printf("} \n");
+    fprintf(out, "} \n");
 
-    printf("arrival (%d): { ", queue->arrival->count);
-    for (ptr = head(queue->arrival); ptr != 0; ptr = next(ptr))
+    fprintf(out, "arrival (%d): { ", queue->arrival->count);
+    for (ptr = process_deque_head(queue->arrival); ptr != 0;
+         ptr = process_deque_next(queue->arrival, ptr))
     {
-        print_process((process *)ptr->data);
+        print_process(*ptr, out);
     }
-    printf("} \n");
+    fprintf(out, "} \n");
 
-    printf("finished (%d): { ", queue->finished->count);
-    for (ptr = head(queue->finished); ptr != 0; ptr = next(ptr))
+    fprintf(out, "finished (%d): { ", queue->finished->count);
+    for (ptr = process_deque_head(queue->finished); ptr != 0;
+         ptr = process_deque_next(queue->finished, ptr))
     {
-        print_process((process *)ptr->data);
+        print_process(*ptr, out);
     }
-    printf("}\n");
+    fprintf(out, "}\n");
 }
 
-int compare_arrival(void *const a, void *const b)
+int compare_arrival(process *const *a, process *const *b)
 {
-    process *p1 = (process *)a;
-    process *p2 = (process *)b;
-    return p2->arrival_time - p1->arrival_time;
+    process *p1 = *a;
+    process *p2 = *b;
+
+    // Comparar sin restar: la resta de dos tiempos de 64 bits no cabe en un int
+    return (p1->arrival_time < p2->arrival_time) - (p1->arrival_time > p2->arrival_time);
 }
 
-process *create_process(char *name, int arrival_time, int execution_time)
+process *create_process(const char *name, sim_time arrival_time, sim_delta execution_time)
 {
     process *p;
 
     // Reservar memoria para el proceso
     p = (process *)malloc(sizeof(process));
+    init_slice_vector(&p->slices);
+    reuse_process(p, name, arrival_time, execution_time);
+
+    return p;
+}
+
+void reuse_process(process *p, const char *name, sim_time arrival_time, sim_delta execution_time)
+{
+    slice_vector slices = p->slices;
 
     memset(p, 0, sizeof(process));
-    strcpy(p->name, name);
+    p->name = intern_name(name);
     p->arrival_time = arrival_time;
     p->execution_time = execution_time;
     p->priority = -1;
@@ -274,10 +1547,22 @@ process *create_process(char *name, int arrival_time, int execution_time)
     p->remaining_time = p->execution_time;
     p->finished_time = -1;
     p->cpu_time = 0;
+    p->first_run_time = -1;
+    p->context_switches = 0;
+    p->cpu = 0;
+    p->ready_since = 0;
     p->state = LOADED;
-    p->slices = create_list();
 
-    return p;
+    // Conservar la memoria de las slices del proceso anterior
+    p->slices = slices;
+    slice_vector_clear(&p->slices);
+}
+
+void destroy_process(process *p)
+{
+    destroy_periodic_task(p->task);
+    free_slice_vector(&p->slices);
+    free(p);
 }
 
 void restart_process(process *p)
@@ -285,107 +1570,129 @@ void restart_process(process *p)
     p->waiting_time = 0;
     p->finished_time = -1;
     p->remaining_time = p->execution_time;
+    p->cpu_time = 0;
+    p->first_run_time = -1;
+    p->context_switches = 0;
+    p->ready_since = 0;
     p->state = LOADED;
-    clear_list(p->slices, 1);
+    slice_vector_clear(&p->slices);
+    if (p->task != NULL)
+    {
+        restart_periodic_task(p);
+    }
 }
 
-void print_slices(process *p)
+void print_slices(process *p, FILE *out)
 {
-    node_iterator it;
-    slice *s;
+    slice_vector_iterator s;
 
-    for (it = head(p->slices); it != 0; it = next(it))
+    for (s = slice_vector_head(&p->slices); s != 0; s = slice_vector_next(&p->slices, s))
     {
-        s = it->data;
-        printf("%s %d -> %d ", (s->type == CPU ? "CPU" : "WAIT"), s->from, s->to);
+        fprintf(out, "%s %" PRIsim " -> %" PRIsim " ", (s->type == CPU ? "CPU" : "WAIT"), s->from,
+                slice_end(s));
+        if (s->repeat > 1)
+        {
+            fprintf(out, "(x%d cada %d) ", s->repeat, s->period);
+        }
     }
 }
 
-void print_process(process *p)
+void print_process(process *p, FILE *out)
 {
     if (p == 0)
     {
         return;
     }
-    printf("(%s arrival:%d execution:%d finished:%d waiting:%d ",
-           p->name, p->arrival_time, p->execution_time, p->finished_time, p->waiting_time);
+    fprintf(out, "(%s arrival:%" PRIsim " execution:%d finished:%" PRIsim " waiting:%" PRIsim " ",
+            process_name(p), p->arrival_time, p->execution_time, p->finished_time, p->waiting_time);
 
-    printf("%s )\n", (p->state == READY) ? "ready" : (p->state == LOADED) ? "loaded"
-                                                 : (p->state == FINISHED) ? "finished"
-                                                                          : "unknown");
+    fprintf(out, "%s )\n", (p->state == READY) ? "ready" : (p->state == LOADED) ? "loaded"
+                                                       : (p->state == FINISHED) ? "finished"
+                                                                                : "unknown");
 }
 
-void prepare(list *processes, priority_queue *queues, int nqueues)
+void prepare(process_vector *processes, priority_queue *queues, int nqueues, FILE *out,
+             FILE *report)
 {
     int i;
     process *p;
-    node_iterator it;
+    process_vector_iterator it;
 
-    printf("Preparando simulacion...\n");
+    if (out != NULL)
+    {
+        fprintf(out, "Preparando simulacion...\n");
+    }
 
     /* Limpiar las colas de prioridad */
     for (i = 0; i < nqueues; i++)
     {
         if (queues[i].ready != 0)
         {
-            clear_list(queues[i].ready, 0);
+            process_deque_clear(queues[i].ready);
         }
         else
         {
-            queues[i].ready = create_list();
+            queues[i].ready = create_process_deque();
         }
 
         if (queues[i].arrival != 0)
         {
-            clear_list(queues[i].arrival, 0);
+            process_deque_clear(queues[i].arrival);
         }
         else
         {
-            queues[i].arrival = create_list();
+            queues[i].arrival = create_process_deque();
         }
 
         if (queues[i].finished != 0)
         {
-            clear_list(queues[i].finished, 0);
+            process_deque_clear(queues[i].finished);
         }
         else
         {
-            queues[i].finished = create_list();
+            queues[i].finished = create_process_deque();
         }
     }
 
-    /* Inicializar la informacion de los procesos en la lista de procesos */
-    for (it = head(processes); it != 0; it = next(it))
+    /* Inicializar la informacion de los procesos en el vector de procesos */
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
     {
-        p = (process *)it->data;
+        p = *it;
         restart_process(p);
 
-        printf("Agregando proceso %s a cola %d (arrival: %d)\n",
-               p->name, p->priority, p->arrival_time);
+        if (out != NULL)
+        {
+            fprintf(out, "Agregando proceso %s a cola %d (arrival: %" PRIsim ")\n",
+                    process_name(p), p->priority, p->arrival_time);
+        }
 
         // Verificar que la prioridad sea válida
         if (p->priority < 0 || p->priority >= nqueues)
         {
-            printf("Error: proceso %s tiene prioridad invalida %d\n", p->name, p->priority + 1);
+            fprintf(report, "Error: proceso %s tiene prioridad invalida %d\n", process_name(p), p->priority + 1);
             continue;
         }
 
-        insert_ordered(queues[p->priority].arrival, p, compare_arrival);
+        process_deque_insert_ordered(queues[p->priority].arrival, p, compare_arrival);
     }
 
-    printf("Colas preparadas:\n");
+    if (out == NULL)
+    {
+        return;
+    }
+    fprintf(out, "Colas preparadas:\n");
     for (i = 0; i < nqueues; i++)
     {
-        printf("Cola %d (%s, q=%d): arrival=%d, ready=%d\n",
+        fprintf(out, "Cola %d (%s, q=%d): arrival=%d, ready=%d\n",
                i + 1,
-               queues[i].strategy == RR ? "RR" : "FIFO",
+               strategy_name(queues[i].strategy),
                queues[i].quantum,
                queues[i].arrival->count,
                queues[i].ready->count);
     }
 }
 
-int process_arrival(int now, priority_queue *queues, int nqueues)
+int process_arrival(sim_time now, priority_queue *queues, int nqueues, FILE *out)
 {
     int i;
     process *p;
@@ -396,7 +1703,7 @@ int process_arrival(int now, priority_queue *queues, int nqueues)
     total = 0;
     for (i = 0; i < nqueues; i++)
     {
-        if (empty(queues[i].arrival))
+        if (process_deque_empty(queues[i].arrival))
         {
             continue;
         }
@@ -404,14 +1711,14 @@ int process_arrival(int now, priority_queue *queues, int nqueues)
         queue_processed = 0;
         do
         {
-            p = front(queues[i].arrival);
-
-            if (p == 0)
+            if (process_deque_empty(queues[i].arrival))
             {
                 queue_processed = 1;
                 continue;
             }
 
+            p = process_deque_front(queues[i].arrival);
+
             // Ignorar el proceso si no es momento de llevarlo a la cola de listos
             if (p->arrival_time > now)
             {
@@ -419,47 +1726,45 @@ int process_arrival(int now, priority_queue *queues, int nqueues)
                 continue;
             }
 
-            printf("[%d] Process %s arrived -> Cola %d (%s)\n",
-                   now, p->name, i + 1, queues[i].strategy == RR ? "RR" : "FIFO");
-            p->state = READY;
-
-            // Dibujar la linea del tiempo de espera si llega tarde
-            if (now > p->arrival_time)
+            if (out != NULL)
             {
-                int initial_wait = now - p->arrival_time;
-                p->waiting_time += initial_wait;
-                push_back(p->slices, create_slice(WAIT, p->arrival_time, now));
+                fprintf(out, "[%" PRIsim "] Process %s arrived -> Cola %d (%s)\n",
+                        now, process_name(p), i + 1, strategy_name(queues[i].strategy));
             }
+            p->state = READY;
+
+            // Si llega tarde, la espera se cuenta desde su llegada
+            p->ready_since = p->arrival_time;
 
             total++;
 
-            // Para FIFO y RR, insertar al final de la cola
-            push_back(queues[i].ready, p);
+            // FIFO y RR: al final de la cola; EDF y RM: en el monticulo
+            push_ready(&queues[i], p);
 
             // Quitar el proceso de la cola de llegadas
-            pop_front(queues[i].arrival);
+            process_deque_pop_front(queues[i].arrival);
 
         } while (!queue_processed);
     }
     return total;
 }
 
-int get_next_arrival(priority_queue *queues, int nqueues)
+sim_time get_next_arrival(priority_queue *queues, int nqueues)
 {
-    int ret = INT_MAX;
+    sim_time ret = SIM_TIME_MAX;
     process *p;
     int i;
 
     for (i = 0; i < nqueues; i++)
     {
-        p = front(queues[i].arrival);
-        if (p != 0)
+        if (!process_deque_empty(queues[i].arrival))
         {
+            p = process_deque_front(queues[i].arrival);
             ret = min(ret, p->arrival_time);
         }
     }
 
-    if (ret == INT_MAX)
+    if (ret == SIM_TIME_MAX)
     {
         ret = -1;
     }
@@ -479,46 +1784,51 @@ int get_ready_count(priority_queue *queues, int nqueues)
     return ret;
 }
 
-int max_scheduling_time(list *processes)
+sim_time max_scheduling_time(process_vector *processes)
 {
-    node_iterator it;
-    process *p;
-    int max = 0;
+    time_summary finished;
+    sim_time *column;
 
-    for (it = head(processes); it != 0; it = next(it))
-    {
-        p = (process *)it->data;
-        if (p->finished_time > max)
-        {
-            max = p->finished_time;
-        }
-    }
+    column = (sim_time *)malloc(sizeof(sim_time) * (processes->count + 1));
+    time_column_reduce(column, time_column(processes, offsetof(process, finished_time), column),
+                       &finished);
+    free(column);
 
-    return max;
+    return (finished.max > 0) ? finished.max : 0;
 }
 
-void add_waiting_time(list *processes, process *current_process, int current_time, int current_slice)
+void accrue_waiting(process *p, sim_time now)
 {
-    node_iterator it;
-    process *p;
-    for (it = head(processes); it != 0; it = next(it))
+    sim_time from;
+
+    if (now > p->ready_since)
     {
-        p = (process *)it->data;
-        if (p != current_process && p->state == READY)
+        p->waiting_time += now - p->ready_since;
+
+        // Una slice dura a lo sumo SIM_DELTA_MAX: las esperas mas largas se dividen
+        for (from = p->ready_since; now - from > SIM_DELTA_MAX; from += SIM_DELTA_MAX)
         {
-            p->waiting_time += current_slice;
-            push_back(p->slices, create_slice(WAIT, current_time, current_time + current_slice));
+            slice_vector_push_back(&p->slices, create_slice(WAIT, from, from + SIM_DELTA_MAX));
         }
+        slice_vector_push_back(&p->slices, create_slice(WAIT, from, now));
     }
+    p->ready_since = now;
+}
+
+slice create_slice(slice_type type, sim_time from, sim_time to)
+{
+    return create_periodic_slice(type, from, to, (sim_delta)(to - from), 1);
 }
 
-slice *create_slice(slice_type type, int from, int to)
+slice create_periodic_slice(slice_type type, sim_time from, sim_time to, sim_delta period,
+                            int repeat)
 {
-    slice *s;
+    slice s;
 
-    s = (slice *)malloc(sizeof(slice));
-    s->type = type;
-    s->from = from;
-    s->to = to;
+    s.type = type;
+    s.from = from;
+    s.length = (sim_delta)(to - from);
+    s.period = period;
+    s.repeat = repeat;
     return s;
 }
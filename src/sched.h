@@ -8,18 +8,27 @@
  * @copyright MIT License
  */
 
-#include "list.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#include "container.h"
+#include "intern.h"
+#include "seqlog.h"
+#include "simtime.h"
+#include "stats.h"
 
 #ifndef min
 /** @brief Encuentra el minimo entre dos valores */
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 #endif
 
-/** @brief Algoritmo de planificacion - Solo FIFO y RR */
+/** @brief Algoritmo de planificacion */
 typedef enum
 {
     FIFO,
-    RR
+    RR,
+    EDF, /*!< Earliest Deadline First: expropiativo, por plazo absoluto */
+    RM   /*!< Rate Monotonic: expropiativo, por periodo */
 } strategy;
 
 /** @brief Tipo de slice de tiempo */
@@ -32,11 +41,22 @@ typedef enum
 /** @brief Tajada de tiempo*/
 typedef struct
 {
-    slice_type type; /*!< Tipo de slice */
-    int from;        /*!< Tiempo inicial */
-    int to;          /*!< Tiempo final */
+    sim_time from;    /*!< Tiempo inicial */
+    sim_delta length; /*!< Duracion de cada repeticion */
+    sim_delta period; /*!< Distancia entre repeticiones (rondas Round Robin) */
+    int repeat;       /*!< Cantidad de repeticiones de [from, from + length) */
+    slice_type type;  /*!< Tipo de slice */
 } slice;
 
+/** @brief Tiempo final de la primera repeticion de una slice */
+#define slice_end(s) ((s)->from + (s)->length)
+
+/** @brief Tiempo final de la ultima repeticion de una slice */
+#define slice_last_end(s) ((s)->from + (sim_time)((s)->repeat - 1) * (s)->period + (s)->length)
+
+/** @brief Vector de slices (guardadas por valor) */
+DEFINE_VECTOR(slice_vector, slice)
+
 /** @brief Estados de un proceso */
 enum state
 {
@@ -47,46 +67,226 @@ enum state
     FINISHED
 };
 
-/** @brief Item de secuencia de ejecucion de un proceso */
-typedef struct
-{
-    char *name; /*!< Proceso de la secuencia (cpu)*/
-    int time;   /*!< Tiempo de la secuencia */
-} sequence_item;
-
 /** @brief Definicion de un proceso */
 typedef struct
 {
-    int pid;            /*!< PID Del proceso */
-    char name[80];      /*!< Nombre del proceso (archivo ejecutable) */
-    int priority;       /*!< Prioridad */
-    int arrival_time;   /*!< Tiempo de llegada */
-    int execution_time; /*!< Tiempo total de ejecucion */
-    int remaining_time; /*!< Tiempo restante de ejecucion */
-    int waiting_time;   /*!< Tiempo de espera */
-    int finished_time;  /*!< Tiempo de finalizacion */
-    int cpu_time;       /*!< Tiempo de CPU que ha sido asignado */
-    enum state state;   /*!< Estado del proceso */
-    list *slices;       /*!< Slices de tiempo */
+    int pid;                    /*!< PID Del proceso */
+    name_id name;               /*!< Nombre del proceso (ver name_string()) */
+    int priority;               /*!< Prioridad */
+    enum state state;           /*!< Estado del proceso */
+    sim_time arrival_time;      /*!< Tiempo de llegada (tarea periodica: del trabajo actual) */
+    sim_delta execution_time;   /*!< Tiempo total de ejecucion (tarea periodica: por trabajo) */
+    sim_delta remaining_time;   /*!< Tiempo restante de ejecucion (del trabajo actual) */
+    sim_time waiting_time;      /*!< Tiempo de espera */
+    sim_time finished_time;     /*!< Tiempo de finalizacion */
+    sim_time cpu_time;          /*!< Tiempo de CPU que ha sido asignado */
+    int cpu;                    /*!< CPU a la que esta fijado (0-based) */
+    sim_time first_run_time;    /*!< Tiempo de la primera asignacion de CPU, o -1 */
+    sim_time ready_since;       /*!< Tiempo desde el cual espera en la cola de listos */
+    long context_switches;      /*!< Cantidad de veces que se le asigno la CPU */
+    slice_vector slices;        /*!< Slices de tiempo */
+    struct periodic_task *task; /*!< Tarea periodica (ver realtime.h), o NULL */
 } process;
 
+/** @brief Vector de procesos */
+DEFINE_VECTOR(process_vector, process *)
+
+/** @brief Cola doble de procesos */
+DEFINE_DEQUE(process_deque, process *)
+
+/** @brief Monticulo de procesos sobre una cola doble (colas EDF y RM) */
+DEFINE_HEAP(process_heap, process_deque, process *)
+
+/** @brief Nombre de un proceso (cadena internada) */
+#define process_name(p) name_string((p)->name)
+
 /** @brief Cola de prioridad */
 typedef struct
 {
-    int quantum;       /*!< Quantum asignado a la cola de prioridad */
-    strategy strategy; /*!< Estrategia de planificacion */
-    list *ready;       /*!< Cola de procesos listos */
-    list *arrival;     /*!< Cola de llegada de procesos*/
-    list *finished;    /*!< Cola de procesos finalizados */
+    sim_delta quantum;       /*!< Quantum asignado a la cola de prioridad */
+    strategy strategy;       /*!< Estrategia de planificacion */
+    process_deque *ready;    /*!< Cola de procesos listos */
+    process_deque *arrival;  /*!< Cola de llegada de procesos*/
+    process_deque *finished; /*!< Cola de procesos finalizados */
 } priority_queue;
 
+/** @brief Instantaneas de una simulacion (ver checkpoint.h) */
+typedef struct snapshot_set snapshot_set;
+
+/** @brief Procesos que se leen durante la simulacion (ver stream.h) */
+typedef struct process_stream process_stream;
+
+/** @brief Opciones de la simulacion */
+typedef struct
+{
+    char *seq_log_path;      /*!< Archivo donde se guarda la secuencia de ejecucion, o NULL */
+    size_t seq_mem_cap;      /*!< Memoria maxima de la secuencia antes de volcarla a disco (bytes) */
+    char *stats_path;        /*!< Archivo donde se guardan los histogramas de latencia, o NULL */
+    sched_stats *stats;      /*!< Estadisticas donde se acumulan los resultados, o NULL */
+    char *checkpoint_path;   /*!< Archivo de puntos de control, o NULL */
+    long checkpoint_every;   /*!< Asignaciones de CPU entre puntos de control */
+    char *resume_path;       /*!< Punto de control desde el cual continuar, o NULL */
+    int ncpus;               /*!< CPUs simuladas */
+    int migration;           /*!< 1 = los procesos pueden migrar entre CPUs */
+    int threads;             /*!< Hilos para simular las particiones, o 0 = uno por nucleo */
+    sim_time start_time;     /*!< Tiempo inicial, o -1 = la primera llegada */
+    sim_time horizon;        /*!< Fin de las liberaciones periodicas, o -1 = hiperperiodo */
+    sim_time warmup;         /*!< Llegadas anteriores que se simulan sin medirse (calentamiento) */
+    sim_time measure_end;    /*!< Llegadas desde las cuales no se simula, o -1 = todas */
+    int sample_every;        /*!< Simular solo 1 de cada sample_every ventanas de llegada */
+    sim_time sample_window;  /*!< Ancho de las ventanas de muestreo */
+    double ci_width;         /*!< Semiancho relativo del IC de la espera media para parar, o 0 */
+    long batch_size;         /*!< Procesos por lote de las medias por lotes */
+    FILE *out;               /*!< Salida de los mensajes de la simulacion, o NULL = stdout */
+    FILE *report;            /*!< Salida de los resultados y errores, o NULL = stdout */
+    snapshot_set *snapshots; /*!< Instantaneas para reanudar (ver checkpoint.h), o NULL */
+    process_stream *stream;  /*!< Modo de memoria acotada (ver stream.h), o NULL */
+    int quiet;               /*!< 1 = no imprimir los mensajes de la simulacion (solo resultados y errores) */
+    int wait_slices;         /*!< 1 = registrar las slices de espera (diagrama de Gantt) */
+    int specialize;          /*!< 1 = usar un ciclo especializado si todas las colas son FIFO o RR */
+} sched_options;
+
+/** @brief Asignaciones de CPU entre puntos de control por defecto */
+#define CHECKPOINT_DEFAULT_EVERY 100000
+
+struct simulation;
+
+/**
+ * @brief Asignacion de la CPU a la cola de mayor prioridad con procesos listos.
+ * @param sim Simulacion
+ * @param queue Cola elegida (0-based)
+ * @param limit Tiempo limite de la asignacion
+ * @return 1 si se asigno la CPU.
+ */
+typedef int (*dispatch_fn)(struct simulation *sim, int queue, sim_time limit);
+
+/** @brief Estado de una simulacion en curso */
+typedef struct simulation
+{
+    process_vector *processes; /*!< Vector de procesos */
+    process **table;           /*!< Procesos en el orden del vector */
+    int nprocesses;            /*!< Cantidad de procesos */
+    int max_pid;               /*!< PID maximo */
+    process **by_pid;          /*!< Procesos indexados por PID (max_pid + 1) */
+    priority_queue *queues;    /*!< Arreglo de colas de prioridad */
+    int nqueues;               /*!< Cantidad de colas de prioridad */
+    const sched_options *opts; /*!< Opciones de la simulacion */
+    sim_time now;              /*!< Tiempo actual */
+    int remaining;             /*!< Procesos que no han finalizado */
+    long dispatches;           /*!< Asignaciones de CPU realizadas */
+    seqlog *sequence;          /*!< Secuencia de ejecucion */
+    sched_stats *stats;        /*!< Estadisticas de latencia */
+    FILE *out;                 /*!< Salida de los mensajes de la simulacion */
+    FILE *report;              /*!< Salida de los resultados y errores */
+    batch_means batches;       /*!< Medias por lotes de la espera de los procesos medidos */
+    int sampled_out;           /*!< Procesos fuera de las ventanas simuladas */
+    int converged;             /*!< 1 = el IC de la espera media alcanzo el ancho objetivo */
+    snapshot_set *snapshots;   /*!< Instantaneas que se toman, o NULL */
+    process_stream *stream;    /*!< Procesos por leer y finalizados (modo acotado), o NULL */
+    dispatch_fn dispatch;      /*!< Ciclo de asignacion, elegido al iniciar segun las colas */
+} simulation;
+
+/**
+ * @brief Inicializa las opciones de la simulacion con los valores por defecto
+ * @param opts Opciones a inicializar
+ */
+void init_sched_options(sched_options *opts);
+
+/**
+ * @brief Obtiene la salida de los resultados y errores de una simulacion.
+ * @param opts Opciones de la simulacion
+ * @return opts->report, o stdout si es NULL.
+ */
+FILE *report_output(const sched_options *opts);
+
+/**
+ * @brief Indica si las estadisticas de un proceso se miden: llego despues
+ * del calentamiento (opts->warmup) y antes del fin de la ventana de medicion
+ * (opts->measure_end).
+ * @param opts Opciones de la simulacion
+ * @param p Proceso
+ * @return 1 si se mide, 0 en caso contrario.
+ */
+int process_measured(const sched_options *opts, const process *p);
+
+/**
+ * @brief Indica si un proceso entra en los resultados (tabla, promedios y
+ * exportacion): se mide y finalizo (no quedo fuera del muestreo ni de una
+ * parada anticipada).
+ * @param opts Opciones de la simulacion
+ * @param p Proceso
+ * @return 1 si se reporta, 0 en caso contrario.
+ */
+int process_reported(const sched_options *opts, const process *p);
+
 /**
  * @brief Rutina para la planificacion
- * @param processes Lista de procesos.
+ * @param processes Vector de procesos.
+ * @param queues Arreglo de colas de prioridad.
+ * @param nqueues Cantidad de colas de prioridad.
+ * @param opts Opciones de la simulacion, o NULL para los valores por defecto.
+ * @return 1 si la simulacion se ejecuto, 0 si no se pudo iniciar o reanudar.
+ */
+int schedule(process_vector *processes, priority_queue *queues, int nqueues,
+             const sched_options *opts);
+
+/**
+ * @brief Prepara una simulacion: colas, secuencia, estadisticas y llegadas
+ * iniciales, o el estado guardado en opts->resume_path.
+ * @param sim Simulacion a inicializar
+ * @param processes Vector de procesos.
  * @param queues Arreglo de colas de prioridad.
  * @param nqueues Cantidad de colas de prioridad.
+ * @param opts Opciones de la simulacion.
+ * @return 1 si la simulacion puede comenzar, 0 en caso de error.
+ */
+int init_simulation(simulation *sim, process_vector *processes, priority_queue *queues,
+                    int nqueues, const sched_options *opts);
+
+/**
+ * @brief Realiza la siguiente asignacion de CPU.
+ * @param sim Simulacion
+ * @return 1 si quedan procesos por ejecutar, 0 si la simulacion termino o
+ * el intervalo de confianza de la espera media alcanzo el ancho objetivo.
  */
-void schedule(list *processes, priority_queue *queues, int nqueues);
+int simulation_step(simulation *sim);
+
+/**
+ * @brief Realiza la siguiente asignacion de CPU si comienza antes de un limite.
+ *
+ * Si no hay procesos listos, avanza el tiempo a la siguiente llegada solo
+ * si ocurre antes del limite. La asignacion la hace sim->dispatch: si todas
+ * las colas son FIFO o todas Round Robin, un ciclo especializado sin las
+ * ramas por estrategia ni los mensajes y slices de espera que no se usan.
+ * @param sim Simulacion
+ * @param limit Tiempo limite (exclusivo) para iniciar la asignacion
+ * @return 1 si se realizo una asignacion, 0 en caso contrario.
+ */
+int simulation_step_before(simulation *sim, sim_time limit);
+
+/**
+ * @brief Imprime los resultados, las estadisticas y la secuencia de ejecucion.
+ *
+ * En el modo de memoria acotada imprime los agregados de los procesos
+ * finalizados en lugar de la tabla de procesos, y no hay secuencia.
+ * @param sim Simulacion terminada
+ */
+void report_simulation(simulation *sim);
+
+/**
+ * @brief Imprime la secuencia de ejecucion ("A(2) - B(3) ...") sin salto de linea final.
+ * @param sequence Secuencia
+ * @param by_pid Procesos indexados por PID
+ * @param max_pid PID maximo
+ * @param report Salida
+ */
+void print_sequence(seqlog *sequence, process **by_pid, int max_pid, FILE *report);
+
+/**
+ * @brief Libera la secuencia, las estadisticas propias y las tablas de la simulacion.
+ * @param sim Simulacion
+ */
+void destroy_simulation(simulation *sim);
 
 /**
  * @brief Crea un arreglo de colas de prioridad
@@ -95,11 +295,36 @@ void schedule(list *processes, priority_queue *queues, int nqueues);
  */
 priority_queue *create_queues(int n);
 
+/**
+ * @brief Libera un arreglo de colas de prioridad (no libera los procesos)
+ * @param queues Arreglo de colas de prioridad
+ * @param n Numero de colas de prioridad
+ */
+void destroy_queues(priority_queue *queues, int n);
+
+/**
+ * @brief Obtiene el nombre de una estrategia de planificacion.
+ * @param s Estrategia
+ * @return "FIFO", "RR", "EDF" o "RM".
+ */
+const char *strategy_name(strategy s);
+
+/**
+ * @brief Agrega un proceso listo a una cola de prioridad.
+ *
+ * En las colas FIFO y RR el proceso va al final; en las colas EDF y RM la
+ * cola de listos es un monticulo ordenado por plazo o por periodo.
+ * @param queue Cola de prioridad
+ * @param p Proceso
+ */
+void push_ready(priority_queue *queue, process *p);
+
 /**
  * @brief Imprime la informacion de una cola de prioridad
  * @param queue Cola de prioridad a imprimir
+ * @param out Salida
  */
-void print_queue(priority_queue *queue);
+void print_queue(priority_queue *queue, FILE *out);
 
 /**
  * @brief Retorna el numero de procesos listos en una cola de prioridad
@@ -115,31 +340,51 @@ int get_ready_count(priority_queue *queues, int nqueues);
  * @param nqueues Cantidad de colas de prioridad
  * @return Tiempo de llegada del nuevo proceso
  */
-int get_next_arrival(priority_queue *queues, int nqueues);
+sim_time get_next_arrival(priority_queue *queues, int nqueues);
 
 /**
  * @brief Procesa la llegada de procesos  a una cola de prioridad
  * @param now Tiempo actual
  * @param queues Arreglo de colas de prioridad
  * @param nqueues Cantidad de colas de prioridad
+ * @param out Salida de los mensajes de la simulacion, o NULL para no imprimirlos
  * @return Cantidad de procesos que se pasaron a estado de listo
  */
-int process_arrival(int now, priority_queue *queues, int nqueues);
+int process_arrival(sim_time now, priority_queue *queues, int nqueues, FILE *out);
 
 /**
  * @brief  Imprimir la informacion de un proceso
  * @param p Proceso a imprimir
+ * @param out Salida
  */
-void print_process(process *p);
+void print_process(process *p, FILE *out);
 
 /**
  * @brief Crea un nuevo proceso.
- * @param name Nombre del proceso
+ * @param name Nombre del proceso (se interna, de cualquier longitud)
  * @param arrival_time Tiempo de llegada
- * @param execution_time Tiempo de ejecucion
+ * @param execution_time Tiempo de ejecucion (0 a SIM_DELTA_MAX)
  * @return Nuevo proceso
  */
-process *create_process(char *name, int arrival_time, int execution_time);
+process *create_process(const char *name, sim_time arrival_time, sim_delta execution_time);
+
+/**
+ * @brief Reinicializa el registro de un proceso finalizado para otro proceso.
+ *
+ * Conserva la memoria de las slices, de modo que en el modo de memoria
+ * acotada los registros se reutilizan sin volver a reservarse.
+ * @param p Proceso (sin tarea periodica)
+ * @param name Nombre del proceso (se interna)
+ * @param arrival_time Tiempo de llegada
+ * @param execution_time Tiempo de ejecucion (0 a SIM_DELTA_MAX)
+ */
+void reuse_process(process *p, const char *name, sim_time arrival_time, sim_delta execution_time);
+
+/**
+ * @brief Libera un proceso y sus slices.
+ * @param p Proceso
+ */
+void destroy_process(process *p);
 
 /**
  * @brief Reinicia un un proceso
@@ -149,49 +394,68 @@ void restart_process(process *p);
 
 /**
  * @brief Compara dos procesos por tiempo de llegada.
- * @param a Proceso A
- * @param b Proceso B
- * @return Resta de los tiempos de llegada de p2 y p1
+ * @param a Proceso A (elemento de la cola)
+ * @param b Proceso B (elemento de la cola)
+ * @return Positivo si A llega antes que B, negativo si llega despues, 0 si llegan a la vez.
  */
-int compare_arrival(void *const a, void *const b);
+int compare_arrival(process *const *a, process *const *b);
 
 /**
  * @brief Prepara las estructuras de datos para la simulacion.
- * @param processes Lista de procesos.
+ * @param processes Vector de procesos.
  * @param queues Arreglo de colas de prioridad.
  * @param nqueues Cantidad de colas de prioridad.
+ * @param out Salida de los mensajes de la simulacion, o NULL para no imprimirlos
+ * @param report Salida de los errores
  */
-void prepare(list *processes, priority_queue *queues, int nqueues);
+void prepare(process_vector *processes, priority_queue *queues, int nqueues, FILE *out,
+             FILE *report);
 
 /**
  * @brief  Calcula el tiempo total de la simulacion
- * @param processes Lista de procesos
+ * @param processes Vector de procesos
  * @return Tiempo en el cual termina el ultimo proceso
  */
-int max_scheduling_time(list *processes);
+sim_time max_scheduling_time(process_vector *processes);
 
 /**
  * @brief Crea una nueva slice de tiempo
  * @param type Tipo de slice de tiempo (CPU, WAIT)
  * @param from Tiempo de inicio
- * @param to Tiempo de finalizacion
- * @return Nueva slice.
+ * @param to Tiempo de finalizacion (to - from <= SIM_DELTA_MAX)
+ * @return Nueva slice (por valor).
  */
-slice *create_slice(slice_type type, int from, int to);
+slice create_slice(slice_type type, sim_time from, sim_time to);
 
 /**
- * @brief Adiciona el tiempo de espera a los procesos listos
- * @param processes Lista de procesos
- * @param current_process Proceso que tuvo la CPU
- * @param current_time Tiempo actual
- * @param current_slice Cantidad de tiempo que el proceso tuvo la CPU
+ * @brief Crea una slice que se repite cada cierto tiempo.
+ * @param type Tipo de slice de tiempo (CPU, WAIT)
+ * @param from Tiempo de inicio de la primera repeticion
+ * @param to Tiempo de finalizacion de la primera repeticion (to - from <= SIM_DELTA_MAX)
+ * @param period Distancia entre los inicios de dos repeticiones
+ * @param repeat Cantidad de repeticiones
+ * @return Nueva slice (por valor).
+ */
+slice create_periodic_slice(slice_type type, sim_time from, sim_time to, sim_delta period,
+                            int repeat);
+
+/**
+ * @brief Acumula el tiempo de espera de un proceso listo que recibe la CPU.
+ *
+ * Un proceso listo espera desde ready_since hasta que se le asigna la CPU,
+ * de modo que la espera se cuenta una sola vez al asignarlo (con una sola
+ * slice WAIT, o varias si dura mas de SIM_DELTA_MAX) en lugar de recorrer
+ * los procesos listos en cada asignacion.
+ * @param p Proceso
+ * @param now Tiempo en que recibe la CPU
  */
-void add_waiting_time(list *processes, process *current_process, int current_time, int current_slice);
+void accrue_waiting(process *p, sim_time now);
 
 /**
  * @brief Imprime las asignaciones de CPU y tiempo de espera de un proceso.
  * @param p Proceso a imprimir
+ * @param out Salida
  */
-void print_slices(process *p);
+void print_slices(process *p, FILE *out);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,556 @@
+/**
+ * @file
+ * @brief Registro compacto de la secuencia de ejecucion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "seqlog.h"
+#include "util.h"
+
+/** @brief Encabezado del archivo de registro */
+static const char seqlog_magic[8] = "SEQLOG3";
+
+/** @brief Etiqueta de un bloque de registros */
+static const char tag_block[4] = {'B', 'L', 'O', 'K'};
+
+/** @brief Etiqueta de la tabla de nombres */
+static const char tag_names[4] = {'N', 'A', 'M', 'E'};
+
+/** @brief Etiqueta de fin de archivo */
+static const char tag_end[4] = {'E', 'N', 'D', '\0'};
+
+/** @brief Capacidad inicial del buffer en memoria (registros) */
+#define SEQLOG_INITIAL_CAPACITY 256
+
+/**
+ * @brief Vuelca los registros en memoria al archivo.
+ * @param log Registro
+ * @return 1 si se volco el bloque, 0 en caso de error.
+ */
+static int seqlog_spill(seqlog *log);
+
+/**
+ * @brief Asegura espacio para un registro mas: crece hasta el limite de
+ * memoria y luego vuelca los registros al archivo.
+ * @param log Registro
+ */
+static void seqlog_reserve(seqlog *log);
+
+/**
+ * @brief Cambia la capacidad de las columnas en memoria.
+ * @param log Registro
+ * @param capacity Nueva capacidad (registros)
+ */
+static void seqlog_resize(seqlog *log, int capacity);
+
+/**
+ * @brief Lee los bloques de un archivo de registro desde la posicion actual.
+ * @param file Archivo posicionado despues del encabezado
+ * @param max_records Cantidad maxima de registros a leer, o -1 para leer hasta el fin
+ * @param visit Funcion a invocar por cada registro, o NULL para solo saltar los bloques
+ * @param arg Argumento para visit
+ * @param pids Salida opcional: PIDs de la tabla de nombres
+ * @param names Salida opcional: tabla de nombres
+ * @param count Salida opcional: cantidad de nombres
+ * @return 1 si se leyo correctamente, 0 en caso de error.
+ */
+static int read_blocks(FILE *file, long max_records, seqlog_visitor visit, void *arg,
+                       int **pids, char ***names, int *count);
+
+seqlog *create_seqlog(char *path, size_t mem_cap)
+{
+    seqlog *log;
+
+    log = (seqlog *)malloc(sizeof(seqlog));
+    memset(log, 0, sizeof(seqlog));
+
+    log->mem_cap = (mem_cap > 0) ? mem_cap : SEQLOG_DEFAULT_MEM_CAP;
+    if (log->mem_cap < SEQLOG_INITIAL_CAPACITY * SEQLOG_RECORD_SIZE)
+    {
+        seqlog_resize(log, (log->mem_cap >= SEQLOG_RECORD_SIZE) ? log->mem_cap / SEQLOG_RECORD_SIZE : 1);
+    }
+    else
+    {
+        seqlog_resize(log, SEQLOG_INITIAL_CAPACITY);
+    }
+
+    if (path != NULL)
+    {
+        log->file = fopen(path, "w+b");
+        if (log->file == NULL)
+        {
+            destroy_seqlog(log);
+            return NULL;
+        }
+        fwrite(seqlog_magic, sizeof(seqlog_magic), 1, log->file);
+        log->path = concat(path, "");
+    }
+
+    return log;
+}
+
+seqlog *reopen_seqlog(char *path, size_t mem_cap, long offset, long spilled, long dispatches)
+{
+    seqlog *log;
+    char magic[sizeof(seqlog_magic)];
+    FILE *file;
+
+    file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    if (offset < (long)sizeof(seqlog_magic) ||
+        fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, seqlog_magic, sizeof(magic)) != 0 ||
+        ftruncate(fileno(file), offset) != 0 ||
+        fseek(file, 0, SEEK_END) != 0 || ftell(file) != offset)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    log = create_seqlog(NULL, mem_cap);
+    log->file = file;
+    log->path = concat(path, "");
+    log->spilled = spilled;
+    log->dispatches = dispatches;
+
+    return log;
+}
+
+long seqlog_sync(seqlog *log)
+{
+    if (log->file == NULL)
+    {
+        return 0;
+    }
+    fflush(log->file);
+    return ftell(log->file);
+}
+
+void seqlog_push_record(seqlog *log, const seq_record *r)
+{
+    int k;
+
+    seqlog_reserve(log);
+
+    k = log->count++;
+    log->pid[k] = r->pid;
+    log->start[k] = r->start;
+    log->length[k] = r->length;
+    log->repeat[k] = r->repeat;
+    log->period[k] = r->period;
+}
+
+void seqlog_append(seqlog *log, int pid, sim_time start, sim_delta length)
+{
+    seqlog_append_run(log, pid, start, length, 1);
+}
+
+void seqlog_append_run(seqlog *log, int pid, sim_time start, sim_delta length, int repeat)
+{
+    int k;
+
+    // Extender el ultimo registro si es la continuacion del mismo proceso
+    if (log->count > 0)
+    {
+        k = log->count - 1;
+        if (log->pid[k] == pid && log->length[k] == length && log->period[k] == length &&
+            log->repeat[k] <= INT_MAX - repeat &&
+            log->start[k] + (sim_time)length * log->repeat[k] == start)
+        {
+            log->repeat[k] += repeat;
+            log->dispatches += repeat;
+            return;
+        }
+    }
+
+    seqlog_append_periodic(log, pid, start, length, repeat, length);
+}
+
+void seqlog_append_periodic(seqlog *log, int pid, sim_time start, sim_delta length, int repeat,
+                            sim_delta period)
+{
+    int k;
+
+    log->dispatches += repeat;
+
+    seqlog_reserve(log);
+
+    k = log->count++;
+    log->pid[k] = pid;
+    log->start[k] = start;
+    log->length[k] = length;
+    log->repeat[k] = repeat;
+    log->period[k] = period;
+}
+
+void seqlog_foreach(seqlog *log, seqlog_visitor visit, void *arg)
+{
+    seq_record r;
+    long end;
+    int i;
+
+    // Primero los registros volcados al archivo
+    if (log->file != NULL && log->spilled > 0)
+    {
+        fflush(log->file);
+        end = ftell(log->file);
+        fseek(log->file, sizeof(seqlog_magic), SEEK_SET);
+        read_blocks(log->file, log->spilled, visit, arg, NULL, NULL, NULL);
+        fseek(log->file, end, SEEK_SET);
+    }
+
+    // Luego los registros en memoria
+    for (i = 0; i < log->count; i++)
+    {
+        r.pid = log->pid[i];
+        r.start = log->start[i];
+        r.length = log->length[i];
+        r.repeat = log->repeat[i];
+        r.period = log->period[i];
+        visit(&r, arg);
+    }
+}
+
+int seqlog_finish(seqlog *log, int *pids, const char **names, int count)
+{
+    uint32_t n;
+    int32_t pid;
+    uint32_t len;
+    int i;
+
+    if (log->path == NULL || log->file == NULL)
+    {
+        return 0;
+    }
+
+    if (log->count > 0 && !seqlog_spill(log))
+    {
+        return 0;
+    }
+
+    n = count;
+    fwrite(tag_names, sizeof(tag_names), 1, log->file);
+    fwrite(&n, sizeof(n), 1, log->file);
+    for (i = 0; i < count; i++)
+    {
+        pid = pids[i];
+        len = strlen(names[i]);
+        fwrite(&pid, sizeof(pid), 1, log->file);
+        fwrite(&len, sizeof(len), 1, log->file);
+        fwrite(names[i], 1, len, log->file);
+    }
+    fwrite(tag_end, sizeof(tag_end), 1, log->file);
+
+    return fflush(log->file) == 0;
+}
+
+void destroy_seqlog(seqlog *log)
+{
+    if (log == NULL)
+    {
+        return;
+    }
+    if (log->file != NULL)
+    {
+        fclose(log->file);
+    }
+    free(log->pid);
+    free(log->start);
+    free(log->length);
+    free(log->repeat);
+    free(log->period);
+    free(log->path);
+    free(log);
+}
+
+int seqlog_read_file(char *path, seqlog_visitor visit, void *arg,
+                     int **pids, char ***names, int *count)
+{
+    FILE *file;
+    char magic[sizeof(seqlog_magic)];
+    int ret;
+
+    *pids = NULL;
+    *names = NULL;
+    *count = 0;
+
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    if (fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, seqlog_magic, sizeof(magic)) != 0)
+    {
+        fclose(file);
+        return 0;
+    }
+
+    // Primera pasada: saltar los bloques para leer la tabla de nombres
+    ret = read_blocks(file, -1, NULL, NULL, pids, names, count);
+
+    // Segunda pasada: recorrer los registros
+    if (ret && visit != NULL)
+    {
+        fseek(file, sizeof(seqlog_magic), SEEK_SET);
+        ret = read_blocks(file, -1, visit, arg, NULL, NULL, NULL);
+    }
+
+    fclose(file);
+    return ret;
+}
+
+void init_seq_grouper(seq_grouper *g, seqlog_group_visitor visit, void *arg)
+{
+    memset(g, 0, sizeof(seq_grouper));
+    g->visit = visit;
+    g->arg = arg;
+}
+
+void seq_grouper_visit(const seq_record *r, void *arg)
+{
+    seq_grouper *g = (seq_grouper *)arg;
+
+    // Un registro periodico continua el grupo si pertenece a la misma ronda
+    if (g->count > 0 && r->period > r->length && g->records[0].period > g->records[0].length &&
+        r->repeat == g->records[0].repeat &&
+        r->period == g->records[0].period &&
+        r->start >= g->records[g->count - 1].start + g->records[g->count - 1].length &&
+        r->start < g->records[0].start + g->records[0].period)
+    {
+        if (g->count == g->capacity)
+        {
+            g->capacity *= 2;
+            g->records = (seq_record *)realloc(g->records, sizeof(seq_record) * g->capacity);
+        }
+        g->records[g->count++] = *r;
+        return;
+    }
+
+    if (g->count > 0)
+    {
+        g->visit(g->records, g->count, g->arg);
+    }
+    if (g->capacity == 0)
+    {
+        g->capacity = 16;
+        g->records = (seq_record *)malloc(sizeof(seq_record) * g->capacity);
+    }
+    g->records[0] = *r;
+    g->count = 1;
+}
+
+void finish_seq_grouper(seq_grouper *g)
+{
+    if (g->count > 0)
+    {
+        g->visit(g->records, g->count, g->arg);
+    }
+    free(g->records);
+    memset(g, 0, sizeof(seq_grouper));
+}
+
+void print_seq_rounds(FILE *out, const seq_record *records, int count, int rounds,
+                      seqlog_namer name, void *arg, int *first)
+{
+    int i, j;
+
+    // Las rachas y las series de rondas largas se imprimen una sola vez
+    if (rounds > SEQLOG_MAX_REPEAT)
+    {
+        fprintf(out, "%s%s", *first ? "" : "- ", (count > 1) ? "(" : "");
+        for (j = 0; j < count; j++)
+        {
+            fprintf(out, "%s%s(%d)", (j > 0) ? " - " : "", name(records[j].pid, arg),
+                    records[j].length);
+        }
+        fprintf(out, "%s x%d ", (count > 1) ? ")" : "", rounds);
+        *first = 0;
+        return;
+    }
+
+    for (i = 0; i < rounds; i++)
+    {
+        for (j = 0; j < count; j++)
+        {
+            fprintf(out, "%s%s(%d) ", *first ? "" : "- ", name(records[j].pid, arg),
+                    records[j].length);
+            *first = 0;
+        }
+    }
+}
+
+static int seqlog_spill(seqlog *log)
+{
+    uint32_t n;
+
+    if (log->file == NULL)
+    {
+        log->file = tmpfile();
+        if (log->file == NULL)
+        {
+            fprintf(stderr, "Warning! unable to create sequence spill file!\n");
+            return 0;
+        }
+        fwrite(seqlog_magic, sizeof(seqlog_magic), 1, log->file);
+    }
+
+    n = log->count;
+    fwrite(tag_block, sizeof(tag_block), 1, log->file);
+    fwrite(&n, sizeof(n), 1, log->file);
+    // La columna de 64 bits primero, para que las demas queden alineadas
+    fwrite(log->start, sizeof(sim_time), n, log->file);
+    fwrite(log->pid, sizeof(int), n, log->file);
+    fwrite(log->length, sizeof(sim_delta), n, log->file);
+    fwrite(log->repeat, sizeof(int), n, log->file);
+    fwrite(log->period, sizeof(sim_delta), n, log->file);
+
+    log->spilled += n;
+    log->count = 0;
+
+    return !ferror(log->file);
+}
+
+static void seqlog_reserve(seqlog *log)
+{
+    if (log->count < log->capacity)
+    {
+        return;
+    }
+    if ((size_t)log->capacity * 2 * SEQLOG_RECORD_SIZE <= log->mem_cap)
+    {
+        seqlog_resize(log, log->capacity * 2);
+    }
+    else if (!seqlog_spill(log))
+    {
+        // Sin archivo de volcado: seguir creciendo en memoria
+        seqlog_resize(log, log->capacity * 2);
+    }
+}
+
+static void seqlog_resize(seqlog *log, int capacity)
+{
+    log->pid = (int *)realloc(log->pid, sizeof(int) * capacity);
+    log->start = (sim_time *)realloc(log->start, sizeof(sim_time) * capacity);
+    log->length = (sim_delta *)realloc(log->length, sizeof(sim_delta) * capacity);
+    log->repeat = (int *)realloc(log->repeat, sizeof(int) * capacity);
+    log->period = (sim_delta *)realloc(log->period, sizeof(sim_delta) * capacity);
+    log->capacity = capacity;
+}
+
+static int read_blocks(FILE *file, long max_records, seqlog_visitor visit, void *arg,
+                       int **pids, char ***names, int *count)
+{
+    char tag[4];
+    uint32_t n, i, len;
+    int32_t pid;
+    char *block = NULL;
+    const int64_t *start;
+    const int32_t *columns;
+    seq_record r;
+    long read = 0;
+
+    while ((max_records < 0 || read < max_records) && fread(tag, sizeof(tag), 1, file) == 1)
+    {
+        if (memcmp(tag, tag_block, sizeof(tag)) == 0)
+        {
+            if (fread(&n, sizeof(n), 1, file) != 1)
+            {
+                break;
+            }
+            if (visit == NULL)
+            {
+                fseek(file, (long)n * SEQLOG_RECORD_SIZE, SEEK_CUR);
+                read += n;
+                continue;
+            }
+
+            block = (char *)realloc(block, (size_t)n * SEQLOG_RECORD_SIZE);
+            if (fread(block, SEQLOG_RECORD_SIZE, n, file) != n)
+            {
+                break;
+            }
+            start = (const int64_t *)block;
+            columns = (const int32_t *)(start + n);
+            for (i = 0; i < n; i++)
+            {
+                r.start = start[i];
+                r.pid = columns[i];
+                r.length = columns[n + i];
+                r.repeat = columns[2 * n + i];
+                r.period = columns[3 * n + i];
+                visit(&r, arg);
+            }
+            read += n;
+        }
+        else if (memcmp(tag, tag_names, sizeof(tag)) == 0)
+        {
+            if (fread(&n, sizeof(n), 1, file) != 1)
+            {
+                break;
+            }
+            if (pids == NULL)
+            {
+                // Saltar la tabla de nombres
+                for (i = 0; i < n; i++)
+                {
+                    if (fread(&pid, sizeof(pid), 1, file) != 1 ||
+                        fread(&len, sizeof(len), 1, file) != 1)
+                    {
+                        break;
+                    }
+                    fseek(file, len, SEEK_CUR);
+                }
+                continue;
+            }
+
+            *pids = (int *)malloc(sizeof(int) * (n > 0 ? n : 1));
+            *names = (char **)malloc(sizeof(char *) * (n > 0 ? n : 1));
+            for (i = 0; i < n; i++)
+            {
+                if (fread(&pid, sizeof(pid), 1, file) != 1 ||
+                    fread(&len, sizeof(len), 1, file) != 1)
+                {
+                    break;
+                }
+                (*pids)[i] = pid;
+                (*names)[i] = (char *)malloc(len + 1);
+                if (fread((*names)[i], 1, len, file) != len)
+                {
+                    free((*names)[i]);
+                    break;
+                }
+                (*names)[i][len] = '\0';
+                *count = i + 1;
+            }
+        }
+        else if (memcmp(tag, tag_end, sizeof(tag)) == 0)
+        {
+            free(block);
+            return 1;
+        }
+        else
+        {
+            // Etiqueta desconocida: archivo corrupto
+            free(block);
+            return 0;
+        }
+    }
+
+    free(block);
+
+    // Un archivo sin fin solo es valido si se leyo lo que se pidio
+    return max_records >= 0 && read >= max_records;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file
+ * @brief Registro compacto de la secuencia de ejecucion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * La secuencia se almacena como registros de ancho fijo
+ * (pid, inicio, duracion, repeticiones, periodo) organizados por columnas.
+ * Las asignaciones consecutivas del mismo proceso con la misma duracion se
+ * comprimen en un solo registro (run-length, periodo = duracion). Las rondas
+ * Round Robin repetidas se guardan como un grupo de registros periodicos
+ * (periodo = duracion de la ronda) con las mismas repeticiones, uno por
+ * proceso de la ronda, en el orden de la ronda. Cuando el buffer en memoria
+ * supera el limite configurado, los registros se vuelcan a un archivo
+ * por bloques.
+ *
+ * Formato del archivo:
+ * - Encabezado: "SEQLOG3" (8 bytes, incluido el nulo).
+ * - Bloques: etiqueta "BLOK", n (uint32), y las columnas start[n] (int64),
+ *   pid[n], length[n], repeat[n], period[n] (int32 cada una).
+ * - Nombres (opcional): etiqueta "NAME", n (uint32) y n entradas
+ *   (pid int32, longitud uint32, caracteres sin nulo).
+ * - Fin: etiqueta "END" (4 bytes, incluido el nulo).
+ */
+#ifndef SEQLOG_H
+#define SEQLOG_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "simtime.h"
+
+/** @brief Memoria maxima por defecto del buffer antes de volcarlo a disco (bytes) */
+#define SEQLOG_DEFAULT_MEM_CAP (4 * 1024 * 1024)
+
+/** @brief Rondas maximas de un grupo que se imprimen una por una en la secuencia */
+#define SEQLOG_MAX_REPEAT 16
+
+/** @brief Tamano en bytes de un registro */
+#define SEQLOG_RECORD_SIZE (sizeof(int64_t) + 4 * sizeof(int32_t))
+
+/** @brief Registro de la secuencia de ejecucion */
+typedef struct
+{
+    int pid;          /*!< PID del proceso que tuvo la CPU */
+    sim_time start;   /*!< Tiempo de inicio de la primera asignacion */
+    sim_delta length; /*!< Duracion de cada asignacion */
+    int repeat;       /*!< Cantidad de asignaciones */
+    sim_delta period; /*!< Distancia entre los inicios de dos repeticiones */
+} seq_record;
+
+/** @brief Registro columnar de la secuencia de ejecucion */
+typedef struct
+{
+    int count;         /*!< Registros en memoria */
+    int capacity;      /*!< Capacidad del buffer en memoria */
+    int *pid;          /*!< Columna de PIDs */
+    sim_time *start;   /*!< Columna de tiempos de inicio */
+    sim_delta *length; /*!< Columna de duraciones */
+    int *repeat;       /*!< Columna de repeticiones */
+    sim_delta *period; /*!< Columna de periodos */
+    long spilled;      /*!< Registros volcados al archivo */
+    long dispatches;   /*!< Total de asignaciones registradas */
+    size_t mem_cap;    /*!< Memoria maxima del buffer (bytes) */
+    FILE *file;        /*!< Archivo de volcado, o NULL */
+    char *path;        /*!< Ruta del archivo persistente, o NULL si es temporal */
+} seqlog;
+
+/**
+ * @brief Funcion que recibe cada registro al recorrer el registro.
+ * @param r Registro
+ * @param arg Argumento del usuario
+ */
+typedef void (*seqlog_visitor)(const seq_record *r, void *arg);
+
+/**
+ * @brief Funcion que recibe cada grupo de registros en orden cronologico.
+ *
+ * Un grupo es un registro simple (count = 1) o un grupo de rondas: count
+ * registros periodicos con las mismas repeticiones y el mismo periodo que se
+ * intercalan (repeticion 0 de cada uno, luego repeticion 1, etc).
+ * @param records Registros del grupo
+ * @param count Cantidad de registros
+ * @param arg Argumento del usuario
+ */
+typedef void (*seqlog_group_visitor)(const seq_record *records, int count, void *arg);
+
+/**
+ * @brief Funcion que devuelve el nombre de un proceso al imprimir la secuencia.
+ * @param pid PID del proceso
+ * @param arg Argumento del usuario
+ * @return Nombre del proceso, o "?" si no se conoce.
+ */
+typedef const char *(*seqlog_namer)(int pid, void *arg);
+
+/** @brief Agrupador de registros en rondas */
+typedef struct
+{
+    seq_record *records;        /*!< Grupo pendiente */
+    int count;                  /*!< Registros del grupo pendiente */
+    int capacity;               /*!< Capacidad de records */
+    seqlog_group_visitor visit; /*!< Funcion a invocar por cada grupo */
+    void *arg;                  /*!< Argumento para visit */
+} seq_grouper;
+
+/**
+ * @brief Crea un registro de secuencia vacio.
+ * @param path Archivo donde se guarda el registro, o NULL para usar
+ *        un archivo temporal solo si se supera el limite de memoria.
+ * @param mem_cap Memoria maxima en bytes, o 0 para el valor por defecto.
+ * @return Nuevo registro, o NULL si no se pudo crear el archivo.
+ */
+seqlog *create_seqlog(char *path, size_t mem_cap);
+
+/**
+ * @brief Reabre un registro persistente para continuar escribiendolo.
+ *
+ * El archivo se trunca en offset, descartando los bloques escritos despues
+ * del punto en que se tomo el estado (ver seqlog_sync()).
+ * @param path Ruta del archivo
+ * @param mem_cap Memoria maxima en bytes, o 0 para el valor por defecto.
+ * @param offset Tamano valido del archivo (bytes)
+ * @param spilled Registros volcados en esos bytes
+ * @param dispatches Total de asignaciones registradas
+ * @return Registro sin registros en memoria, o NULL si no se pudo abrir.
+ */
+seqlog *reopen_seqlog(char *path, size_t mem_cap, long offset, long spilled, long dispatches);
+
+/**
+ * @brief Vacia el buffer del archivo de volcado.
+ * @param log Registro
+ * @return Tamano actual del archivo (bytes), o 0 si no tiene archivo.
+ */
+long seqlog_sync(seqlog *log);
+
+/**
+ * @brief Agrega un registro tal cual (sin combinarlo ni contar sus asignaciones).
+ * @param log Registro
+ * @param r Registro a agregar
+ */
+void seqlog_push_record(seqlog *log, const seq_record *r);
+
+/**
+ * @brief Agrega una asignacion de CPU al registro.
+ * @param log Registro
+ * @param pid PID del proceso
+ * @param start Tiempo de inicio
+ * @param length Duracion de la asignacion
+ */
+void seqlog_append(seqlog *log, int pid, sim_time start, sim_delta length);
+
+/**
+ * @brief Agrega varias asignaciones consecutivas de la misma duracion.
+ * @param log Registro
+ * @param pid PID del proceso
+ * @param start Tiempo de inicio de la primera asignacion
+ * @param length Duracion de cada asignacion
+ * @param repeat Cantidad de asignaciones
+ */
+void seqlog_append_run(seqlog *log, int pid, sim_time start, sim_delta length, int repeat);
+
+/**
+ * @brief Agrega asignaciones periodicas de un proceso (una por ronda).
+ *
+ * Para registrar varias rondas se agrega un registro por cada proceso de la
+ * ronda, en orden, con las mismas repeticiones y el mismo periodo.
+ * @param log Registro
+ * @param pid PID del proceso
+ * @param start Tiempo de inicio de la primera asignacion
+ * @param length Duracion de cada asignacion
+ * @param repeat Cantidad de asignaciones
+ * @param period Distancia entre los inicios de dos asignaciones
+ */
+void seqlog_append_periodic(seqlog *log, int pid, sim_time start, sim_delta length, int repeat,
+                            sim_delta period);
+
+/**
+ * @brief Recorre todos los registros en orden (volcados y en memoria).
+ * @param log Registro
+ * @param visit Funcion a invocar por cada registro
+ * @param arg Argumento para visit
+ */
+void seqlog_foreach(seqlog *log, seqlog_visitor visit, void *arg);
+
+/**
+ * @brief Termina el registro persistente: vuelca la memoria y escribe los nombres.
+ * @param log Registro
+ * @param pids PIDs de los procesos
+ * @param names Nombres de los procesos
+ * @param count Cantidad de procesos
+ * @return 1 si se escribio el archivo, 0 si el registro no es persistente o hubo error.
+ */
+int seqlog_finish(seqlog *log, int *pids, const char **names, int count);
+
+/**
+ * @brief Libera el registro y cierra el archivo de volcado.
+ * @param log Registro
+ */
+void destroy_seqlog(seqlog *log);
+
+/**
+ * @brief Inicializa un agrupador de registros.
+ * @param g Agrupador
+ * @param visit Funcion a invocar por cada grupo
+ * @param arg Argumento para visit
+ */
+void init_seq_grouper(seq_grouper *g, seqlog_group_visitor visit, void *arg);
+
+/**
+ * @brief Agrega un registro al agrupador (se usa como seqlog_visitor).
+ * @param r Registro
+ * @param arg Agrupador (seq_grouper *)
+ */
+void seq_grouper_visit(const seq_record *r, void *arg);
+
+/**
+ * @brief Entrega el ultimo grupo pendiente y libera el agrupador.
+ * @param g Agrupador
+ */
+void finish_seq_grouper(seq_grouper *g);
+
+/**
+ * @brief Imprime rondas de un grupo en la secuencia de ejecucion.
+ *
+ * Hasta SEQLOG_MAX_REPEAT rondas se imprimen una por una
+ * ("A(2) - B(2) - A(2) - B(2)"); si son mas, la ronda se imprime una sola
+ * vez seguida de la cantidad ("(A(2) - B(2)) xN", o "A(2) xN" si la ronda
+ * tiene un registro). El simulador y seqtool imprimen con esta regla.
+ * @param out Salida
+ * @param records Registros de la ronda, en orden
+ * @param count Cantidad de registros
+ * @param rounds Rondas a imprimir
+ * @param name Funcion que devuelve el nombre de cada PID
+ * @param arg Argumento para name
+ * @param first 1 = aun no se ha impreso ningun elemento (se actualiza)
+ */
+void print_seq_rounds(FILE *out, const seq_record *records, int count, int rounds,
+                      seqlog_namer name, void *arg, int *first);
+
+/**
+ * @brief Lee un archivo de registro de secuencia.
+ * @param path Ruta del archivo
+ * @param visit Funcion a invocar por cada registro
+ * @param arg Argumento para visit
+ * @param pids Salida: PIDs de la tabla de nombres (liberar con free)
+ * @param names Salida: tabla de nombres (liberar cada cadena y el arreglo)
+ * @param count Salida: cantidad de nombres
+ * @return 1 si se leyo el archivo, 0 en caso de error.
+ */
+int seqlog_read_file(char *path, seqlog_visitor visit, void *arg,
+                     int **pids, char ***names, int *count);
+
+#endif
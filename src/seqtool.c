@@ -0,0 +1,413 @@
+/**
+ * @file
+ * @brief Herramienta para consultar un registro de secuencia de ejecucion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Uso: seqtool archivo [--pid N] [--name nombre] [--from T] [--to T]
+ *                      [--list | --summary]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "seqlog.h"
+#include "util.h"
+
+/** @brief Formato de salida */
+typedef enum
+{
+    OUTPUT_SEQUENCE, /*!< Secuencia como la imprime el simulador */
+    OUTPUT_LIST,     /*!< Un registro por linea */
+    OUTPUT_SUMMARY   /*!< Totales por proceso */
+} output_format;
+
+/** @brief Totales de un proceso */
+typedef struct
+{
+    long dispatches;   /*!< Asignaciones de CPU */
+    sim_time cpu_time; /*!< Tiempo total de CPU */
+    sim_time first;    /*!< Primera asignacion */
+    sim_time last;     /*!< Fin de la ultima asignacion */
+} pid_summary;
+
+/** @brief Estado de la consulta */
+typedef struct
+{
+    output_format format; /*!< Formato de salida */
+    int pid;              /*!< PID a filtrar, o -1 */
+    sim_time from;        /*!< Tiempo inicial del filtro */
+    sim_time to;          /*!< Tiempo final del filtro */
+    int *pids;            /*!< PIDs de la tabla de nombres */
+    char **names;         /*!< Tabla de nombres */
+    int count;            /*!< Cantidad de nombres */
+    int first;            /*!< 1 = aun no se ha impreso ningun elemento */
+    pid_summary *summary; /*!< Totales por indice de la tabla de nombres */
+} query;
+
+/**
+ * @brief Busca el indice de un PID en la tabla de nombres.
+ * @param q Consulta
+ * @param pid PID a buscar
+ * @return Indice en la tabla, o -1.
+ */
+static int find_pid(query *q, int pid);
+
+/**
+ * @brief Calcula las repeticiones de un registro dentro de la ventana de la consulta.
+ * @param q Consulta
+ * @param r Registro
+ * @param first Salida: primera repeticion dentro de la ventana
+ * @param last Salida: repeticion siguiente a la ultima dentro de la ventana
+ * @return 1 si alguna repeticion esta dentro de la ventana, 0 en caso contrario.
+ */
+static int clip_record(const query *q, const seq_record *r, int *first, int *last);
+
+/**
+ * @brief Procesa un grupo de registros de la secuencia (un registro o una serie de rondas).
+ * @param records Registros del grupo
+ * @param count Cantidad de registros
+ * @param arg Consulta (query *)
+ */
+static void visit_group(const seq_record *records, int count, void *arg);
+
+/**
+ * @brief Imprime en la secuencia una ronda de un grupo, solo con los
+ * registros seleccionados que estan dentro de la ventana en esa ronda.
+ * @param q Consulta
+ * @param records Registros del grupo
+ * @param count Cantidad de registros
+ * @param k Ronda
+ */
+static void print_round(query *q, const seq_record *records, int count, int k);
+
+/**
+ * @brief Obtiene el nombre de un PID de la tabla de nombres (seqlog_namer).
+ * @param pid PID del proceso
+ * @param arg Consulta (query *)
+ * @return Nombre del proceso, o "?" si no se conoce.
+ */
+static const char *query_name(int pid, void *arg);
+
+/**
+ * @brief Imprime las opciones de linea de comandos
+ * @param program Nombre del programa
+ */
+static void usage(char *program);
+
+int main(int argc, char *argv[])
+{
+    query q;
+    seq_grouper grouper;
+    char *path = NULL;
+    char *name = NULL;
+    int i;
+
+    memset(&q, 0, sizeof(q));
+    q.format = OUTPUT_SEQUENCE;
+    q.pid = -1;
+    q.from = SIM_TIME_MIN;
+    q.to = SIM_TIME_MAX;
+    q.first = 1;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (equals(argv[i], "--pid") && i + 1 < argc)
+        {
+            q.pid = atoi(argv[++i]);
+        }
+        else if (equals(argv[i], "--name") && i + 1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (equals(argv[i], "--from") && i + 1 < argc)
+        {
+            q.from = strtoll(argv[++i], NULL, 10);
+        }
+        else if (equals(argv[i], "--to") && i + 1 < argc)
+        {
+            q.to = strtoll(argv[++i], NULL, 10);
+        }
+        else if (equals(argv[i], "--list"))
+        {
+            q.format = OUTPUT_LIST;
+        }
+        else if (equals(argv[i], "--summary"))
+        {
+            q.format = OUTPUT_SUMMARY;
+        }
+        else if (argv[i][0] != '-' && path == NULL)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (path == NULL)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Leer primero solo la tabla de nombres para resolver --name
+    if (!seqlog_read_file(path, NULL, NULL, &q.pids, &q.names, &q.count))
+    {
+        fprintf(stderr, "Error: no se pudo leer el registro %s\n", path);
+        return 1;
+    }
+
+    if (name != NULL)
+    {
+        for (i = 0; i < q.count; i++)
+        {
+            if (equals(q.names[i], name))
+            {
+                q.pid = q.pids[i];
+                break;
+            }
+        }
+        if (i == q.count)
+        {
+            fprintf(stderr, "Error: proceso desconocido: %s\n", name);
+            return 1;
+        }
+    }
+
+    q.summary = (pid_summary *)calloc(q.count + 1, sizeof(pid_summary));
+
+    if (q.format == OUTPUT_LIST)
+    {
+        printf("%12s%8s%15s%10s%8s%10s\n", "Inicio", "PID", "Proceso", "Duracion", "Veces",
+               "Periodo");
+    }
+
+    // Segunda lectura: recorrer los registros
+    free(q.pids);
+    for (i = 0; i < q.count; i++)
+    {
+        free(q.names[i]);
+    }
+    free(q.names);
+    init_seq_grouper(&grouper, visit_group, &q);
+    if (!seqlog_read_file(path, seq_grouper_visit, &grouper, &q.pids, &q.names, &q.count))
+    {
+        fprintf(stderr, "Error: registro %s incompleto\n", path);
+    }
+    finish_seq_grouper(&grouper);
+
+    if (q.format == OUTPUT_SEQUENCE)
+    {
+        printf("\n");
+    }
+    else if (q.format == OUTPUT_SUMMARY)
+    {
+        printf("%8s%15s%14s%14s%12s%12s\n",
+               "PID", "Proceso", "Asignaciones", "T. CPU", "Inicio", "Fin");
+        for (i = 0; i < q.count; i++)
+        {
+            if (q.summary[i].dispatches == 0)
+            {
+                continue;
+            }
+            printf("%8d%15s%14ld%14" PRIsim "%12" PRIsim "%12" PRIsim "\n",
+                   q.pids[i], q.names[i], q.summary[i].dispatches, q.summary[i].cpu_time,
+                   q.summary[i].first, q.summary[i].last);
+        }
+    }
+
+    for (i = 0; i < q.count; i++)
+    {
+        free(q.names[i]);
+    }
+    free(q.names);
+    free(q.pids);
+    free(q.summary);
+
+    return 0;
+}
+
+static int find_pid(query *q, int pid)
+{
+    int i;
+
+    // La tabla se escribe en orden de PID, probar primero el acceso directo
+    if (pid >= 1 && pid <= q->count && q->pids[pid - 1] == pid)
+    {
+        return pid - 1;
+    }
+    for (i = 0; i < q->count; i++)
+    {
+        if (q->pids[i] == pid)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int clip_record(const query *q, const seq_record *r, int *first, int *last)
+{
+    sim_time from = 0;
+    sim_time to = r->repeat;
+
+    // Limitar las repeticiones del registro a la ventana [from, to)
+    if (r->length > 0 && r->period > 0)
+    {
+        if (q->from >= r->start + r->length)
+        {
+            from = (q->from - r->start - r->length) / r->period + 1;
+        }
+        if (q->to <= r->start)
+        {
+            to = 0;
+        }
+        else if (q->to < r->start + (sim_time)r->period * r->repeat)
+        {
+            to = (q->to - r->start + r->period - 1) / r->period;
+        }
+    }
+    else if (r->start < q->from || r->start >= q->to)
+    {
+        return 0;
+    }
+
+    // Las repeticiones caben en int: se limitan a [0, repeat]
+    *first = (int)((from > r->repeat) ? r->repeat : from);
+    *last = (int)((to > r->repeat) ? r->repeat : to);
+    return *first < *last;
+}
+
+static void visit_group(const seq_record *records, int count, void *arg)
+{
+    query *q = (query *)arg;
+    const seq_record *r;
+    seq_record *selected;
+    sim_time start, end;
+    int first, last, k, j, n, idx;
+    int group_first = INT_MAX;
+    int group_last = 0;
+    int full_first, full_last;
+    char *name;
+
+    for (j = 0; j < count; j++)
+    {
+        r = &records[j];
+        if ((q->pid >= 0 && r->pid != q->pid) || !clip_record(q, r, &first, &last))
+        {
+            continue;
+        }
+        group_first = (first < group_first) ? first : group_first;
+        group_last = (last > group_last) ? last : group_last;
+
+        idx = find_pid(q, r->pid);
+        name = (idx >= 0) ? q->names[idx] : "?";
+        start = r->start + (sim_time)r->period * first;
+        end = r->start + (sim_time)r->period * (last - 1) + r->length;
+
+        switch (q->format)
+        {
+        case OUTPUT_SEQUENCE:
+            break;
+        case OUTPUT_LIST:
+            printf("%12" PRIsim "%8d%15s%10d%8d%10d\n", start, r->pid, name, r->length, last - first,
+                   r->period);
+            break;
+        case OUTPUT_SUMMARY:
+            if (idx < 0)
+            {
+                break;
+            }
+            if (q->summary[idx].dispatches == 0 || start < q->summary[idx].first)
+            {
+                q->summary[idx].first = start;
+            }
+            q->summary[idx].dispatches += last - first;
+            q->summary[idx].cpu_time += (sim_time)r->length * (last - first);
+            q->summary[idx].last = (end > q->summary[idx].last) ? end : q->summary[idx].last;
+            break;
+        }
+    }
+
+    // La secuencia se imprime en orden cronologico: ronda por ronda
+    if (q->format != OUTPUT_SEQUENCE || group_first >= group_last)
+    {
+        return;
+    }
+
+    // Las rondas en las que estan todos los registros seleccionados se
+    // imprimen con la regla del simulador (ver print_seq_rounds()); las
+    // rondas incompletas de los bordes de la ventana, una por una
+    selected = (seq_record *)malloc(sizeof(seq_record) * count);
+    full_first = group_first;
+    full_last = group_last;
+    n = 0;
+    for (j = 0; j < count; j++)
+    {
+        r = &records[j];
+        if ((q->pid >= 0 && r->pid != q->pid) || !clip_record(q, r, &first, &last))
+        {
+            continue;
+        }
+        selected[n++] = *r;
+        full_first = (first > full_first) ? first : full_first;
+        full_last = (last < full_last) ? last : full_last;
+    }
+    if (full_first >= full_last)
+    {
+        full_first = full_last = group_last;
+    }
+
+    for (k = group_first; k < full_first; k++)
+    {
+        print_round(q, records, count, k);
+    }
+    print_seq_rounds(stdout, selected, n, full_last - full_first, query_name, q, &q->first);
+    for (k = full_last; k < group_last; k++)
+    {
+        print_round(q, records, count, k);
+    }
+    free(selected);
+}
+
+static void print_round(query *q, const seq_record *records, int count, int k)
+{
+    const seq_record *r;
+    int first, last, j;
+
+    for (j = 0; j < count; j++)
+    {
+        r = &records[j];
+        if ((q->pid >= 0 && r->pid != q->pid) || !clip_record(q, r, &first, &last) ||
+            k < first || k >= last)
+        {
+            continue;
+        }
+        print_seq_rounds(stdout, r, 1, 1, query_name, q, &q->first);
+    }
+}
+
+static const char *query_name(int pid, void *arg)
+{
+    query *q = (query *)arg;
+    int idx = find_pid(q, pid);
+
+    return (idx >= 0) ? q->names[idx] : "?";
+}
+
+static void usage(char *program)
+{
+    printf("Uso: %s archivo [opciones]\n", program);
+    printf("Opciones:\n");
+    printf("  --pid N          Mostrar solo las asignaciones del proceso N\n");
+    printf("  --name nombre    Mostrar solo las asignaciones del proceso con ese nombre\n");
+    printf("  --from T         Mostrar solo las asignaciones que terminan despues de T\n");
+    printf("  --to T           Mostrar solo las asignaciones que inician antes de T\n");
+    printf("  --list           Imprimir un registro por linea\n");
+    printf("  --summary        Imprimir los totales por proceso\n");
+}
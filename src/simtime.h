@@ -0,0 +1,45 @@
+/**
+ * @file
+ * @brief Tipos del tiempo de simulacion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Los instantes (llegadas, finalizaciones, tiempo actual) y los tiempos
+ * acumulados (esperas) son sim_time, de 64 bits, de modo que se pueden
+ * simular trazas largas con resolucion fina (por ejemplo un mes en
+ * microsegundos) sin desbordar. Las duraciones de una sola asignacion
+ * (rafagas, quantums, slices y registros de la secuencia) son sim_delta, de
+ * 32 bits, para que las estructuras que se recorren en cada asignacion sigan
+ * siendo compactas.
+ *
+ * Los archivos (secuencia, puntos de control, trazas y exportaciones)
+ * guardan los sim_time como enteros de 64 bits.
+ */
+#ifndef SIMTIME_H
+#define SIMTIME_H
+
+#include <stdint.h>
+#include <inttypes.h>
+
+/** @brief Instante o tiempo acumulado de la simulacion */
+typedef int64_t sim_time;
+
+/** @brief Duracion de una asignacion (rafaga, quantum o slice) */
+typedef int32_t sim_delta;
+
+/** @brief Mayor valor de sim_time */
+#define SIM_TIME_MAX INT64_MAX
+
+/** @brief Menor valor de sim_time */
+#define SIM_TIME_MIN INT64_MIN
+
+/** @brief Mayor valor de sim_delta */
+#define SIM_DELTA_MAX INT32_MAX
+
+/** @brief Formato de printf para sim_time ("%" PRIsim) */
+#define PRIsim PRId64
+
+/** @brief Formato de scanf para sim_time ("%" SCNsim) */
+#define SCNsim SCNd64
+
+#endif
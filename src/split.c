@@ -9,15 +9,6 @@
 #include "split.h"
 #include "util.h"
 
-/** @brief Delimitadores por defecto */
-char *split_default_delimiters = " \t\r\n";
-
-/**
- * @brief Delimitadores por defecto
- * @return Delimitadores por defecto
- */
-char *default_delimiters();
-
 split_list *split(char *str, char *delim)
 {
     char *str_ptr;
@@ -28,7 +19,7 @@ split_list *split(char *str, char *delim)
     
     if (delim == NULL || strlen(delim) == 0)
     {
-        delim = default_delimiters();
+        delim = SPLIT_DEFAULT_DELIMITERS;
     }
     
     ret = (split_list *)malloc(sizeof(split_list));
@@ -72,11 +63,6 @@ split_list *split(char *str, char *delim)
     return ret;
 }
 
-char *default_delimiters()
-{
-    return split_default_delimiters;
-}
-
 void free_split_list(split_list *l)
 {
     // Validar apuntador invalido
@@ -10,6 +10,9 @@
 /** @brief Cantidad maxima de subcadenas */
 #define MAX_PARTS 255
 
+/** @brief Delimitadores por defecto (constantes: split() no tiene estado global) */
+#define SPLIT_DEFAULT_DELIMITERS " \t\r\n"
+
 /**
  * @brief Lista de subcadenas
  */
@@ -0,0 +1,545 @@
+/**
+ * @file
+ * @brief Estadisticas de latencia de la simulacion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+
+#include "stats.h"
+
+/** @brief Encabezado del formato binario de estadisticas */
+static const char stats_magic[8] = "SCHSTAT";
+
+/** @brief Nombres de las metricas */
+static const char *metric_names[NMETRICS] = {"Espera", "Retorno", "Respuesta"};
+
+/** @brief Percentiles reportados */
+static const double reported_percentiles[] = {50, 90, 99, 99.9};
+
+/** @brief Cuantiles 0.975 de la t de Student con 1 a 30 grados de libertad */
+static const double student_t975[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                      2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                      2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                      2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+
+/** @brief Cantidad maxima de filas al imprimir el throughput */
+#define THROUGHPUT_PRINT_ROWS 8
+
+/**
+ * @brief Calcula el bucket de un valor.
+ * @param value Valor no negativo
+ * @return Indice del bucket
+ */
+static int bucket_index(long long value);
+
+/**
+ * @brief Calcula el mayor valor que cae en un bucket.
+ * @param index Indice del bucket
+ * @return Mayor valor equivalente
+ */
+static long long bucket_highest(int index);
+
+/**
+ * @brief Imprime una fila de percentiles.
+ * @param label Etiqueta de la cola
+ * @param metric Metrica
+ * @param h Histograma
+ * @param out Salida
+ */
+static void print_hist_row(char *label, latency_metric metric, const histogram *h, FILE *out);
+
+void hist_reset(histogram *h)
+{
+    memset(h, 0, sizeof(histogram));
+    h->min = LLONG_MAX;
+}
+
+void hist_record(histogram *h, long long value)
+{
+    if (value < 0)
+    {
+        value = 0;
+    }
+
+    h->counts[bucket_index(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min)
+    {
+        h->min = value;
+    }
+    if (value > h->max)
+    {
+        h->max = value;
+    }
+}
+
+void hist_merge(histogram *dst, const histogram *src)
+{
+    int i;
+
+    if (src->count == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < HIST_BUCKETS; i++)
+    {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->min < dst->min)
+    {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+}
+
+long long hist_percentile(const histogram *h, double percentile)
+{
+    long long target;
+    long long ppm;
+    long long seen = 0;
+    long long value;
+    int i;
+
+    if (h->count == 0)
+    {
+        return 0;
+    }
+
+    // Rango de la muestra que corresponde al percentil, en enteros (partes por
+    // millon): ceil(99.9 / 100.0 * 1000) en double da 1000 en vez de 999
+    ppm = llround(percentile * 10000);
+    target = (h->count * ppm + 999999) / 1000000;
+    if (target < 1)
+    {
+        target = 1;
+    }
+    if (target > h->count)
+    {
+        target = h->count;
+    }
+
+    for (i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += h->counts[i];
+        if (seen >= target)
+        {
+            value = bucket_highest(i);
+            return (value > h->max) ? h->max : value;
+        }
+    }
+
+    return h->max;
+}
+
+double hist_mean(const histogram *h)
+{
+    return (h->count > 0) ? h->sum / h->count : 0;
+}
+
+void batch_reset(batch_means *b, long size)
+{
+    memset(b, 0, sizeof(batch_means));
+    b->size = (size > 0) ? size : BATCH_DEFAULT_SIZE;
+}
+
+int batch_record(batch_means *b, double value)
+{
+    double mean;
+
+    b->count++;
+    b->total += value;
+    b->partial += value;
+    if (++b->pending < b->size)
+    {
+        return 0;
+    }
+
+    mean = b->partial / b->size;
+    b->batches++;
+    b->sum += mean;
+    b->sumsq += mean * mean;
+    b->pending = 0;
+    b->partial = 0;
+    return 1;
+}
+
+double batch_mean(const batch_means *b)
+{
+    if (b->batches > 0)
+    {
+        return b->sum / b->batches;
+    }
+    return (b->count > 0) ? b->total / b->count : 0;
+}
+
+double batch_half_width(const batch_means *b)
+{
+    double mean, variance;
+    long dof = b->batches - 1;
+
+    if (b->batches < BATCH_MIN_BATCHES)
+    {
+        return -1;
+    }
+
+    // Varianza muestral de las medias de los lotes
+    mean = b->sum / b->batches;
+    variance = (b->sumsq - b->batches * mean * mean) / dof;
+    if (variance < 0)
+    {
+        variance = 0;
+    }
+
+    return ((dof <= 30) ? student_t975[dof - 1] : 1.96) * sqrt(variance / b->batches);
+}
+
+sched_stats *create_stats(int nqueues)
+{
+    sched_stats *stats;
+
+    stats = (sched_stats *)malloc(sizeof(sched_stats));
+    stats->nqueues = nqueues;
+    stats->hist = (histogram *)malloc(sizeof(histogram) * NMETRICS * (nqueues > 0 ? nqueues : 1));
+    stats_reset(stats);
+
+    return stats;
+}
+
+void destroy_stats(sched_stats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    free(stats->hist);
+    free(stats);
+}
+
+void stats_reset(sched_stats *stats)
+{
+    int i;
+
+    for (i = 0; i < stats->nqueues * NMETRICS; i++)
+    {
+        hist_reset(&stats->hist[i]);
+    }
+    memset(&stats->throughput, 0, sizeof(throughput_series));
+    stats->throughput.width = 1;
+}
+
+histogram *stats_hist(sched_stats *stats, int queue, latency_metric metric)
+{
+    return &stats->hist[queue * NMETRICS + metric];
+}
+
+void stats_record_finish(sched_stats *stats, int queue, long long waiting,
+                         long long turnaround, long long finished_time)
+{
+    throughput_series *t = &stats->throughput;
+    int i;
+
+    if (queue < 0 || queue >= stats->nqueues)
+    {
+        return;
+    }
+
+    hist_record(stats_hist(stats, queue, METRIC_WAITING), waiting);
+    hist_record(stats_hist(stats, queue, METRIC_TURNAROUND), turnaround);
+
+    if (finished_time < 0)
+    {
+        finished_time = 0;
+    }
+
+    // Duplicar el ancho de los intervalos hasta que el tiempo quede en rango
+    while (finished_time / t->width >= THROUGHPUT_BINS)
+    {
+        for (i = 0; i < THROUGHPUT_BINS / 2; i++)
+        {
+            t->bins[i] = t->bins[2 * i] + t->bins[2 * i + 1];
+        }
+        memset(&t->bins[THROUGHPUT_BINS / 2], 0, sizeof(long long) * (THROUGHPUT_BINS / 2));
+        t->width *= 2;
+    }
+    t->bins[finished_time / t->width]++;
+}
+
+void stats_record_response(sched_stats *stats, int queue, long long response)
+{
+    if (queue < 0 || queue >= stats->nqueues)
+    {
+        return;
+    }
+    hist_record(stats_hist(stats, queue, METRIC_RESPONSE), response);
+}
+
+int stats_merge(sched_stats *dst, const sched_stats *src)
+{
+    throughput_series t;
+    int i;
+
+    if (dst->nqueues != src->nqueues)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < dst->nqueues * NMETRICS; i++)
+    {
+        hist_merge(&dst->hist[i], &src->hist[i]);
+    }
+
+    // Llevar ambas series al mismo ancho antes de sumarlas
+    t = src->throughput;
+    while (dst->throughput.width < t.width)
+    {
+        for (i = 0; i < THROUGHPUT_BINS / 2; i++)
+        {
+            dst->throughput.bins[i] = dst->throughput.bins[2 * i] + dst->throughput.bins[2 * i + 1];
+        }
+        memset(&dst->throughput.bins[THROUGHPUT_BINS / 2], 0, sizeof(long long) * (THROUGHPUT_BINS / 2));
+        dst->throughput.width *= 2;
+    }
+    while (t.width < dst->throughput.width)
+    {
+        for (i = 0; i < THROUGHPUT_BINS / 2; i++)
+        {
+            t.bins[i] = t.bins[2 * i] + t.bins[2 * i + 1];
+        }
+        memset(&t.bins[THROUGHPUT_BINS / 2], 0, sizeof(long long) * (THROUGHPUT_BINS / 2));
+        t.width *= 2;
+    }
+    for (i = 0; i < THROUGHPUT_BINS; i++)
+    {
+        dst->throughput.bins[i] += t.bins[i];
+    }
+
+    return 1;
+}
+
+void print_stats(sched_stats *stats, FILE *out)
+{
+    histogram *total;
+    char label[64];
+    long long rows[THROUGHPUT_PRINT_ROWS];
+    long long row_width;
+    int last_bin;
+    int nrows;
+    int q, m, i;
+
+    fprintf(out, "\n=== ESTADISTICAS DE LATENCIA ===\n");
+    fprintf(out, "%8s%12s%10s%10s%10s%10s%10s%10s%10s\n",
+            "Cola", "Metrica", "Procesos", "Media", "p50", "p90", "p99", "p99.9", "Max");
+
+    for (q = 0; q < stats->nqueues; q++)
+    {
+        if (stats_hist(stats, q, METRIC_TURNAROUND)->count == 0)
+        {
+            continue;
+        }
+        snprintf(label, sizeof(label), "%d", q + 1);
+        for (m = 0; m < NMETRICS; m++)
+        {
+            print_hist_row(label, m, stats_hist(stats, q, m), out);
+        }
+    }
+
+    // Percentiles globales: combinacion de los histogramas de todas las colas
+    total = (histogram *)malloc(sizeof(histogram));
+    for (m = 0; m < NMETRICS; m++)
+    {
+        hist_reset(total);
+        for (q = 0; q < stats->nqueues; q++)
+        {
+            hist_merge(total, stats_hist(stats, q, m));
+        }
+        print_hist_row("Total", m, total, out);
+    }
+    free(total);
+
+    // Throughput: agrupar los intervalos usados en pocas filas
+    last_bin = -1;
+    for (i = 0; i < THROUGHPUT_BINS; i++)
+    {
+        if (stats->throughput.bins[i] != 0)
+        {
+            last_bin = i;
+        }
+    }
+    if (last_bin < 0)
+    {
+        return;
+    }
+
+    row_width = 1;
+    while ((last_bin + row_width) / row_width > THROUGHPUT_PRINT_ROWS)
+    {
+        row_width *= 2;
+    }
+    nrows = (last_bin + row_width) / row_width;
+    memset(rows, 0, sizeof(rows));
+    for (i = 0; i <= last_bin; i++)
+    {
+        rows[i / row_width] += stats->throughput.bins[i];
+    }
+
+    fprintf(out, "\nThroughput (procesos finalizados por intervalo):\n");
+    row_width *= stats->throughput.width;
+    for (i = 0; i < nrows; i++)
+    {
+        snprintf(label, sizeof(label), "[%lld, %lld)", i * row_width, (i + 1) * row_width);
+        fprintf(out, "%24s%10lld\n", label, rows[i]);
+    }
+}
+
+int write_stats(sched_stats *stats, FILE *file)
+{
+    histogram *h;
+    uint32_t u32;
+    uint32_t nonzero;
+    int i, b;
+
+    fwrite(stats_magic, sizeof(stats_magic), 1, file);
+    u32 = stats->nqueues;
+    fwrite(&u32, sizeof(u32), 1, file);
+
+    for (i = 0; i < stats->nqueues * NMETRICS; i++)
+    {
+        h = &stats->hist[i];
+        fwrite(&h->count, sizeof(h->count), 1, file);
+        fwrite(&h->min, sizeof(h->min), 1, file);
+        fwrite(&h->max, sizeof(h->max), 1, file);
+        fwrite(&h->sum, sizeof(h->sum), 1, file);
+
+        // Solo los contadores no nulos: (indice, contador)
+        nonzero = 0;
+        for (b = 0; b < HIST_BUCKETS; b++)
+        {
+            nonzero += (h->counts[b] != 0);
+        }
+        fwrite(&nonzero, sizeof(nonzero), 1, file);
+        for (b = 0; b < HIST_BUCKETS; b++)
+        {
+            if (h->counts[b] != 0)
+            {
+                u32 = b;
+                fwrite(&u32, sizeof(u32), 1, file);
+                fwrite(&h->counts[b], sizeof(h->counts[b]), 1, file);
+            }
+        }
+    }
+
+    fwrite(&stats->throughput, sizeof(throughput_series), 1, file);
+
+    return !ferror(file);
+}
+
+sched_stats *read_stats(FILE *file)
+{
+    sched_stats *stats;
+    histogram *h;
+    char magic[sizeof(stats_magic)];
+    uint32_t nqueues;
+    uint32_t nonzero;
+    uint32_t b;
+    long long count;
+    uint32_t i, k;
+
+    if (fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, stats_magic, sizeof(magic)) != 0 ||
+        fread(&nqueues, sizeof(nqueues), 1, file) != 1)
+    {
+        return NULL;
+    }
+
+    stats = create_stats(nqueues);
+
+    for (i = 0; i < nqueues * NMETRICS; i++)
+    {
+        h = &stats->hist[i];
+        if (fread(&h->count, sizeof(h->count), 1, file) != 1 ||
+            fread(&h->min, sizeof(h->min), 1, file) != 1 ||
+            fread(&h->max, sizeof(h->max), 1, file) != 1 ||
+            fread(&h->sum, sizeof(h->sum), 1, file) != 1 ||
+            fread(&nonzero, sizeof(nonzero), 1, file) != 1)
+        {
+            destroy_stats(stats);
+            return NULL;
+        }
+        for (k = 0; k < nonzero; k++)
+        {
+            if (fread(&b, sizeof(b), 1, file) != 1 ||
+                fread(&count, sizeof(count), 1, file) != 1 ||
+                b >= HIST_BUCKETS)
+            {
+                destroy_stats(stats);
+                return NULL;
+            }
+            h->counts[b] = count;
+        }
+    }
+
+    if (fread(&stats->throughput, sizeof(throughput_series), 1, file) != 1)
+    {
+        destroy_stats(stats);
+        return NULL;
+    }
+
+    return stats;
+}
+
+static int bucket_index(long long value)
+{
+    int magnitude;
+    int shift;
+
+    if (value < HIST_SUB_BUCKETS)
+    {
+        return (int)value;
+    }
+
+    // Potencia de dos del valor, y sus HIST_SUB_BITS bits siguientes
+    magnitude = 63 - __builtin_clzll((unsigned long long)value);
+    shift = magnitude - HIST_SUB_BITS;
+    return HIST_SUB_BUCKETS * (shift + 1) + (int)((value >> shift) - HIST_SUB_BUCKETS);
+}
+
+static long long bucket_highest(int index)
+{
+    int shift;
+    long long sub;
+
+    if (index < HIST_SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    shift = index / HIST_SUB_BUCKETS - 1;
+    sub = index % HIST_SUB_BUCKETS + HIST_SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+static void print_hist_row(char *label, latency_metric metric, const histogram *h, FILE *out)
+{
+    int i;
+
+    fprintf(out, "%8s%12s%10lld%10.2f", label, metric_names[metric], h->count, hist_mean(h));
+    for (i = 0; i < (int)(sizeof(reported_percentiles) / sizeof(reported_percentiles[0])); i++)
+    {
+        fprintf(out, "%10lld", hist_percentile(h, reported_percentiles[i]));
+    }
+    fprintf(out, "%10lld\n", h->count > 0 ? h->max : 0);
+}
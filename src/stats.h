@@ -0,0 +1,237 @@
+/**
+ * @file
+ * @brief Estadisticas de latencia de la simulacion.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Los percentiles se calculan con histogramas log-lineales (estilo HDR):
+ * los valores menores que HIST_SUB_BUCKETS se registran exactos, y cada
+ * potencia de dos por encima se divide en HIST_SUB_BUCKETS sub-buckets, lo
+ * que da un error relativo menor que 1/HIST_SUB_BUCKETS. Cada histograma
+ * ocupa memoria constante sin importar la cantidad de muestras, y dos
+ * histogramas se combinan sumando sus contadores.
+ *
+ * Para medir el estado estacionario, las medias por lotes (batch means)
+ * agrupan las muestras consecutivas en lotes de tamano fijo: las medias de
+ * lotes suficientemente grandes son aproximadamente independientes, y su
+ * dispersion da un intervalo de confianza de la media.
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+/** @brief Bits de precision de los sub-buckets */
+#define HIST_SUB_BITS 7
+
+/** @brief Cantidad de sub-buckets por potencia de dos */
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+
+/** @brief Cantidad total de buckets (valores de 0 a 2^63 - 1) */
+#define HIST_BUCKETS (HIST_SUB_BUCKETS * (64 - HIST_SUB_BITS))
+
+/** @brief Cantidad de intervalos de la serie de throughput */
+#define THROUGHPUT_BINS 64
+
+/** @brief Histograma de latencias */
+typedef struct
+{
+    long long count;                /*!< Cantidad de muestras */
+    long long min;                  /*!< Valor minimo registrado */
+    long long max;                  /*!< Valor maximo registrado */
+    double sum;                     /*!< Suma de las muestras */
+    long long counts[HIST_BUCKETS]; /*!< Contadores por bucket */
+} histogram;
+
+/**
+ * @brief Serie de procesos finalizados por intervalo de tiempo.
+ *
+ * Usa THROUGHPUT_BINS intervalos de igual ancho desde t = 0. Cuando llega
+ * un tiempo fuera del rango, el ancho se duplica y los intervalos se
+ * combinan de a pares, de modo que la memoria es constante.
+ */
+typedef struct
+{
+    long long width;                 /*!< Ancho de cada intervalo */
+    long long bins[THROUGHPUT_BINS]; /*!< Procesos finalizados por intervalo */
+} throughput_series;
+
+/** @brief Medias por lotes de una metrica */
+typedef struct
+{
+    long size;      /*!< Muestras por lote */
+    long pending;   /*!< Muestras del lote en curso */
+    double partial; /*!< Suma del lote en curso */
+    long count;     /*!< Muestras registradas */
+    double total;   /*!< Suma de todas las muestras */
+    long batches;   /*!< Lotes completos */
+    double sum;     /*!< Suma de las medias de los lotes */
+    double sumsq;   /*!< Suma de los cuadrados de las medias de los lotes */
+} batch_means;
+
+/** @brief Lotes minimos para estimar el intervalo de confianza */
+#define BATCH_MIN_BATCHES 10
+
+/** @brief Muestras por lote por defecto */
+#define BATCH_DEFAULT_SIZE 1000
+
+/** @brief Metricas de latencia */
+typedef enum
+{
+    METRIC_WAITING,    /*!< Tiempo de espera */
+    METRIC_TURNAROUND, /*!< Tiempo de retorno (finalizacion - llegada) */
+    METRIC_RESPONSE,   /*!< Tiempo de respuesta (primera CPU - llegada) */
+    NMETRICS
+} latency_metric;
+
+/** @brief Estadisticas de latencia por cola de prioridad */
+typedef struct
+{
+    int nqueues;                  /*!< Cantidad de colas */
+    histogram *hist;              /*!< nqueues * NMETRICS histogramas */
+    throughput_series throughput; /*!< Procesos finalizados en el tiempo */
+} sched_stats;
+
+/**
+ * @brief Reinicia un histograma.
+ * @param h Histograma
+ */
+void hist_reset(histogram *h);
+
+/**
+ * @brief Registra una muestra en un histograma.
+ * @param h Histograma
+ * @param value Valor (los negativos se registran como 0)
+ */
+void hist_record(histogram *h, long long value);
+
+/**
+ * @brief Suma los contadores de src en dst.
+ * @param dst Histograma destino
+ * @param src Histograma origen
+ */
+void hist_merge(histogram *dst, const histogram *src);
+
+/**
+ * @brief Obtiene el valor de un percentil.
+ * @param h Histograma
+ * @param percentile Percentil (0 a 100)
+ * @return Mayor valor equivalente al bucket del percentil, o 0 si no hay muestras.
+ */
+long long hist_percentile(const histogram *h, double percentile);
+
+/**
+ * @brief Obtiene la media de las muestras.
+ * @param h Histograma
+ * @return Media, o 0 si no hay muestras.
+ */
+double hist_mean(const histogram *h);
+
+/**
+ * @brief Reinicia las medias por lotes.
+ * @param b Medias por lotes
+ * @param size Muestras por lote
+ */
+void batch_reset(batch_means *b, long size);
+
+/**
+ * @brief Registra una muestra.
+ * @param b Medias por lotes
+ * @param value Valor
+ * @return 1 si la muestra completo un lote, 0 en caso contrario.
+ */
+int batch_record(batch_means *b, double value);
+
+/**
+ * @brief Obtiene la media de las medias de los lotes completos.
+ * @param b Medias por lotes
+ * @return Media, o la media de todas las muestras si no hay lotes completos.
+ */
+double batch_mean(const batch_means *b);
+
+/**
+ * @brief Obtiene el semiancho del intervalo de confianza del 95% de la media.
+ * @param b Medias por lotes
+ * @return Semiancho (t de Student con lotes - 1 grados de libertad), o -1
+ * si hay menos de BATCH_MIN_BATCHES lotes.
+ */
+double batch_half_width(const batch_means *b);
+
+/**
+ * @brief Crea las estadisticas para un conjunto de colas.
+ * @param nqueues Cantidad de colas de prioridad
+ * @return Nuevas estadisticas vacias.
+ */
+sched_stats *create_stats(int nqueues);
+
+/**
+ * @brief Libera las estadisticas.
+ * @param stats Estadisticas
+ */
+void destroy_stats(sched_stats *stats);
+
+/**
+ * @brief Reinicia las estadisticas.
+ * @param stats Estadisticas
+ */
+void stats_reset(sched_stats *stats);
+
+/**
+ * @brief Obtiene el histograma de una metrica de una cola.
+ * @param stats Estadisticas
+ * @param queue Cola (0-based)
+ * @param metric Metrica
+ * @return Histograma
+ */
+histogram *stats_hist(sched_stats *stats, int queue, latency_metric metric);
+
+/**
+ * @brief Registra la finalizacion de un proceso.
+ * @param stats Estadisticas
+ * @param queue Cola del proceso (0-based)
+ * @param waiting Tiempo de espera
+ * @param turnaround Tiempo de retorno
+ * @param finished_time Tiempo de finalizacion
+ */
+void stats_record_finish(sched_stats *stats, int queue, long long waiting,
+                         long long turnaround, long long finished_time);
+
+/**
+ * @brief Registra la primera asignacion de CPU de un proceso.
+ * @param stats Estadisticas
+ * @param queue Cola del proceso (0-based)
+ * @param response Tiempo de respuesta
+ */
+void stats_record_response(sched_stats *stats, int queue, long long response);
+
+/**
+ * @brief Combina las estadisticas de src en dst (misma cantidad de colas).
+ * @param dst Estadisticas destino
+ * @param src Estadisticas origen
+ * @return 1 si se combinaron, 0 si la cantidad de colas no coincide.
+ */
+int stats_merge(sched_stats *dst, const sched_stats *src);
+
+/**
+ * @brief Imprime los percentiles por cola y globales, y el throughput.
+ * @param stats Estadisticas
+ * @param out Salida
+ */
+void print_stats(sched_stats *stats, FILE *out);
+
+/**
+ * @brief Escribe las estadisticas en formato binario (contadores no nulos).
+ * @param stats Estadisticas
+ * @param file Archivo de salida
+ * @return 1 si se escribieron, 0 en caso de error.
+ */
+int write_stats(sched_stats *stats, FILE *file);
+
+/**
+ * @brief Lee estadisticas escritas con write_stats().
+ * @param file Archivo de entrada
+ * @return Nuevas estadisticas, o NULL en caso de error.
+ */
+sched_stats *read_stats(FILE *file);
+
+#endif
@@ -0,0 +1,339 @@
+/**
+ * @file
+ * @brief Modo de memoria acotada: procesos leidos al llegar y descartados al finalizar.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stream.h"
+#include "split.h"
+#include "util.h"
+
+/** @brief Primera linea del archivo de slices (y version del formato) */
+#define SLICES_HEADER "SCHEDSLICES 1"
+
+/**
+ * @brief Lee lineas de la entrada hasta obtener el siguiente proceso.
+ * @param s Fuente de procesos
+ * @param streaming 1 = la simulacion ya comenzo (solo se aceptan PROCESS)
+ */
+static void read_process(process_stream *s, int streaming);
+
+/**
+ * @brief Indica si una linea es un comando DEFINE.
+ * @param line Linea
+ * @return 1 si el primer campo es DEFINE (en cualquier combinacion de mayusculas).
+ */
+static int is_define(const char *line);
+
+/**
+ * @brief Indica si una slice se cruza con la ventana del diagrama.
+ * @param s Slice
+ * @param opts Opciones del diagrama
+ * @return 1 si se debe graficar, 0 en caso contrario.
+ */
+static int slice_visible(const slice *s, const plot_options *opts);
+
+/**
+ * @brief Agrega a un vector un proceso leido del archivo de slices.
+ * @param processes Vector de procesos
+ * @param p Proceso, o NULL
+ * @param opts Opciones del diagrama (con ventana, se descartan los procesos sin slices)
+ */
+static void keep_process(process_vector *processes, process *p, const plot_options *opts);
+
+/**
+ * @brief Libera los procesos de una cola doble.
+ * @param deque Cola, o NULL si nunca se preparo
+ */
+static void destroy_deque_processes(process_deque *deque);
+
+process_stream *create_process_stream(FILE *input, sched_options *opts, char *path)
+{
+    process_stream *s = (process_stream *)calloc(1, sizeof(process_stream));
+
+    s->sink = fopen(path, "w");
+    if (s->sink == NULL)
+    {
+        free(s);
+        return NULL;
+    }
+    s->buffer = (char *)malloc(STREAM_BUFFER_SIZE);
+    setvbuf(s->sink, s->buffer, _IOFBF, STREAM_BUFFER_SIZE);
+    fprintf(s->sink, "%s\n", SLICES_HEADER);
+
+    s->path = path;
+    s->input = input;
+    s->last_arrival = SIM_TIME_MIN;
+    init_process_vector(&s->staged);
+    init_process_vector(&s->spare);
+    init_input(&s->in, &s->staged, opts);
+    s->in.spare = &s->spare;
+
+    // La configuracion precede al primer proceso
+    read_process(s, 0);
+
+    return s;
+}
+
+process *peek_process(process_stream *s)
+{
+    if (s->pending == NULL && !s->done)
+    {
+        read_process(s, 1);
+    }
+    return s->pending;
+}
+
+process *next_process(process_stream *s)
+{
+    process *p = peek_process(s);
+
+    s->pending = NULL;
+    s->live++;
+    if (s->live > s->peak_live)
+    {
+        s->peak_live = s->live;
+    }
+    return p;
+}
+
+void retire_process(process_stream *s, process *p)
+{
+    slice_vector_iterator it;
+
+    s->live--;
+    s->finished++;
+    s->total_waiting += p->waiting_time;
+    s->total_turnaround += p->finished_time - p->arrival_time;
+    s->context_switches += p->context_switches;
+
+    fprintf(s->sink, "P %d %s %d %" PRIsim " %d %" PRIsim " %" PRIsim " %d\n", p->pid,
+            process_name(p), p->priority + 1, p->arrival_time, p->execution_time,
+            p->waiting_time, p->finished_time, p->slices.count);
+    for (it = slice_vector_head(&p->slices); it != 0; it = slice_vector_next(&p->slices, it))
+    {
+        fprintf(s->sink, "%c %" PRIsim " %d %d %d\n", (it->type == CPU) ? 'C' : 'W', it->from,
+                it->length, it->period, it->repeat);
+    }
+
+    // El registro (y la memoria de sus slices) se reutiliza para el siguiente proceso
+    // leido; su nombre deja de usarse y puede ser el del siguiente
+    release_name(p->name);
+    p->name = NAME_EMPTY;
+    process_vector_push_back(&s->spare, p);
+}
+
+void report_stream(process_stream *s, FILE *out)
+{
+    fprintf(out, "Tiempo promedio de espera: %.2f unidades de tiempo\n",
+            (s->finished > 0) ? (double)s->total_waiting / s->finished : 0.0);
+    fprintf(out, "Tiempo promedio de retorno: %.2f unidades de tiempo\n",
+            (s->finished > 0) ? (double)s->total_turnaround / s->finished : 0.0);
+    fprintf(out, "Cambios de contexto: %lld\n", s->context_switches);
+    fprintf(out, "Procesos finalizados: %ld de %ld leidos (maximo %ld en memoria a la vez)\n",
+            s->finished, s->read, s->peak_live);
+    fprintf(out, "Slices de los procesos finalizados: %s\n", s->path);
+    if (s->out_of_order > 0)
+    {
+        fprintf(out, "Advertencia: %ld procesos llegan antes que uno anterior de la entrada "
+                "(debe estar ordenada por llegada)\n", s->out_of_order);
+    }
+}
+
+int destroy_process_stream(process_stream *s, priority_queue *queues, int nqueues)
+{
+    int ok;
+    int i;
+
+    // Procesos sin finalizar si la simulacion paro antes (--ci)
+    for (i = 0; i < nqueues; i++)
+    {
+        destroy_deque_processes(queues[i].ready);
+        destroy_deque_processes(queues[i].arrival);
+    }
+    if (s->pending != NULL)
+    {
+        destroy_process(s->pending);
+    }
+    for (i = 0; i < s->spare.count; i++)
+    {
+        destroy_process(s->spare.items[i]);
+    }
+    free_process_vector(&s->spare);
+    free_process_vector(&s->staged);
+
+    ok = !ferror(s->sink);
+    if (fclose(s->sink) != 0)
+    {
+        ok = 0;
+    }
+    free(s->buffer);
+    free(s);
+
+    return ok;
+}
+
+int read_slices(char *path, const plot_options *opts, process_vector *processes)
+{
+    FILE *file = fopen(path, "r");
+    char *line = NULL;
+    size_t capacity = 0;
+    split_list *parts;
+    process *p = NULL;
+    int count = processes->count;
+    char type;
+    long long from;
+    int length, period, repeat;
+    slice s;
+
+    if (file == NULL)
+    {
+        return -1;
+    }
+    if (getline(&line, &capacity, file) < 0 ||
+        strncmp(line, SLICES_HEADER, strlen(SLICES_HEADER)) != 0)
+    {
+        free(line);
+        fclose(file);
+        return -1;
+    }
+
+    while (getline(&line, &capacity, file) > 0)
+    {
+        if (line[0] == 'P')
+        {
+            // P pid nombre cola llegada tamano espera fin n
+            keep_process(processes, p, opts);
+            p = NULL;
+            parts = split(line, NULL);
+            if (parts->count >= 9)
+            {
+                p = create_process(parts->parts[2], strtoll(parts->parts[4], NULL, 10),
+                                   (sim_delta)atoi(parts->parts[5]));
+                p->pid = atoi(parts->parts[1]);
+                p->priority = atoi(parts->parts[3]) - 1;
+                p->waiting_time = strtoll(parts->parts[6], NULL, 10);
+                p->finished_time = strtoll(parts->parts[7], NULL, 10);
+                p->state = FINISHED;
+            }
+            free_split_list(parts);
+        }
+        else if (p != NULL &&
+                 sscanf(line, "%c %lld %d %d %d", &type, &from, &length, &period, &repeat) == 5)
+        {
+            s.type = (type == 'C') ? CPU : WAIT;
+            s.from = from;
+            s.length = length;
+            s.period = period;
+            s.repeat = repeat;
+            if (slice_visible(&s, opts))
+            {
+                slice_vector_push_back(&p->slices, s);
+            }
+        }
+    }
+    keep_process(processes, p, opts);
+
+    free(line);
+    fclose(file);
+    return processes->count - count;
+}
+
+static void read_process(process_stream *s, int streaming)
+{
+    char line[STREAM_LINE];
+    process *p;
+
+    while (s->pending == NULL && !s->done)
+    {
+        if (fgets(line, sizeof(line), s->input) == NULL)
+        {
+            s->done = 1;
+            break;
+        }
+
+        // Cambiar la configuracion a mitad de la simulacion no tendria sentido
+        if (streaming && is_define(line))
+        {
+            fprintf(s->in.out,
+                    "Error: en el modo de memoria acotada DEFINE va antes del primer PROCESS\n");
+            continue;
+        }
+        if (process_command(&s->in, line))
+        {
+            s->done = 1;
+            break;
+        }
+        if (process_vector_empty(&s->staged))
+        {
+            continue;
+        }
+
+        p = process_vector_pop_back(&s->staged);
+        if (p->task != NULL)
+        {
+            fprintf(s->in.out,
+                    "Error: las tareas periodicas no se admiten en el modo de memoria acotada: %s\n",
+                    process_name(p));
+            destroy_process(p);
+            continue;
+        }
+        if (p->arrival_time < s->last_arrival)
+        {
+            s->out_of_order++;
+        }
+        else
+        {
+            s->last_arrival = p->arrival_time;
+        }
+        s->read++;
+        s->pending = p;
+    }
+}
+
+static int is_define(const char *line)
+{
+    char command[8] = "";
+
+    return sscanf(line, "%7s", command) == 1 && equals(lcase(command), "define");
+}
+
+static int slice_visible(const slice *s, const plot_options *opts)
+{
+    if (!opts->window)
+    {
+        return 1;
+    }
+    return s->repeat > 0 && s->from < opts->to && slice_last_end(s) > opts->from;
+}
+
+static void keep_process(process_vector *processes, process *p, const plot_options *opts)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    if (opts->window && slice_vector_empty(&p->slices))
+    {
+        destroy_process(p);
+        return;
+    }
+    process_vector_push_back(processes, p);
+}
+
+static void destroy_deque_processes(process_deque *deque)
+{
+    if (deque == NULL)
+    {
+        return;
+    }
+    while (!process_deque_empty(deque))
+    {
+        destroy_process(process_deque_pop_front(deque));
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Modo de memoria acotada: procesos leidos al llegar y descartados al finalizar.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Sin este modo, el vector de procesos, las colas de finalizados y las
+ * slices de cada proceso se conservan hasta el final del programa, de modo
+ * que la memoria crece con la cantidad de procesos de la entrada. En el modo
+ * de memoria acotada (--bounded):
+ *
+ * - La configuracion (DEFINE) se lee antes de simular, hasta el primer
+ *   PROCESS; los procesos se leen de la entrada durante la simulacion, solo
+ *   cuando el tiempo simulado alcanza su llegada. La entrada debe estar
+ *   ordenada por llegada.
+ * - Al finalizar un proceso, su espera, retorno y cambios de contexto se
+ *   suman a los agregados del reporte (los percentiles ya se acumulan en
+ *   histogramas, ver stats.h), sus slices se escriben en un archivo y su
+ *   registro vuelve a una lista libre, de donde se toma para el siguiente
+ *   proceso leido (conservando la memoria de sus slices).
+ * - No se registra la secuencia de ejecucion.
+ *
+ * - El nombre del proceso se devuelve a la tabla de nombres (ver
+ *   release_name() en intern.h), que reutiliza su identificador y su cadena.
+ *
+ * Asi, la memoria es proporcional a los procesos que estan a la vez en el
+ * sistema (llegados y sin finalizar), no al total, tambien con nombres
+ * distintos.
+ *
+ * Archivo de slices (texto): la linea "SCHEDSLICES 1" y, por cada proceso
+ * finalizado, una linea "P pid nombre cola llegada tamano espera fin n"
+ * seguida de sus n slices "C|W desde duracion periodo repeticiones".
+ * read_slices() lo lee de nuevo para graficarlo (--plot-slices).
+ */
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+
+#include "input.h"
+#include "plot.h"
+#include "sched.h"
+
+/** @brief Longitud maxima de una linea de la entrada */
+#define STREAM_LINE 1024
+
+/** @brief Tamano del buffer de escritura del archivo de slices (bytes) */
+#define STREAM_BUFFER_SIZE (1 << 20)
+
+/** @brief Procesos que se leen durante la simulacion */
+struct process_stream
+{
+    input_state in;             /*!< Lectura de comandos (colas, opciones y PROCESS) */
+    process_vector staged;      /*!< Procesos recien leidos por process_command() */
+    process_vector spare;       /*!< Registros de procesos finalizados para reutilizar */
+    FILE *input;                /*!< Entrada de la que se leen los procesos */
+    process *pending;           /*!< Siguiente proceso leido y aun no entregado, o NULL */
+    int done;                   /*!< 1 si la entrada termino (START o fin de archivo) */
+    sim_time last_arrival;      /*!< Llegada del ultimo proceso leido */
+    char *path;                 /*!< Ruta del archivo de slices */
+    FILE *sink;                 /*!< Archivo de slices */
+    char *buffer;               /*!< Buffer de escritura del archivo de slices */
+    long read;                  /*!< Procesos leidos */
+    long live;                  /*!< Procesos entregados a la simulacion sin finalizar */
+    long peak_live;             /*!< Maximo de procesos entregados sin finalizar a la vez */
+    long finished;              /*!< Procesos finalizados */
+    long out_of_order;          /*!< Procesos que llegan antes que el proceso anterior */
+    long long total_waiting;    /*!< Suma de tiempos de espera */
+    long long total_turnaround; /*!< Suma de tiempos de retorno */
+    long long context_switches; /*!< Suma de cambios de contexto */
+};
+
+/**
+ * @brief Lee la configuracion de la entrada hasta el primer proceso.
+ *
+ * Ejecuta los comandos (DEFINE) con process_command() hasta el primer
+ * PROCESS, que queda como siguiente proceso por entregar. Las tareas
+ * periodicas no se admiten en este modo y se descartan con un error.
+ * @param input Entrada (normalmente stdin)
+ * @param opts Opciones de la simulacion (DEFINE cpus, DEFINE migration)
+ * @param path Ruta del archivo de slices
+ * @return Nueva fuente de procesos (las colas quedan en in.queues e in.nqueues),
+ *         o NULL si no se pudo crear el archivo de slices.
+ */
+process_stream *create_process_stream(FILE *input, sched_options *opts, char *path);
+
+/**
+ * @brief Obtiene el siguiente proceso por entregar, leyendolo si hace falta.
+ * @param s Fuente de procesos
+ * @return Proceso (sigue siendo de la fuente), o NULL si la entrada termino.
+ */
+process *peek_process(process_stream *s);
+
+/**
+ * @brief Entrega el siguiente proceso a la simulacion.
+ * @param s Fuente de procesos (peek_process() no es NULL)
+ * @return Proceso, que vuelve a la fuente con retire_process().
+ */
+process *next_process(process_stream *s);
+
+/**
+ * @brief Agrega las metricas de un proceso finalizado, escribe sus slices y
+ * guarda su registro para reutilizarlo.
+ * @param s Fuente de procesos
+ * @param p Proceso finalizado (fuera de las colas)
+ */
+void retire_process(process_stream *s, process *p);
+
+/**
+ * @brief Imprime la espera media y los procesos leidos, finalizados y en memoria.
+ * @param s Fuente de procesos
+ * @param out Salida
+ */
+void report_stream(process_stream *s, FILE *out);
+
+/**
+ * @brief Libera la fuente, los procesos que quedaron en las colas (parada
+ * por intervalo de confianza) y cierra el archivo de slices.
+ * @param s Fuente de procesos
+ * @param queues Colas de prioridad (no se liberan)
+ * @param nqueues Cantidad de colas
+ * @return 1 si el archivo de slices se escribio completo, 0 en caso contrario.
+ */
+int destroy_process_stream(process_stream *s, priority_queue *queues, int nqueues);
+
+/**
+ * @brief Lee un archivo de slices para graficarlo.
+ *
+ * Con una ventana (opts->window), solo conserva las slices que se cruzan con
+ * [from, to) y los procesos que tienen alguna, de modo que la memoria es
+ * proporcional a la ventana y no al archivo.
+ * @param path Ruta del archivo de slices
+ * @param opts Opciones del diagrama
+ * @param processes Vector donde se agregan los procesos
+ * @return Cantidad de procesos agregados, o -1 si el archivo no existe o no es valido.
+ */
+int read_slices(char *path, const plot_options *opts, process_vector *processes);
+
+#endif
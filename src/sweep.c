@@ -0,0 +1,904 @@
+/**
+ * @file
+ * @brief Barrido de parametros con un coordinador y trabajadores.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <poll.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "sweep.h"
+#include "context.h"
+#include "sched.h"
+#include "split.h"
+#include "stats.h"
+#include "trace.h"
+#include "util.h"
+
+extern char **environ;
+
+/** @brief Longitud maxima de un mensaje de texto */
+#define MESSAGE_SIZE 4096
+
+/** @brief Cantidad maxima de trabajadores conectados */
+#define MAX_WORKERS 256
+
+/** @brief Lector con buffer de un socket */
+typedef struct
+{
+    int fd;                  /*!< Descriptor del socket */
+    char buf[MESSAGE_SIZE];  /*!< Datos recibidos */
+    int pos;                 /*!< Posicion de lectura */
+    int len;                 /*!< Bytes validos en buf */
+} reader;
+
+/** @brief Estado de una configuracion del barrido */
+typedef enum
+{
+    JOB_PENDING, /*!< Sin asignar */
+    JOB_RUNNING, /*!< Asignada a un trabajador */
+    JOB_DONE     /*!< Resultado recibido */
+} job_state;
+
+/** @brief Configuracion del barrido y su resultado */
+typedef struct
+{
+    char *spec;               /*!< Colas de la configuracion ("RR:5 FIFO") */
+    int nqueues;              /*!< Cantidad de colas */
+    job_state state;          /*!< Estado */
+    int ok;                   /*!< 1 = el trabajador pudo ejecutarla */
+    int nprocesses;           /*!< Procesos simulados */
+    long long total_time;     /*!< Tiempo total de la simulacion */
+    long long total_waiting;  /*!< Suma de los tiempos de espera */
+    long long dispatches;     /*!< Asignaciones de CPU */
+    sched_stats *stats;       /*!< Histogramas de latencia */
+} sweep_job;
+
+/** @brief Trabajador conectado al coordinador */
+typedef struct
+{
+    reader in; /*!< Mensajes del trabajador */
+    int job;   /*!< Configuracion asignada, o -1 */
+} worker_conn;
+
+/**
+ * @brief Interpreta la especificacion de colas de una configuracion.
+ * @param spec Colas en orden de prioridad ("RR:5 RR:4 FIFO")
+ * @param queues Salida: nuevas colas, o NULL para solo validar
+ * @return Cantidad de colas, o 0 si la especificacion no es valida.
+ */
+static int parse_queues(char *spec, priority_queue **queues);
+
+/**
+ * @brief Lee el archivo de configuraciones.
+ * @param path Ruta del archivo
+ * @param count Salida: cantidad de configuraciones
+ * @param report Salida de los errores
+ * @return Configuraciones, o NULL en caso de error.
+ */
+static sweep_job *read_configs(char *path, int *count, FILE *report);
+
+/**
+ * @brief Envia todos los bytes de un buffer.
+ * @param fd Socket
+ * @param data Datos
+ * @param size Cantidad de bytes
+ * @return 1 si se enviaron, 0 en caso de error.
+ */
+static int send_all(int fd, const char *data, size_t size);
+
+/**
+ * @brief Lee una linea (sin el salto de linea).
+ * @param r Lector
+ * @param line Buffer de salida (MESSAGE_SIZE bytes)
+ * @return 1 si se leyo una linea, 0 si se cerro la conexion o hubo error.
+ */
+static int read_line(reader *r, char *line);
+
+/**
+ * @brief Lee exactamente size bytes.
+ * @param r Lector
+ * @param data Buffer de salida
+ * @param size Cantidad de bytes
+ * @return 1 si se leyeron, 0 si se cerro la conexion o hubo error.
+ */
+static int read_exact(reader *r, char *data, size_t size);
+
+/**
+ * @brief Envia la siguiente configuracion pendiente a un trabajador libre.
+ * @param conn Trabajador
+ * @param jobs Configuraciones
+ * @param njobs Cantidad de configuraciones
+ * @param trace_path Ruta absoluta de la traza
+ * @return 1 si se asigno una configuracion, 0 si no hay pendientes o hubo error.
+ */
+static int assign_job(worker_conn *conn, sweep_job *jobs, int njobs, char *trace_path);
+
+/**
+ * @brief Lee el resultado de una configuracion.
+ * @param conn Trabajador
+ * @param line Linea RESULT
+ * @param jobs Configuraciones
+ * @param njobs Cantidad de configuraciones
+ * @return 1 si se leyo el resultado, 0 en caso de error.
+ */
+static int receive_result(worker_conn *conn, char *line, sweep_job *jobs, int njobs);
+
+/**
+ * @brief Imprime los resultados del barrido y las estadisticas combinadas.
+ * @param jobs Configuraciones
+ * @param njobs Cantidad de configuraciones
+ * @param report Salida
+ */
+static void print_sweep(sweep_job *jobs, int njobs, FILE *report);
+
+/**
+ * @brief Ejecuta una configuracion y envia el resultado al coordinador.
+ * @param fd Socket del coordinador
+ * @param id Identificador de la configuracion
+ * @param t Traza proyectada, o NULL si no se pudo abrir
+ * @param spec Colas de la configuracion
+ * @param discard Salida de los mensajes y del reporte de la simulacion (/dev/null)
+ * @return 1 si se envio el resultado, 0 en caso de error.
+ */
+static int run_job(int fd, int id, trace *t, char *spec, FILE *discard);
+
+int run_coordinator(char *config_path, char *trace_path, char *address,
+                    int workers, char *program, FILE *report)
+{
+    sweep_job *jobs;
+    int njobs;
+    worker_conn *conns[MAX_WORKERS];
+    int nconns = 0;
+    struct pollfd fds[MAX_WORKERS + 1];
+    pid_t children[MAX_WORKERS];
+    int nchildren = 0;
+    int alive;
+    char trace_abs[PATH_MAX];
+    char line[MESSAGE_SIZE];
+    char *args[5];
+    trace *t;
+    int listen_fd;
+    int ndone = 0;
+    int status;
+    int ret = 1;
+    int ok;
+    int i, k, n;
+
+    jobs = read_configs(config_path, &njobs, report);
+    if (jobs == NULL)
+    {
+        fprintf(report, "Error: no se pudieron leer las configuraciones de %s\n", config_path);
+        return 1;
+    }
+
+    // Validar la traza antes de lanzar los trabajadores
+    t = open_trace(trace_path);
+    if (t == NULL || realpath(trace_path, trace_abs) == NULL)
+    {
+        fprintf(report, "Error: traza invalida: %s\n", trace_path);
+        close_trace(t);
+        free(jobs);
+        return 1;
+    }
+    fprintf(report, "=== BARRIDO DE PARAMETROS ===\n");
+    fprintf(report, "Traza: %s (%d procesos)\n", trace_abs, t->count);
+    fprintf(report, "Configuraciones: %d\n", njobs);
+    close_trace(t);
+
+    listen_fd = open_socket(address, 1);
+    if (listen_fd < 0)
+    {
+        fprintf(report, "Error: no se pudo escuchar en %s\n", address);
+        free(jobs);
+        return 1;
+    }
+
+    // Lanzar los trabajadores locales
+    if (workers > MAX_WORKERS)
+    {
+        workers = MAX_WORKERS;
+    }
+    args[0] = program;
+    args[1] = "--worker";
+    args[2] = "--socket";
+    args[3] = address;
+    args[4] = NULL;
+    fflush(report);
+    for (i = 0; i < workers; i++)
+    {
+        if (posix_spawnp(&children[nchildren], program, NULL, NULL, args, environ) == 0)
+        {
+            nchildren++;
+        }
+    }
+    fprintf(report, "Trabajadores: %d lanzados, escuchando en %s\n", nchildren, address);
+
+    while (ndone < njobs)
+    {
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (i = 0; i < nconns; i++)
+        {
+            fds[i + 1].fd = conns[i]->in.fd;
+            fds[i + 1].events = POLLIN;
+        }
+
+        n = poll(fds, nconns + 1, 1000);
+        if (n < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (n <= 0)
+        {
+            // Sin trabajadores locales vivos ni conectados no hay quien termine
+            alive = 0;
+            for (i = 0; i < nchildren; i++)
+            {
+                if (children[i] > 0 && waitpid(children[i], &status, WNOHANG) == children[i])
+                {
+                    children[i] = -1;
+                }
+                alive += (children[i] > 0);
+            }
+            if (workers > 0 && alive == 0 && nconns == 0)
+            {
+                fprintf(report, "Error: todos los trabajadores terminaron\n");
+                break;
+            }
+            continue;
+        }
+
+        // Mensajes de los trabajadores que se consultaron en poll()
+        for (i = k = 0; i < nconns; i++)
+        {
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                // Las lineas que ya estan en el buffer (READY seguido de RESULT)
+                // se atienden ahora: poll() no las vuelve a anunciar
+                do
+                {
+                    ok = read_line(&conns[i]->in, line) &&
+                         (strncmp(line, "RESULT ", 7) != 0 ||
+                          receive_result(conns[i], line, jobs, njobs));
+                    ndone += (ok && strncmp(line, "RESULT ", 7) == 0);
+                } while (ok && conns[i]->in.pos < conns[i]->in.len);
+                if (!ok)
+                {
+                    // Trabajador perdido: devolver su configuracion
+                    if (conns[i]->job >= 0 && jobs[conns[i]->job].state == JOB_RUNNING)
+                    {
+                        jobs[conns[i]->job].state = JOB_PENDING;
+                    }
+                    close(conns[i]->in.fd);
+                    free(conns[i]);
+                    continue;
+                }
+            }
+            conns[k++] = conns[i];
+        }
+        nconns = k;
+
+        // Nuevos trabajadores
+        if ((fds[0].revents & POLLIN) && nconns < MAX_WORKERS)
+        {
+            k = accept(listen_fd, NULL, NULL);
+            if (k >= 0)
+            {
+                conns[nconns] = (worker_conn *)malloc(sizeof(worker_conn));
+                memset(conns[nconns], 0, sizeof(worker_conn));
+                conns[nconns]->in.fd = k;
+                conns[nconns]->job = -1;
+                nconns++;
+            }
+        }
+
+        // Repartir las configuraciones pendientes entre los trabajadores libres
+        for (i = 0; i < nconns; i++)
+        {
+            if (conns[i]->job < 0)
+            {
+                assign_job(conns[i], jobs, njobs, trace_abs);
+            }
+        }
+    }
+
+    if (ndone == njobs)
+    {
+        ret = 0;
+    }
+
+    // Terminar los trabajadores
+    for (i = 0; i < nconns; i++)
+    {
+        send_all(conns[i]->in.fd, "QUIT\n", 5);
+        close(conns[i]->in.fd);
+        free(conns[i]);
+    }
+    close(listen_fd);
+    if (strncmp(address, "tcp:", 4) != 0)
+    {
+        unlink(address);
+    }
+    for (i = 0; i < nchildren; i++)
+    {
+        if (children[i] > 0)
+        {
+            waitpid(children[i], &status, 0);
+        }
+    }
+
+    if (ret == 0)
+    {
+        print_sweep(jobs, njobs, report);
+    }
+
+    for (i = 0; i < njobs; i++)
+    {
+        free(jobs[i].spec);
+        if (jobs[i].stats != NULL)
+        {
+            destroy_stats(jobs[i].stats);
+        }
+    }
+    free(jobs);
+
+    return ret;
+}
+
+int run_worker(char *address)
+{
+    reader in;
+    char line[MESSAGE_SIZE];
+    char path[PATH_MAX];
+    char spec[MESSAGE_SIZE];
+    trace *t = NULL;
+    FILE *discard;
+    size_t path_len, spec_len;
+    int id;
+
+    memset(&in, 0, sizeof(reader));
+    in.fd = open_socket(address, 0);
+    if (in.fd < 0)
+    {
+        fprintf(stderr, "Error: no se pudo conectar a %s\n", address);
+        return 1;
+    }
+
+    // La simulacion es muy detallada: sus salidas se descartan
+    discard = fopen("/dev/null", "w");
+    if (discard == NULL)
+    {
+        fprintf(stderr, "Error: no se pudo abrir /dev/null\n");
+        close(in.fd);
+        return 1;
+    }
+
+    if (!send_all(in.fd, "READY\n", 6))
+    {
+        fclose(discard);
+        close(in.fd);
+        return 1;
+    }
+
+    while (read_line(&in, line))
+    {
+        if (strcmp(line, "QUIT") == 0)
+        {
+            break;
+        }
+        if (sscanf(line, "RUN %d %zu %zu", &id, &path_len, &spec_len) != 3)
+        {
+            continue;
+        }
+        // El coordinador no envia campos mas largos: el flujo ya no es valido
+        if (path_len >= sizeof(path) || spec_len >= sizeof(spec) ||
+            !read_exact(&in, path, path_len) || !read_exact(&in, spec, spec_len))
+        {
+            fprintf(stderr, "Error: mensaje RUN invalido\n");
+            break;
+        }
+        path[path_len] = '\0';
+        spec[spec_len] = '\0';
+
+        // La traza se proyecta una sola vez mientras no cambie
+        if (t == NULL || strcmp(t->path, path) != 0)
+        {
+            close_trace(t);
+            t = open_trace(path);
+        }
+
+        if (!run_job(in.fd, id, t, spec, discard))
+        {
+            break;
+        }
+    }
+
+    close_trace(t);
+    fclose(discard);
+    close(in.fd);
+    return 0;
+}
+
+static int parse_queues(char *spec, priority_queue **queues)
+{
+    split_list *parts;
+    char *sep;
+    int nqueues;
+    int i;
+
+    parts = split(spec, NULL);
+    nqueues = parts->count;
+    if (queues != NULL && nqueues > 0)
+    {
+        *queues = create_queues(nqueues);
+    }
+
+    for (i = 0; i < parts->count; i++)
+    {
+        // estrategia[:quantum]
+        sep = strchr(parts->parts[i], ':');
+        if (sep != NULL)
+        {
+            *sep++ = '\0';
+        }
+        lcase(parts->parts[i]);
+        if ((!equals(parts->parts[i], "rr") && !equals(parts->parts[i], "fifo")) ||
+            (equals(parts->parts[i], "rr") && (sep == NULL || atoi(sep) <= 0)))
+        {
+            nqueues = 0;
+            break;
+        }
+        if (queues != NULL)
+        {
+            (*queues)[i].strategy = equals(parts->parts[i], "rr") ? RR : FIFO;
+            (*queues)[i].quantum = (sep != NULL) ? atoi(sep) : 0;
+        }
+    }
+
+    if (nqueues == 0 && queues != NULL && parts->count > 0)
+    {
+        destroy_queues(*queues, parts->count);
+        *queues = NULL;
+    }
+    free_split_list(parts);
+
+    return nqueues;
+}
+
+static sweep_job *read_configs(char *path, int *count, FILE *report)
+{
+    FILE *file;
+    sweep_job *jobs = NULL;
+    char line[MESSAGE_SIZE];
+    char *spec;
+    int capacity = 0;
+    int nqueues;
+
+    *count = 0;
+    file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    while (fgets(line, sizeof(line), file))
+    {
+        // Una linea que no cabe se descarta completa (truncarla cambiaria las colas)
+        if (strchr(line, '\n') == NULL && !feof(file))
+        {
+            fprintf(report, "Error: linea de configuracion demasiado larga (maximo %d caracteres)\n",
+                    MESSAGE_SIZE - 2);
+            while (fgets(line, sizeof(line), file) && strchr(line, '\n') == NULL)
+            {
+            }
+            continue;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        spec = find_first_not_of(line, " \t");
+        if (spec == NULL || *spec == '\0' || *spec == '#')
+        {
+            continue;
+        }
+
+        // CONFIG colas...
+        if (strncasecmp(spec, "config", 6) != 0)
+        {
+            fprintf(report, "Error: linea de configuracion invalida: %s\n", line);
+            continue;
+        }
+        spec = find_first_not_of(spec + 6, " \t");
+        nqueues = (spec != NULL) ? parse_queues(spec, NULL) : 0;
+        if (nqueues == 0)
+        {
+            fprintf(report, "Error: colas invalidas: %s (use RR:quantum o FIFO)\n", line);
+            continue;
+        }
+
+        if (*count == capacity)
+        {
+            capacity = (capacity > 0) ? capacity * 2 : 16;
+            jobs = (sweep_job *)realloc(jobs, sizeof(sweep_job) * capacity);
+        }
+        memset(&jobs[*count], 0, sizeof(sweep_job));
+        jobs[*count].spec = concat(spec, "");
+        jobs[*count].nqueues = nqueues;
+        jobs[*count].state = JOB_PENDING;
+        (*count)++;
+    }
+    fclose(file);
+
+    if (*count == 0)
+    {
+        free(jobs);
+        return NULL;
+    }
+    return jobs;
+}
+
+int open_socket(char *address, int listening)
+{
+    struct sockaddr_un un;
+    struct sockaddr_in in;
+    struct sockaddr *addr;
+    socklen_t addr_len;
+    int fd, one = 1;
+
+    if (strncmp(address, "tcp:", 4) == 0)
+    {
+        // Solo localhost
+        memset(&in, 0, sizeof(in));
+        in.sin_family = AF_INET;
+        in.sin_port = htons(atoi(address + 4));
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr = (struct sockaddr *)&in;
+        addr_len = sizeof(in);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && listening)
+        {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        }
+    }
+    else
+    {
+        if (strlen(address) >= sizeof(un.sun_path))
+        {
+            return -1;
+        }
+        memset(&un, 0, sizeof(un));
+        un.sun_family = AF_UNIX;
+        strcpy(un.sun_path, address);
+        addr = (struct sockaddr *)&un;
+        addr_len = sizeof(un);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listening)
+        {
+            unlink(address);
+        }
+    }
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (listening)
+    {
+        if (bind(fd, addr, addr_len) != 0 || listen(fd, MAX_WORKERS) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    else if (connect(fd, addr, addr_len) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int send_all(int fd, const char *data, size_t size)
+{
+    ssize_t n;
+
+    while (size > 0)
+    {
+        n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return 0;
+        }
+        data += n;
+        size -= n;
+    }
+    return 1;
+}
+
+static int read_line(reader *r, char *line)
+{
+    int len = 0;
+    ssize_t n;
+
+    for (;;)
+    {
+        if (r->pos == r->len)
+        {
+            n = recv(r->fd, r->buf, sizeof(r->buf), 0);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return 0;
+            }
+            r->pos = 0;
+            r->len = n;
+        }
+        if (r->buf[r->pos] == '\n')
+        {
+            r->pos++;
+            line[len] = '\0';
+            return 1;
+        }
+        if (len == MESSAGE_SIZE - 1)
+        {
+            return 0;
+        }
+        line[len++] = r->buf[r->pos++];
+    }
+}
+
+static int read_exact(reader *r, char *data, size_t size)
+{
+    size_t chunk;
+    ssize_t n;
+
+    while (size > 0)
+    {
+        if (r->pos == r->len)
+        {
+            n = recv(r->fd, r->buf, sizeof(r->buf), 0);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return 0;
+            }
+            r->pos = 0;
+            r->len = n;
+        }
+        chunk = min((size_t)(r->len - r->pos), size);
+        memcpy(data, r->buf + r->pos, chunk);
+        r->pos += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    return 1;
+}
+
+static int assign_job(worker_conn *conn, sweep_job *jobs, int njobs, char *trace_path)
+{
+    char line[MESSAGE_SIZE];
+    size_t path_len = strlen(trace_path);
+    size_t spec_len;
+    int i;
+
+    for (i = 0; i < njobs; i++)
+    {
+        if (jobs[i].state == JOB_PENDING)
+        {
+            // Campos con su longitud: la ruta puede tener espacios
+            spec_len = strlen(jobs[i].spec);
+            snprintf(line, sizeof(line), "RUN %d %zu %zu\n", i, path_len, spec_len);
+            if (!send_all(conn->in.fd, line, strlen(line)) ||
+                !send_all(conn->in.fd, trace_path, path_len) ||
+                !send_all(conn->in.fd, jobs[i].spec, spec_len))
+            {
+                return 0;
+            }
+            jobs[i].state = JOB_RUNNING;
+            conn->job = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int receive_result(worker_conn *conn, char *line, sweep_job *jobs, int njobs)
+{
+    sweep_job *job;
+    sweep_job r;
+    FILE *file;
+    char *data;
+    size_t size;
+    int id;
+
+    memset(&r, 0, sizeof(r));
+    if (sscanf(line, "RESULT %d %d %d %lld %lld %lld %zu", &id, &r.ok, &r.nprocesses,
+               &r.total_time, &r.total_waiting, &r.dispatches, &size) != 7 ||
+        id != conn->job || id < 0 || id >= njobs)
+    {
+        return 0;
+    }
+
+    data = (char *)malloc(size > 0 ? size : 1);
+    if (!read_exact(&conn->in, data, size))
+    {
+        free(data);
+        return 0;
+    }
+
+    job = &jobs[id];
+    if (r.ok && size > 0)
+    {
+        file = fmemopen(data, size, "rb");
+        r.stats = (file != NULL) ? read_stats(file) : NULL;
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        r.ok = (r.stats != NULL && r.stats->nqueues == job->nqueues);
+    }
+    free(data);
+
+    if (job->state != JOB_DONE)
+    {
+        job->ok = r.ok;
+        job->nprocesses = r.nprocesses;
+        job->total_time = r.total_time;
+        job->total_waiting = r.total_waiting;
+        job->dispatches = r.dispatches;
+        job->stats = r.ok ? r.stats : NULL;
+        job->state = JOB_DONE;
+        r.stats = r.ok ? NULL : r.stats;
+    }
+    if (r.stats != NULL)
+    {
+        destroy_stats(r.stats);
+    }
+
+    conn->job = -1;
+    return 1;
+}
+
+static void print_sweep(sweep_job *jobs, int njobs, FILE *report)
+{
+    sched_stats *merged;
+    histogram total;
+    int merged_count;
+    int i, j, q;
+
+    fprintf(report, "\n=== RESULTADOS DEL BARRIDO ===\n");
+    fprintf(report, "%4s  %-24s%12s%14s%14s%10s%10s\n",
+            "#", "Colas", "T. total", "Espera prom.", "Asignaciones", "p50 ret.", "p99 ret.");
+    fprintf(report, "------------------------------------------------------------------------------------------\n");
+    for (i = 0; i < njobs; i++)
+    {
+        if (!jobs[i].ok)
+        {
+            fprintf(report, "%4d  %-24s%12s\n", i + 1, jobs[i].spec, "error");
+            continue;
+        }
+
+        // Retorno de todas las colas de la configuracion
+        hist_reset(&total);
+        for (q = 0; q < jobs[i].nqueues; q++)
+        {
+            hist_merge(&total, stats_hist(jobs[i].stats, q, METRIC_TURNAROUND));
+        }
+        fprintf(report, "%4d  %-24s%12lld%14.2f%14lld%10lld%10lld\n",
+                i + 1, jobs[i].spec, jobs[i].total_time,
+                (jobs[i].nprocesses > 0) ? (double)jobs[i].total_waiting / jobs[i].nprocesses : 0.0,
+                jobs[i].dispatches, hist_percentile(&total, 50), hist_percentile(&total, 99));
+    }
+
+    // Combinar los histogramas de las configuraciones con la misma cantidad de colas
+    for (i = 0; i < njobs; i++)
+    {
+        if (!jobs[i].ok)
+        {
+            continue;
+        }
+        for (j = 0; j < i; j++)
+        {
+            if (jobs[j].ok && jobs[j].nqueues == jobs[i].nqueues)
+            {
+                break;
+            }
+        }
+        if (j < i)
+        {
+            continue;
+        }
+
+        merged = create_stats(jobs[i].nqueues);
+        merged_count = 0;
+        for (j = i; j < njobs; j++)
+        {
+            if (jobs[j].ok && stats_merge(merged, jobs[j].stats))
+            {
+                merged_count++;
+            }
+        }
+        fprintf(report, "\nEstadisticas combinadas: %d colas, %d configuraciones\n",
+                jobs[i].nqueues, merged_count);
+        print_stats(merged, report);
+        destroy_stats(merged);
+    }
+}
+
+static int run_job(int fd, int id, trace *t, char *spec, FILE *discard)
+{
+    sched_context ctx;
+    process_vector_iterator it;
+    process *p;
+    char line[MESSAGE_SIZE];
+    char *data = NULL;
+    size_t size = 0;
+    FILE *file;
+    long long total_time = 0, total_waiting = 0, dispatches = 0;
+    int ok = 0;
+    int ret;
+
+    // Cada configuracion es un contexto propio: procesos, colas y estadisticas
+    init_sched_context(&ctx, discard, discard);
+    ctx.opts.quiet = 1;
+    ctx.opts.wait_slices = 0;
+    ctx.nqueues = parse_queues(spec, &ctx.queues);
+    if (t != NULL && ctx.nqueues > 0)
+    {
+        trace_processes(t, ctx.nqueues, ctx.processes);
+        ctx.opts.stats = create_stats(ctx.nqueues);
+        ok = run_sched_context(&ctx);
+    }
+
+    if (ok)
+    {
+        for (it = process_vector_head(ctx.processes); it != 0;
+             it = process_vector_next(ctx.processes, it))
+        {
+            p = *it;
+            total_waiting += p->waiting_time;
+            dispatches += p->context_switches;
+            total_time = (p->finished_time > total_time) ? p->finished_time : total_time;
+        }
+
+        // Estadisticas en el formato de write_stats()
+        file = open_memstream(&data, &size);
+        ok = (file != NULL) && write_stats(ctx.opts.stats, file);
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+    }
+
+    snprintf(line, sizeof(line), "RESULT %d %d %d %lld %lld %lld %zu\n",
+             id, ok, ctx.processes->count, total_time, total_waiting, dispatches,
+             ok ? size : (size_t)0);
+    ret = send_all(fd, line, strlen(line)) && (!ok || send_all(fd, data, size));
+
+    free(data);
+    destroy_sched_context(&ctx);
+
+    return ret;
+}
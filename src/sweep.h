@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief Barrido de parametros con un coordinador y trabajadores.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * El coordinador lee una lista de configuraciones y las reparte entre
+ * trabajadores conectados por un socket Unix o TCP. Cada trabajador
+ * proyecta en memoria la traza binaria (ver trace.h), ejecuta schedule() y
+ * devuelve un resumen y los histogramas de latencia, que el coordinador
+ * combina. Ni el coordinador ni los trabajadores escriben archivos.
+ *
+ * Archivo de configuraciones: una linea por configuracion con las colas en
+ * orden de prioridad, por ejemplo "CONFIG RR:5 RR:4 FIFO". Las lineas vacias
+ * y las que empiezan con '#' se ignoran. Los procesos cuya prioridad supera
+ * la cantidad de colas de una configuracion se asignan a la ultima cola.
+ *
+ * Protocolo (lineas de texto):
+ * - Trabajador: "READY", o "RESULT id ok procesos tiempo espera asignaciones n"
+ *   seguido de n bytes con las estadisticas (ver write_stats()).
+ * - Coordinador: "RUN id a b" seguido de a bytes con la ruta de la traza y
+ *   b bytes con las colas (asi la ruta puede tener espacios), o "QUIT".
+ * Las lineas de configuracion y las rutas que no caben en un mensaje se
+ * rechazan, no se truncan.
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+
+/**
+ * @brief Ejecuta el coordinador de un barrido de parametros.
+ * @param config_path Archivo de configuraciones
+ * @param trace_path Traza binaria de procesos
+ * @param address Direccion: ruta de un socket Unix, o "tcp:puerto"
+ * @param workers Trabajadores a lanzar, o 0 si se lanzan por separado
+ * @param program Programa a lanzar como trabajador (argv[0])
+ * @param report Salida del progreso, los resultados y los errores
+ * @return 0 si se ejecutaron todas las configuraciones, 1 en caso de error.
+ */
+int run_coordinator(char *config_path, char *trace_path, char *address,
+                    int workers, char *program, FILE *report);
+
+/**
+ * @brief Ejecuta un trabajador hasta que el coordinador lo termine.
+ * @param address Direccion del coordinador (ver run_coordinator())
+ * @return 0 si termino normalmente, 1 en caso de error.
+ */
+int run_worker(char *address);
+
+/**
+ * @brief Crea un socket conectado o en escucha para una direccion.
+ * @param address Ruta de un socket Unix, o "tcp:puerto"
+ * @param listening 1 = escuchar, 0 = conectarse
+ * @return Descriptor del socket, o -1 en caso de error.
+ */
+int open_socket(char *address, int listening);
+
+#endif
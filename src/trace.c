@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief Trazas binarias de procesos para barridos de parametros.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+#include "sched.h"
+#include "util.h"
+
+/** @brief Encabezado del archivo de traza */
+static const char trace_magic[8] = {'S', 'C', 'H', 'T', 'R', 'A', 'C', 'E'};
+
+/** @brief Version del formato */
+#define TRACE_VERSION 2
+
+/** @brief Tamano del encabezado (bytes) */
+#define TRACE_HEADER_SIZE (sizeof(trace_magic) + 4 * sizeof(uint32_t))
+
+int write_trace(char *path, process_vector *processes)
+{
+    FILE *file;
+    process_vector_iterator it;
+    process *p;
+    uint32_t header[4];
+    uint32_t offset;
+    int64_t arrival;
+    int32_t value;
+    int column;
+
+    file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    header[0] = TRACE_VERSION;
+    header[1] = processes->count;
+    header[2] = 0;
+    header[3] = 0;
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        header[2] += name_length((*it)->name);
+    }
+    fwrite(trace_magic, sizeof(trace_magic), 1, file);
+    fwrite(header, sizeof(header), 1, file);
+
+    // Columna de llegada (64 bits), luego tamano y prioridad
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        arrival = (*it)->arrival_time;
+        fwrite(&arrival, sizeof(arrival), 1, file);
+    }
+    for (column = 0; column < 2; column++)
+    {
+        for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+        {
+            p = *it;
+            value = (column == 0) ? p->execution_time : p->priority;
+            fwrite(&value, sizeof(value), 1, file);
+        }
+    }
+
+    // Desplazamientos y tabla de nombres
+    offset = 0;
+    fwrite(&offset, sizeof(offset), 1, file);
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        offset += name_length((*it)->name);
+        fwrite(&offset, sizeof(offset), 1, file);
+    }
+    for (it = process_vector_head(processes); it != 0; it = process_vector_next(processes, it))
+    {
+        p = *it;
+        fwrite(process_name(p), 1, name_length(p->name), file);
+    }
+
+    return (fclose(file) == 0);
+}
+
+trace *open_trace(char *path)
+{
+    trace *t;
+    struct stat st;
+    const char *base;
+    const uint32_t *header;
+    size_t expected;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < TRACE_HEADER_SIZE)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    t = (trace *)malloc(sizeof(trace));
+    memset(t, 0, sizeof(trace));
+    t->size = st.st_size;
+    t->map = mmap(NULL, t->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (t->map == MAP_FAILED)
+    {
+        free(t);
+        return NULL;
+    }
+
+    base = (const char *)t->map;
+    header = (const uint32_t *)(base + sizeof(trace_magic));
+    t->count = header[1];
+    expected = TRACE_HEADER_SIZE + (size_t)t->count * (sizeof(int64_t) + 3 * sizeof(int32_t)) +
+               sizeof(uint32_t) + header[2];
+    if (memcmp(base, trace_magic, sizeof(trace_magic)) != 0 ||
+        header[0] != TRACE_VERSION || t->size < expected)
+    {
+        munmap(t->map, t->size);
+        free(t);
+        return NULL;
+    }
+
+    t->arrival = (const int64_t *)(base + TRACE_HEADER_SIZE);
+    t->execution = (const int32_t *)(t->arrival + t->count);
+    t->priority = t->execution + t->count;
+    t->name_off = (const uint32_t *)(t->priority + t->count);
+    t->names = (const char *)(t->name_off + t->count + 1);
+    if (t->name_off[t->count] > header[2])
+    {
+        munmap(t->map, t->size);
+        free(t);
+        return NULL;
+    }
+    t->path = concat(path, "");
+
+    return t;
+}
+
+void close_trace(trace *t)
+{
+    if (t == NULL)
+    {
+        return;
+    }
+    munmap(t->map, t->size);
+    free(t->path);
+    free(t);
+}
+
+int trace_processes(trace *t, int nqueues, process_vector *processes)
+{
+    process *p;
+    int i;
+
+    process_vector_reserve(processes, processes->count + t->count);
+    for (i = 0; i < t->count; i++)
+    {
+        // Los nombres de la traza no tienen nulo: se internan directamente
+        p = create_process("", t->arrival[i], t->execution[i]);
+        p->name = intern_name_len(t->names + t->name_off[i], t->name_off[i + 1] - t->name_off[i]);
+        p->pid = i + 1;
+        p->priority = (t->priority[i] < nqueues) ? t->priority[i] : nqueues - 1;
+        process_vector_push_back(processes, p);
+    }
+
+    return t->count;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Trazas binarias de procesos para barridos de parametros.
+ * @author John Navia, Ricardo Delgado
+ * @copyright MIT License
+ *
+ * Una traza guarda los procesos de una entrada (llegada, tamano, prioridad
+ * y nombre) en un formato que se puede proyectar en memoria (mmap) sin
+ * copiarlo, de modo que varios procesos pueden compartir la misma traza.
+ *
+ * Formato:
+ * - Encabezado: "SCHTRACE" (8 bytes), version, cantidad de procesos n,
+ *   tamano de la tabla de nombres y un campo reservado (uint32 cada uno,
+ *   el ultimo en 0 para que las columnas queden alineadas a 8 bytes).
+ * - Columna arrival[n] (int64).
+ * - Columnas execution[n] y priority[n] (int32, prioridad 0-based).
+ * - Desplazamientos de los nombres name_off[n + 1] (uint32).
+ * - Tabla de nombres (caracteres sin nulo).
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sched.h"
+
+/** @brief Traza binaria proyectada en memoria */
+typedef struct
+{
+    void *map;                /*!< Inicio de la proyeccion */
+    size_t size;              /*!< Tamano de la proyeccion */
+    char *path;               /*!< Ruta del archivo */
+    int count;                /*!< Cantidad de procesos */
+    const int64_t *arrival;   /*!< Tiempos de llegada */
+    const int32_t *execution; /*!< Tiempos de ejecucion */
+    const int32_t *priority;  /*!< Prioridades (0-based) */
+    const uint32_t *name_off; /*!< Desplazamientos de los nombres (count + 1) */
+    const char *names;        /*!< Tabla de nombres */
+} trace;
+
+/**
+ * @brief Escribe los procesos de una entrada como traza binaria.
+ * @param path Ruta del archivo
+ * @param processes Vector de procesos
+ * @return 1 si se escribio, 0 en caso de error.
+ */
+int write_trace(char *path, process_vector *processes);
+
+/**
+ * @brief Proyecta una traza en memoria.
+ * @param path Ruta del archivo
+ * @return Traza, o NULL si el archivo no existe o no es una traza valida.
+ */
+trace *open_trace(char *path);
+
+/**
+ * @brief Libera la proyeccion de una traza.
+ * @param t Traza
+ */
+void close_trace(trace *t);
+
+/**
+ * @brief Agrega a un vector los procesos de una traza (PIDs 1..n en orden).
+ * @param t Traza
+ * @param nqueues Cantidad de colas: las prioridades mayores se asignan a la ultima cola
+ * @param processes Vector de procesos (por ejemplo, el de un sched_context)
+ * @return Cantidad de procesos agregados.
+ */
+int trace_processes(trace *t, int nqueues, process_vector *processes);
+
+#endif